@@ -13,14 +13,15 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <time.h>
 #include "modbus_master.h"
 
 #define PRINT_DEBUG
 
-uint8_t* parse_address_array(json_t* json_array, uint8_t* count) 
+uint16_t* parse_address_array(json_t* json_array, uint16_t* count) 
 {
-    uint8_t size = json_array_size(json_array);
-    uint8_t* addresses = (uint8_t*)malloc(size * sizeof(uint8_t));
+    uint16_t size = json_array_size(json_array);
+    uint16_t* addresses = (uint16_t*)malloc(size * sizeof(uint16_t));
 
     if (addresses == NULL) 
     {
@@ -30,17 +31,96 @@ uint8_t* parse_address_array(json_t* json_array, uint8_t* count)
         return NULL;
     }
 
-    for (uint8_t i = 0; i < size; i++) 
+    for (uint16_t i = 0; i < size; i++) 
     {
         json_t* item = json_array_get(json_array, i);
         json_t* address_obj = json_object_get(item, "address");
-        addresses[i] = (uint8_t)json_integer_value(address_obj);
+        addresses[i] = (uint16_t)json_integer_value(address_obj);
     }
 
-    *count = (uint8_t)size;
+    *count = size;
     return addresses;
 }
 
+deadband_t* parse_deadband_array(json_t* json_array, uint16_t count)
+{
+    deadband_t* deadbands = (deadband_t*) calloc(count > 0 ? count : 1, sizeof(deadband_t));
+    json_t* item = NULL;
+
+    if (deadbands == NULL) 
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for deadband array !\n");
+        #endif
+        return NULL;
+    }
+
+    for (uint16_t i = 0; i < count; i++) 
+    {
+        item = json_array_get(json_array, i);
+        if(json_is_number(json_object_get(item, "deadband")))
+        {
+            deadbands[i].type = DEADBAND_ABSOLUTE;
+            deadbands[i].value = json_number_value(json_object_get(item, "deadband"));
+        }
+        else if(json_is_number(json_object_get(item, "deadband_percent")))
+        {
+            deadbands[i].type = DEADBAND_PERCENT;
+            deadbands[i].value = json_number_value(json_object_get(item, "deadband_percent"));
+        }
+        else
+        {
+            deadbands[i].type = DEADBAND_NONE;
+            deadbands[i].value = 0;
+        }
+    }
+
+    return deadbands;
+}
+
+uint32_t* parse_scan_period_array(json_t* json_array, uint16_t count, uint32_t default_period)
+{
+    uint32_t* periods = (uint32_t*) malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+    json_t* period_obj = NULL;
+
+    if (periods == NULL) 
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for scan period array !\n");
+        #endif
+        return NULL;
+    }
+
+    for (uint16_t i = 0; i < count; i++) 
+    {
+        period_obj = json_object_get(json_array_get(json_array, i), "scan_period");
+        periods[i] = (json_is_integer(period_obj) && json_integer_value(period_obj) > 0) ? 
+                     (uint32_t) json_integer_value(period_obj) : default_period;
+    }
+
+    return periods;
+}
+
+uint8_t deadband_exceeded(deadband_t* deadband, int16_t reported, int16_t value)
+{
+    int32_t diff = (int32_t) value - (int32_t) reported;
+
+    if(diff < 0)
+    {
+        diff = -diff;
+    }
+
+    switch(deadband->type)
+    {
+        case DEADBAND_ABSOLUTE:
+            return diff > deadband->value;
+        case DEADBAND_PERCENT:
+            return diff > deadband->value * (reported < 0 ? -(int32_t) reported : reported) / 100.0;
+        default:
+            return diff != 0;
+    }
+}
+
 simple_slave_t** parse_slaves(json_t* root, uint8_t* num_of_slaves, serial_configuration_t* cfg)
 {
     uint8_t size = 0;
@@ -80,6 +160,15 @@ simple_slave_t** parse_slaves(json_t* root, uint8_t* num_of_slaves, serial_confi
         cfg[j].baud_rate = (uint32_t) json_integer_value(json_object_get(port_obj, "baud_rate"));
         cfg[j].data_bits = (uint8_t) json_integer_value(json_object_get(port_obj, "data_bits"));
         cfg[j].stop_bits = (uint8_t) json_integer_value(json_object_get(port_obj, "stop_bits"));
+        cfg[j].max_read_gap = READ_PLAN_DEFAULT_MAX_GAP;
+        cfg[j].response_timeout_floor = RESPONSE_TIMEOUT_FLOOR;
+        cfg[j].response_timeout_ceiling = RESPONSE_TIMEOUT_CEILING;
+        cfg[j].write_window = DEFAULT_WRITE_WINDOW;
+        cfg[j].poll_interval = (uint32_t) json_integer_value(json_object_get(port_obj, "poll_interval"));
+        if(cfg[j].poll_interval == 0)
+        {
+            cfg[j].poll_interval = DEFAULT_SCAN_PERIOD;
+        }
         parity_tmp = (uint8_t) json_integer_value(json_object_get(port_obj, "parity"));
 
         if(parity_tmp == 0)
@@ -95,6 +184,26 @@ simple_slave_t** parse_slaves(json_t* root, uint8_t* num_of_slaves, serial_confi
             cfg[j].parity = MODBUS_PARITY_EVEN;
         }
 
+        if(json_is_integer(json_object_get(port_obj, "max_read_gap")))
+        {
+            cfg[j].max_read_gap = (uint16_t) json_integer_value(json_object_get(port_obj, "max_read_gap"));
+        }
+
+        if(json_is_integer(json_object_get(port_obj, "response_timeout_floor")))
+        {
+            cfg[j].response_timeout_floor = 1000 * (uint32_t) json_integer_value(json_object_get(port_obj, "response_timeout_floor"));
+        }
+
+        if(json_is_integer(json_object_get(port_obj, "response_timeout_ceiling")))
+        {
+            cfg[j].response_timeout_ceiling = 1000 * (uint32_t) json_integer_value(json_object_get(port_obj, "response_timeout_ceiling"));
+        }
+
+        if(json_is_integer(json_object_get(port_obj, "write_window")))
+        {
+            cfg[j].write_window = (uint32_t) json_integer_value(json_object_get(port_obj, "write_window"));
+        }
+
         if(active)
         {
             #ifdef PRINT_DEBUG
@@ -135,18 +244,45 @@ simple_slave_t** parse_slaves(json_t* root, uint8_t* num_of_slaves, serial_confi
                 // Parse coils addresses
                 json_t* coils_array = json_object_get(slave_obj, "coils");
                 slaves[j][i].coils_addr = parse_address_array(coils_array, &slaves[j][i].num_of_coils);
+                slaves[j][i].coils_scan_period = parse_scan_period_array(coils_array, slaves[j][i].num_of_coils, cfg[j].poll_interval);
 
                 // Parse discrete inputs addresses
                 json_t* discrete_inputs_array = json_object_get(slave_obj, "discrete_inputs");
                 slaves[j][i].discrete_inputs_addr = parse_address_array(discrete_inputs_array, &slaves[j][i].num_of_discrete_inputs);
+                slaves[j][i].discrete_inputs_scan_period = parse_scan_period_array(discrete_inputs_array, slaves[j][i].num_of_discrete_inputs, 
+                    cfg[j].poll_interval);
 
                 // Parse input registers addresses
                 json_t* input_registers_array = json_object_get(slave_obj, "input_registers");
                 slaves[j][i].input_registers_addr = parse_address_array(input_registers_array, &slaves[j][i].num_of_input_registers);
+                slaves[j][i].input_registers_deadband = parse_deadband_array(input_registers_array, slaves[j][i].num_of_input_registers);
+                slaves[j][i].input_registers_scan_period = parse_scan_period_array(input_registers_array, slaves[j][i].num_of_input_registers, 
+                    cfg[j].poll_interval);
 
                 // Parse holding registers addresses
                 json_t* holding_registers_array = json_object_get(slave_obj, "holding_registers");
                 slaves[j][i].holding_registers_addr = parse_address_array(holding_registers_array, &slaves[j][i].num_of_holding_registers);
+                slaves[j][i].holding_registers_deadband = parse_deadband_array(holding_registers_array, slaves[j][i].num_of_holding_registers);
+                slaves[j][i].holding_registers_scan_period = parse_scan_period_array(holding_registers_array, slaves[j][i].num_of_holding_registers, 
+                    cfg[j].poll_interval);
+
+                init_rtt_stats(&slaves[j][i].rtt, cfg[j].response_timeout_floor, cfg[j].response_timeout_ceiling);
+                init_slave_health(&slaves[j][i].health);
+
+                // Merge parsed addresses into block read requests
+                if(build_read_plan(&slaves[j][i], cfg[j].max_read_gap) == 0)
+                {
+                    #ifdef PRINT_DEBUG
+                        fprintf(stderr, "Failed to build read plan for slave: %u.\n", slaves[j][i].id);
+                    #endif
+                    return NULL;
+                }
+
+                // Response buffer is reused by every interrogation of the slave
+                if(init_interrogation_response(&slaves[j][i].response, &slaves[j][i]) == 0)
+                {
+                    return NULL;
+                }
             }
 
             num_of_slaves[j] = size;
@@ -160,6 +296,139 @@ simple_slave_t** parse_slaves(json_t* root, uint8_t* num_of_slaves, serial_confi
     return slaves;
 }
 
+static uint16_t* get_address_array(simple_slave_t* slave, uint8_t function, uint16_t* count)
+{
+    switch(function)
+    {
+        case MODBUS_FC_READ_COILS:
+            *count = slave->num_of_coils;
+            return slave->coils_addr;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            *count = slave->num_of_discrete_inputs;
+            return slave->discrete_inputs_addr;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            *count = slave->num_of_input_registers;
+            return slave->input_registers_addr;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            *count = slave->num_of_holding_registers;
+            return slave->holding_registers_addr;
+        default:
+            *count = 0;
+            return NULL;
+    }
+}
+
+static uint32_t* get_scan_period_array(simple_slave_t* slave, uint8_t function)
+{
+    switch(function)
+    {
+        case MODBUS_FC_READ_COILS:
+            return slave->coils_scan_period;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            return slave->discrete_inputs_scan_period;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            return slave->input_registers_scan_period;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            return slave->holding_registers_scan_period;
+        default:
+            return NULL;
+    }
+}
+
+uint8_t build_read_plan(simple_slave_t* slave, uint16_t max_gap)
+{
+    const uint8_t functions[] = {MODBUS_FC_READ_COILS, MODBUS_FC_READ_DISCRETE_INPUTS, 
+                                 MODBUS_FC_READ_INPUT_REGISTERS, MODBUS_FC_READ_HOLDING_REGISTERS};
+    read_plan_t* plan = &slave->read_plan;
+    read_block_t* block = NULL;
+    uint16_t* addr = NULL;
+    uint32_t* period = NULL;
+    uint16_t* points = NULL;
+    uint16_t count = 0;
+    uint16_t tmp = 0;
+    uint16_t max_count = 0;
+    uint16_t pos = 0;
+    uint16_t total = slave->num_of_coils + slave->num_of_discrete_inputs + 
+                     slave->num_of_input_registers + slave->num_of_holding_registers;
+
+    plan->blocks = NULL;
+    plan->points = NULL;
+    plan->num_of_blocks = 0;
+
+    if(total == 0)
+    {
+        return 1;
+    }
+
+    /* Worst case is one block per configured address */
+    plan->points = (uint16_t*) malloc(total * sizeof(uint16_t));
+    plan->blocks = (read_block_t*) malloc(total * sizeof(read_block_t));
+    if(plan->points == NULL || plan->blocks == NULL)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for read plan.\n");
+        #endif
+        free_read_plan(plan);
+        return 0;
+    }
+
+    for(uint8_t f = 0; f < sizeof(functions); f++)
+    {
+        addr = get_address_array(slave, functions[f], &count);
+        period = get_scan_period_array(slave, functions[f]);
+        max_count = (functions[f] == MODBUS_FC_READ_COILS || functions[f] == MODBUS_FC_READ_DISCRETE_INPUTS) ? 
+                    MODBUS_MAX_READ_BITS : MODBUS_MAX_READ_REGISTERS;
+        points = &plan->points[pos];
+        block = NULL;
+
+        /* Sort indices of configured points by scan period and address, arrays are small so insertion sort is enough */
+        for(uint16_t i = 0; i < count; i++)
+        {
+            points[i] = i;
+            for(uint16_t k = i; k > 0 && (period[points[k - 1]] > period[points[k]] || 
+                (period[points[k - 1]] == period[points[k]] && addr[points[k - 1]] > addr[points[k]])); k--)
+            {
+                tmp = points[k];
+                points[k] = points[k - 1];
+                points[k - 1] = tmp;
+            }
+        }
+
+        for(uint16_t i = 0; i < count; i++)
+        {
+            if(block == NULL || period[points[i]] != block->scan_period || (uint16_t)(addr[points[i]] - addr[points[i - 1]]) > max_gap + 1 || 
+               (uint16_t)(addr[points[i]] - block->start_addr) >= max_count)
+            {
+                block = &plan->blocks[plan->num_of_blocks++];
+                block->function = functions[f];
+                block->start_addr = addr[points[i]];
+                block->scan_period = period[points[i]];
+                block->points = &points[i];
+                block->num_of_points = 0;
+            }
+            block->count = addr[points[i]] - block->start_addr + 1;
+            block->num_of_points++;
+        }
+
+        pos += count;
+    }
+
+    #ifdef PRINT_DEBUG
+        fprintf(stdout, "Slave %u: %u configured addresses merged into %u block requests\n", slave->id, total, plan->num_of_blocks);
+    #endif
+
+    return 1;
+}
+
+void free_read_plan(read_plan_t* plan)
+{
+    free(plan->blocks);
+    free(plan->points);
+    plan->blocks = NULL;
+    plan->points = NULL;
+    plan->num_of_blocks = 0;
+}
+
 void free_slaves(simple_slave_t** slaves, uint8_t* num_of_slaves) 
 {
     for(uint8_t j = 0; j < SERIAL_PORTS_NUM; j++)
@@ -172,6 +441,14 @@ void free_slaves(simple_slave_t** slaves, uint8_t* num_of_slaves)
                 free(slaves[j][i].discrete_inputs_addr);
                 free(slaves[j][i].input_registers_addr);
                 free(slaves[j][i].holding_registers_addr);
+                free(slaves[j][i].input_registers_deadband);
+                free(slaves[j][i].holding_registers_deadband);
+                free(slaves[j][i].coils_scan_period);
+                free(slaves[j][i].discrete_inputs_scan_period);
+                free(slaves[j][i].input_registers_scan_period);
+                free(slaves[j][i].holding_registers_scan_period);
+                free_read_plan(&slaves[j][i].read_plan);
+                free_interrogation_response(&slaves[j][i].response);
             }
             free(slaves[j]);
         }
@@ -194,13 +471,40 @@ void free_modbus(modbus_t** ctx)
     }
 }
 
+uint8_t init_interrogation_response(interrogation_response_t* resp, simple_slave_t* slave)
+{
+    /* At least one element each, so a slave without points of some kind still gets valid pointers */
+    resp->coils = (uint8_t*) calloc(slave->num_of_coils + 1, sizeof(uint8_t));
+    resp->discrete_inputs = (uint8_t*) calloc(slave->num_of_discrete_inputs + 1, sizeof(uint8_t));
+    resp->input_regs = (uint16_t*) calloc(slave->num_of_input_registers + 1, sizeof(uint16_t));
+    resp->holding_regs = (uint16_t*) calloc(slave->num_of_holding_registers + 1, sizeof(uint16_t));
+
+    resp->num_of_coils = slave->num_of_coils;
+    resp->num_of_discrete_inputs = slave->num_of_discrete_inputs;
+    resp->num_of_input_registers = slave->num_of_input_registers;
+    resp->num_of_holding_registers = slave->num_of_holding_registers;
+
+    if(resp->coils == NULL || resp->discrete_inputs == NULL || resp->input_regs == NULL || resp->holding_regs == NULL)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for interrogation response arrays.\n");
+        #endif
+        free_interrogation_response(resp);
+        return 0;
+    }
+    return 1;
+}
+
 void free_interrogation_response(interrogation_response_t* resp)
 {
     free(resp->coils);
     free(resp->discrete_inputs);
     free(resp->input_regs);
     free(resp->holding_regs);
-    free(resp);
+    resp->coils = NULL;
+    resp->discrete_inputs = NULL;
+    resp->input_regs = NULL;
+    resp->holding_regs = NULL;
 }
 
 simple_slave_t** init_slaves(const char* cfg_file, uint8_t* num_of_slaves, serial_configuration_t* cfg)
@@ -245,11 +549,8 @@ modbus_t* init_modbus_connection(const char* dev_path, uint32_t baud, uint8_t pa
     }
     */
 
-    /* Set timeout */
-    /*
-    modbus_set_byte_timeout(ctx, 0, 0);
+    /* Set initial timeout, it is adapted to every slave before each request */
     modbus_set_response_timeout(ctx, 0, RESPONSE_TIMEOUT);
-    */
 
     /* Connect to the line */
     if(modbus_connect(ctx) == -1)
@@ -265,7 +566,8 @@ modbus_t* init_modbus_connection(const char* dev_path, uint32_t baud, uint8_t pa
 
 void print_slaves(simple_slave_t** slaves, uint8_t* num_of_slaves)
 {
-    uint8_t i, j, k;
+    uint8_t i, k;
+    uint16_t j;
     for(k = 0; k < SERIAL_PORTS_NUM; k++)
     {
         fprintf(stdout, "----------------- SERIAL PORT %u -----------------\n\n", k + 1);
@@ -326,6 +628,187 @@ void print_slaves(simple_slave_t** slaves, uint8_t* num_of_slaves)
     }
 }
 
+static uint64_t get_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t get_bucket_lower_bound(uint8_t bucket)
+{
+    return (bucket == 0) ? 0 : (uint32_t) RTT_HISTOGRAM_BASE << (bucket - 1);
+}
+
+static void add_rtt_sample(rtt_stats_t* rtt, uint32_t rtt_us)
+{
+    uint8_t bucket = 0;
+    uint32_t percentile = 0;
+
+    while(bucket < RTT_HISTOGRAM_BUCKETS - 1 && rtt_us >= get_bucket_lower_bound(bucket + 1))
+    {
+        bucket++;
+    }
+
+    if(rtt->samples >= RTT_HISTOGRAM_MAX_SAMPLES)
+    {
+        rtt->samples = 0;
+        for(uint8_t i = 0; i < RTT_HISTOGRAM_BUCKETS; i++)
+        {
+            rtt->histogram[i] /= 2;
+            rtt->samples += rtt->histogram[i];
+        }
+    }
+    rtt->histogram[bucket]++;
+    rtt->samples++;
+    rtt->ewma = (rtt->ewma == 0) ? rtt_us : (1 - RTT_EWMA_WEIGHT) * rtt->ewma + RTT_EWMA_WEIGHT * rtt_us;
+
+    if(rtt->samples >= RTT_MIN_SAMPLES)
+    {
+        percentile = get_rtt_percentile(rtt, RTT_TIMEOUT_PERCENTILE);
+        rtt->response_timeout = percentile + RESPONSE_TIMEOUT_MARGIN;
+        if(rtt->response_timeout < rtt->response_timeout_floor)
+        {
+            rtt->response_timeout = rtt->response_timeout_floor;
+        }
+        if(rtt->response_timeout > rtt->response_timeout_ceiling)
+        {
+            rtt->response_timeout = rtt->response_timeout_ceiling;
+        }
+    }
+}
+
+static uint64_t begin_transaction(simple_slave_t* slave, modbus_t* ctx)
+{
+    uint8_t real_slave_id = (uint8_t)(slave->id - ((uint16_t)(slave->id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
+
+    modbus_set_slave(ctx, real_slave_id);
+    modbus_set_response_timeout(ctx, slave->rtt.response_timeout / 1000000, slave->rtt.response_timeout % 1000000);
+    return get_time_us();
+}
+
+static void end_transaction(simple_slave_t* slave, uint64_t start, int rc)
+{
+    int err = errno;
+    uint32_t rtt_us = (uint32_t)(get_time_us() - start);
+
+    slave->rtt.requests++;
+    if(rc == -1 && err == ETIMEDOUT)
+    {
+        /* Timeouts carry no round trip time, feeding the timeout itself would ratchet the
+           percentile up to the ceiling, so they are left to the health state machine */
+        slave->rtt.timeouts++;
+    }
+    else if(rc != -1 && slave->health.state != SLAVE_STATE_OFFLINE)
+    {
+        /* Answers to probes of an offline slave do not describe its normal timing */
+        add_rtt_sample(&slave->rtt, rtt_us);
+    }
+
+    /* Only a missing answer means the slave may be gone, exception responses prove it is alive */
+    update_slave_health(slave, !(rc == -1 && err == ETIMEDOUT), get_time_us() / 1000);
+    errno = err;
+}
+
+void init_rtt_stats(rtt_stats_t* rtt, uint32_t floor, uint32_t ceiling)
+{
+    memset(rtt, 0, sizeof(rtt_stats_t));
+    rtt->response_timeout_floor = floor;
+    rtt->response_timeout_ceiling = (ceiling >= floor) ? ceiling : floor;
+    rtt->response_timeout = RESPONSE_TIMEOUT;
+}
+
+uint32_t get_rtt_percentile(rtt_stats_t* rtt, double percentile)
+{
+    double target = percentile * rtt->samples;
+    double cumulative = 0;
+    uint32_t lower = 0;
+    uint32_t upper = 0;
+
+    if(rtt->samples == 0)
+    {
+        return 0;
+    }
+
+    for(uint8_t i = 0; i < RTT_HISTOGRAM_BUCKETS; i++)
+    {
+        if(rtt->histogram[i] > 0 && cumulative + rtt->histogram[i] >= target)
+        {
+            /* Interpolate inside the bucket, open ended bucket is treated as twice its lower bound */
+            lower = get_bucket_lower_bound(i);
+            upper = (i == RTT_HISTOGRAM_BUCKETS - 1) ? 2 * lower : get_bucket_lower_bound(i + 1);
+            return lower + (uint32_t)((upper - lower) * (target - cumulative) / rtt->histogram[i]);
+        }
+        cumulative += rtt->histogram[i];
+    }
+    return get_bucket_lower_bound(RTT_HISTOGRAM_BUCKETS - 1);
+}
+
+void get_rtt_stats(simple_slave_t* slave, rtt_stats_t* stats)
+{
+    *stats = slave->rtt;
+}
+
+void init_slave_health(slave_health_t* health)
+{
+    health->state = SLAVE_STATE_ONLINE;
+    health->failures = 0;
+    health->probe_interval = SLAVE_PROBE_INTERVAL_MIN;
+    health->next_probe = 0;
+}
+
+uint8_t is_slave_available(simple_slave_t* slave, uint64_t now)
+{
+    return slave->health.state != SLAVE_STATE_OFFLINE || now >= slave->health.next_probe;
+}
+
+void update_slave_health(simple_slave_t* slave, uint8_t answered, uint64_t now)
+{
+    slave_health_t* health = &slave->health;
+
+    if(answered)
+    {
+        #ifdef PRINT_DEBUG
+            if(health->state == SLAVE_STATE_OFFLINE)
+            {
+                fprintf(stdout, "Slave %u is back online.\n", slave->id);
+            }
+        #endif
+        init_slave_health(health);
+        return;
+    }
+
+    if(health->state == SLAVE_STATE_OFFLINE)
+    {
+        /* Failed probe, back off exponentially */
+        health->probe_interval = (2 * health->probe_interval < SLAVE_PROBE_INTERVAL_MAX) ? 
+                                 2 * health->probe_interval : SLAVE_PROBE_INTERVAL_MAX;
+        health->next_probe = now + health->probe_interval;
+        return;
+    }
+
+    if(health->failures < UINT8_MAX)
+    {
+        health->failures++;
+    }
+
+    if(health->failures >= SLAVE_OFFLINE_FAILURES)
+    {
+        health->state = SLAVE_STATE_OFFLINE;
+        health->probe_interval = SLAVE_PROBE_INTERVAL_MIN;
+        health->next_probe = now + health->probe_interval;
+
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Slave %u is offline, probing every %u ms.\n", slave->id, health->probe_interval);
+        #endif
+    }
+    else
+    {
+        health->state = SLAVE_STATE_SUSPECT;
+    }
+}
+
 uint8_t get_slave_idx(uint16_t slave_id, simple_slave_t* slaves, uint8_t num_of_slaves)
 {
     uint8_t idx;
@@ -340,12 +823,25 @@ uint8_t get_slave_idx(uint16_t slave_id, simple_slave_t* slaves, uint8_t num_of_
     return num_of_slaves;
 }
 
+int get_point_idx(simple_slave_t* slave, uint8_t function, uint16_t addr)
+{
+    uint16_t count = 0;
+    uint16_t* addresses = get_address_array(slave, function, &count);
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        if(addresses[i] == addr)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
 interrogation_response_t* interrogate_slave(uint16_t slave_id, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
 {
     interrogation_response_t* resp = NULL;
     uint8_t idx = 0;
-    uint8_t addr = 0;
-    uint8_t real_slave_id = (uint8_t)(slave_id - ((uint16_t)(slave_id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
 
     if(slaves == NULL)
     {
@@ -364,118 +860,125 @@ interrogation_response_t* interrogate_slave(uint16_t slave_id, simple_slave_t* s
         #endif
         return NULL;
     }
-    modbus_set_slave(ctx, real_slave_id);
-
-    resp = (interrogation_response_t*) malloc(sizeof(interrogation_response_t));
-    if(resp == NULL)
-    {
-        #ifdef PRINT_DEBUG
-            fprintf(stderr, "Failed to allocate memory for interrogation response structure.\n");
-        #endif
-        return NULL;
-    }
 
-    resp->coils = (uint8_t*) calloc(slaves[idx].num_of_coils, sizeof(uint8_t));
-    resp->discrete_inputs = (uint8_t*) calloc(slaves[idx].num_of_discrete_inputs, sizeof(uint8_t));
-    resp->input_regs = (uint16_t*) calloc(slaves[idx].num_of_input_registers, sizeof(uint16_t));
-    resp->holding_regs = (uint16_t*) calloc(slaves[idx].num_of_holding_registers, sizeof(uint16_t));
-
-    if(resp->coils == NULL || resp->discrete_inputs == NULL || resp->holding_regs == NULL || resp->input_regs == NULL)
-    {
-        #ifdef PRINT_DEBUG
-            fprintf(stderr, "Failed to allocate memory for interrogation response arrays.\n");
-        #endif
-        return NULL;
-    }
-
-    resp->num_of_coils = slaves[idx].num_of_coils;
-    resp->num_of_discrete_inputs = slaves[idx].num_of_discrete_inputs;
-    resp->num_of_input_registers = slaves[idx].num_of_input_registers;
-    resp->num_of_holding_registers = slaves[idx].num_of_holding_registers;
+    /* Buffer is sized at config load and reused, interrogation does not allocate */
+    resp = &slaves[idx].response;
 
     #ifdef PRINT_DEBUG
         fprintf(stdout, "\n------ Interrogation start -------\n\nSlave id: %u\nSlave description: %s\n", slaves[idx].id, slaves[idx].name);
     #endif
 
-    #ifdef PRINT_DEBUG
-        fprintf(stdout, "Reading coils...\n");
-    #endif
-    for(uint8_t i = 0; i < slaves[idx].num_of_coils; i++)
+    for(uint16_t i = 0; i < slaves[idx].read_plan.num_of_blocks; i++)
     {
-        addr = slaves[idx].coils_addr[i];
-        modbus_read_bits(ctx, addr, 1, (&resp->coils[i]));
-
-        #ifdef PRINT_DEBUG
-            fprintf(stdout, "Coil %u status: %s\n", addr, resp->coils[i] ? "ON" : "OFF");
-        #endif
+        read_block(&slaves[idx], &slaves[idx].read_plan.blocks[i], resp, ctx);
     }
 
     #ifdef PRINT_DEBUG
+        for(uint16_t i = 0; i < slaves[idx].num_of_coils; i++)
+        {
+            fprintf(stdout, "Coil %u status: %s\n", slaves[idx].coils_addr[i], resp->coils[i] ? "ON" : "OFF");
+        }
         fprintf(stdout, "\n");
 
-        fprintf(stdout, "Reading discrete inputs...\n");
-    #endif
-
-    for(uint8_t i = 0; i < slaves[idx].num_of_discrete_inputs; i++)
-    {
-        addr = slaves[idx].discrete_inputs_addr[i];
-        modbus_read_input_bits(ctx, addr, 1, (uint8_t*)(&resp->discrete_inputs[i]));
-        #ifdef PRINT_DEBUG
-            fprintf(stdout, "Discrete input %u status: %s\n", addr, resp->discrete_inputs[i] ? "ON" : "OFF");
-        #endif
-    }
+        for(uint16_t i = 0; i < slaves[idx].num_of_discrete_inputs; i++)
+        {
+            fprintf(stdout, "Discrete input %u status: %s\n", slaves[idx].discrete_inputs_addr[i], resp->discrete_inputs[i] ? "ON" : "OFF");
+        }
+        fprintf(stdout, "\n");
 
-    #ifdef PRINT_DEBUG
+        for(uint16_t i = 0; i < slaves[idx].num_of_input_registers; i++)
+        {
+            fprintf(stdout, "Input register %u value: %u\n", slaves[idx].input_registers_addr[i], resp->input_regs[i]);
+        }
         fprintf(stdout, "\n");
 
-        fprintf(stdout, "Reading input registers...\n");
+        for(uint16_t i = 0; i < slaves[idx].num_of_holding_registers; i++)
+        {
+            fprintf(stdout, "Holding register %u value: %u\n", slaves[idx].holding_registers_addr[i], resp->holding_regs[i]);
+        }
+        fprintf(stdout, "\n");
     #endif
-    
-    for(uint8_t i = 0; i < slaves[idx].num_of_input_registers; i++)
-    {
-        addr = slaves[idx].input_registers_addr[i];
-        modbus_read_input_registers(ctx, addr, 1, &resp->input_regs[i]);
-        
-        #ifdef PRINT_DEBUG
-            fprintf(stdout, "Input register %u value: %u\n", addr, resp->input_regs[i]);
-        #endif
-    }
 
-    #ifdef PRINT_DEBUG
-        fprintf(stdout, "\n");
+    return resp;
+}
 
-        fprintf(stdout, "Reading holding registers...\n");
-    #endif
+uint8_t read_block(simple_slave_t* slave, read_block_t* block, interrogation_response_t* resp, modbus_t* ctx)
+{
+    uint8_t bits[MODBUS_MAX_READ_BITS];
+    uint16_t regs[MODBUS_MAX_READ_REGISTERS];
+    uint16_t* addr = NULL;
+    uint16_t count = 0;
+    uint16_t point = 0;
+    uint64_t start = 0;
+    int rc = -1;
+
+    addr = get_address_array(slave, block->function, &count);
+    start = begin_transaction(slave, ctx);
+
+    switch(block->function)
+    {
+        case MODBUS_FC_READ_COILS:
+            rc = modbus_read_bits(ctx, block->start_addr, block->count, bits);
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            rc = modbus_read_input_bits(ctx, block->start_addr, block->count, bits);
+            break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            rc = modbus_read_input_registers(ctx, block->start_addr, block->count, regs);
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            rc = modbus_read_registers(ctx, block->start_addr, block->count, regs);
+            break;
+        default:
+            break;
+    }
+    end_transaction(slave, start, rc);
 
-    for(uint8_t i = 0; i < slaves[idx].num_of_holding_registers; i++)
+    if(rc != block->count)
     {
-        addr = slaves[idx].holding_registers_addr[i];
-        modbus_read_registers(ctx, addr, 1, &resp->holding_regs[i]);
-        
         #ifdef PRINT_DEBUG
-            fprintf(stdout, "Holding register %u value: %u\n", addr, resp->holding_regs[i]);
+            fprintf(stderr, "Failed to read block, slave: %u, function: %u, start: %u, count: %u: %s\n", 
+                slave->id, block->function, block->start_addr, block->count, modbus_strerror(errno));
         #endif
+        return 0;
     }
 
-    #ifdef PRINT_DEBUG
-        fprintf(stdout, "\n");
-    #endif
+    /* Scatter block values back to the configured points */
+    for(uint16_t i = 0; i < block->num_of_points; i++)
+    {
+        point = block->points[i];
+        switch(block->function)
+        {
+            case MODBUS_FC_READ_COILS:
+                resp->coils[point] = bits[addr[point] - block->start_addr];
+                break;
+            case MODBUS_FC_READ_DISCRETE_INPUTS:
+                resp->discrete_inputs[point] = bits[addr[point] - block->start_addr];
+                break;
+            case MODBUS_FC_READ_INPUT_REGISTERS:
+                resp->input_regs[point] = regs[addr[point] - block->start_addr];
+                break;
+            default:
+                resp->holding_regs[point] = regs[addr[point] - block->start_addr];
+                break;
+        }
+    }
 
-    return resp;
+    return 1;
 }
 
-uint8_t* read_coil(uint16_t slave_id, uint8_t coil_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
+uint8_t read_coil(uint16_t slave_id, uint16_t coil_addr, uint8_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
 {
     uint8_t idx = 0;
-    uint8_t* res = NULL;
-    uint8_t real_slave_id = (uint8_t)(slave_id - ((uint16_t)(slave_id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
+    uint64_t start = 0;
+    int rc = -1;
 
-    if(slaves == NULL)
+    if(slaves == NULL || value == NULL)
     {
         #ifdef PRINT_DEBUG
             fprintf(stderr, "Failed to read coil status, slave object is NULL.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
     idx = get_slave_idx(slave_id, slaves, num_of_slaves);
@@ -485,46 +988,51 @@ uint8_t* read_coil(uint16_t slave_id, uint8_t coil_addr, simple_slave_t* slaves,
         #ifdef PRINT_DEBUG
             fprintf(stderr, "Failed to read coil status, invalid slave ID.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
-    modbus_set_slave(ctx, real_slave_id);
-    for(uint8_t i = 0; i < slaves[idx].num_of_coils; i++)
+    for(uint16_t i = 0; i < slaves[idx].num_of_coils; i++)
     {
         if(slaves[idx].coils_addr[i] == coil_addr)
         {
-            res = (uint8_t*) calloc(1, sizeof(uint8_t));
-            modbus_read_bits(ctx, coil_addr, 1, res);
+            start = begin_transaction(&slaves[idx], ctx);
+            rc = modbus_read_bits(ctx, coil_addr, 1, value);
+            end_transaction(&slaves[idx], start, rc);
+
+            if(rc == -1)
+            {
+                #ifdef PRINT_DEBUG
+                    fprintf(stderr, "Failed to read coil status, address: %u: %s\n", coil_addr, modbus_strerror(errno));
+                #endif
+                return 0;
+            }
 
             #ifdef PRINT_DEBUG
-                fprintf(stdout, "Coil address: %u, status: %s\n", coil_addr, *res ? "ON" : "OFF");
+                fprintf(stdout, "Coil address: %u, status: %s\n", coil_addr, *value ? "ON" : "OFF");
             #endif
-            break;
+            return 1;
         }
     }
 
     #ifdef PRINT_DEBUG
-        if(res == NULL)
-        {
-            fprintf(stderr, "Failed to read coil status, invalid coil address.\n");
-        }
+        fprintf(stderr, "Failed to read coil status, invalid coil address.\n");
     #endif
 
-    return res;
+    return 0;
 }
 
-uint8_t* read_discrete_input(uint16_t slave_id, uint8_t discrete_input_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
+uint8_t read_discrete_input(uint16_t slave_id, uint16_t discrete_input_addr, uint8_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
 {
     uint8_t idx = 0;
-    uint8_t* res = NULL;
-    uint8_t real_slave_id = (uint8_t)(slave_id - ((uint16_t)(slave_id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
+    uint64_t start = 0;
+    int rc = -1;
 
-    if(slaves == NULL)
+    if(slaves == NULL || value == NULL)
     {
         #ifdef PRINT_DEBUG
             fprintf(stderr, "Failed to read discrete input status, slave object is NULL.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
     idx = get_slave_idx(slave_id, slaves, num_of_slaves);
@@ -534,46 +1042,51 @@ uint8_t* read_discrete_input(uint16_t slave_id, uint8_t discrete_input_addr, sim
         #ifdef PRINT_DEBUG
             fprintf(stderr, "Failed to read discrete input status, invalid slave ID.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
-    modbus_set_slave(ctx, real_slave_id);
-    for(uint8_t i = 0; i < slaves[idx].num_of_discrete_inputs; i++)
+    for(uint16_t i = 0; i < slaves[idx].num_of_discrete_inputs; i++)
     {
         if(slaves[idx].discrete_inputs_addr[i] == discrete_input_addr)
         {
-            res = (uint8_t*) calloc(1, sizeof(uint8_t));
-            modbus_read_input_bits(ctx, discrete_input_addr, 1, res);
+            start = begin_transaction(&slaves[idx], ctx);
+            rc = modbus_read_input_bits(ctx, discrete_input_addr, 1, value);
+            end_transaction(&slaves[idx], start, rc);
+
+            if(rc == -1)
+            {
+                #ifdef PRINT_DEBUG
+                    fprintf(stderr, "Failed to read discrete input status, address: %u: %s\n", discrete_input_addr, modbus_strerror(errno));
+                #endif
+                return 0;
+            }
 
             #ifdef PRINT_DEBUG
-                fprintf(stdout, "Discrete input address: %u, status: %s\n", discrete_input_addr, *res ? "ON" : "OFF");
+                fprintf(stdout, "Discrete input address: %u, status: %s\n", discrete_input_addr, *value ? "ON" : "OFF");
             #endif
-            break;
+            return 1;
         }
     }
 
     #ifdef PRINT_DEBUG
-        if(res == NULL)
-        {
-            fprintf(stderr, "Failed to read discrete input status, invalid discrete input address.\n");
-        }
+        fprintf(stderr, "Failed to read discrete input status, invalid discrete input address.\n");
     #endif
 
-    return res;
+    return 0;
 }
 
-uint16_t* read_input_register(uint16_t slave_id, uint8_t input_reg_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
+uint8_t read_input_register(uint16_t slave_id, uint16_t input_reg_addr, uint16_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
 {
     uint8_t idx = 0;
-    uint16_t* res = NULL;
-    uint8_t real_slave_id = (uint8_t)(slave_id - ((uint16_t)(slave_id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
+    uint64_t start = 0;
+    int rc = -1;
 
-    if(slaves == NULL)
+    if(slaves == NULL || value == NULL)
     {
         #ifdef PRINT_DEBUG
             fprintf(stderr, "Failed to read input register value, slave object is NULL.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
     idx = get_slave_idx(slave_id, slaves, num_of_slaves);
@@ -583,46 +1096,51 @@ uint16_t* read_input_register(uint16_t slave_id, uint8_t input_reg_addr, simple_
         #ifdef PRINT_DEBUG
             fprintf(stderr, "Failed to read input register value, invalid slave ID.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
-    modbus_set_slave(ctx, real_slave_id);
-    for(uint8_t i = 0; i < slaves[idx].num_of_input_registers; i++)
+    for(uint16_t i = 0; i < slaves[idx].num_of_input_registers; i++)
     {
         if(slaves[idx].input_registers_addr[i] == input_reg_addr)
         {
-            res = (uint16_t*) calloc(1, sizeof(uint16_t));
-            modbus_read_input_registers(ctx, input_reg_addr, 1, res);
+            start = begin_transaction(&slaves[idx], ctx);
+            rc = modbus_read_input_registers(ctx, input_reg_addr, 1, value);
+            end_transaction(&slaves[idx], start, rc);
+
+            if(rc == -1)
+            {
+                #ifdef PRINT_DEBUG
+                    fprintf(stderr, "Failed to read input register value, address: %u: %s\n", input_reg_addr, modbus_strerror(errno));
+                #endif
+                return 0;
+            }
 
             #ifdef PRINT_DEBUG
-                fprintf(stdout, "Input register address: %u, value: %u\n", input_reg_addr, *res);
+                fprintf(stdout, "Input register address: %u, value: %u\n", input_reg_addr, *value);
             #endif
-            break;
+            return 1;
         }
     }
 
     #ifdef PRINT_DEBUG
-        if(res == NULL)
-        {
-            fprintf(stderr, "Failed to read input register value, invalid input register address.\n");
-        }
+        fprintf(stderr, "Failed to read input register value, invalid input register address.\n");
     #endif
 
-    return res;
+    return 0;
 }
 
-uint16_t* read_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
+uint8_t read_holding_register(uint16_t slave_id, uint16_t holding_reg_addr, uint16_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
 {
     uint8_t idx = 0;
-    uint16_t* res = NULL;
-    uint8_t real_slave_id = (uint8_t)(slave_id - ((uint16_t)(slave_id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
+    uint64_t start = 0;
+    int rc = -1;
 
-    if(slaves == NULL)
+    if(slaves == NULL || value == NULL)
     {
         #ifdef PRINT_DEBUG
-            fprintf(stderr, "Failed to read holding register, slave object is NULL.\n");
+            fprintf(stderr, "Failed to read holding register value, slave object is NULL.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
     idx = get_slave_idx(slave_id, slaves, num_of_slaves);
@@ -632,38 +1150,44 @@ uint16_t* read_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, sim
         #ifdef PRINT_DEBUG
             fprintf(stderr, "Failed to read holding register value, invalid slave ID.\n");
         #endif
-        return NULL;
+        return 0;
     }
 
-    modbus_set_slave(ctx, real_slave_id);
-    for(uint8_t i = 0; i < slaves[idx].num_of_holding_registers; i++)
+    for(uint16_t i = 0; i < slaves[idx].num_of_holding_registers; i++)
     {
         if(slaves[idx].holding_registers_addr[i] == holding_reg_addr)
         {
-            res = (uint16_t*) calloc(1, sizeof(uint16_t));
-            modbus_read_registers(ctx, holding_reg_addr, 1, res);
+            start = begin_transaction(&slaves[idx], ctx);
+            rc = modbus_read_registers(ctx, holding_reg_addr, 1, value);
+            end_transaction(&slaves[idx], start, rc);
+
+            if(rc == -1)
+            {
+                #ifdef PRINT_DEBUG
+                    fprintf(stderr, "Failed to read holding register value, address: %u: %s\n", holding_reg_addr, modbus_strerror(errno));
+                #endif
+                return 0;
+            }
 
             #ifdef PRINT_DEBUG
-                fprintf(stdout, "Holding register address: %u, value: %u\n", holding_reg_addr, *res);
+                fprintf(stdout, "Holding register address: %u, value: %u\n", holding_reg_addr, *value);
             #endif
-            break;
+            return 1;
         }
     }
 
     #ifdef PRINT_DEBUG
-        if(res == NULL)
-        {
-            fprintf(stderr, "Failed to read holding register value, invalid holding register address.\n");
-        }
+        fprintf(stderr, "Failed to read holding register value, invalid holding register address.\n");
     #endif
 
-    return res;
+    return 0;
 }
 
-uint8_t write_coil(uint16_t slave_id, uint8_t coil_addr, uint8_t coil_value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
+uint8_t write_coil(uint16_t slave_id, uint16_t coil_addr, uint8_t coil_value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
 {
     uint8_t idx = 0;
-    uint8_t real_slave_id = (uint8_t)(slave_id - ((uint16_t)(slave_id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
+    uint64_t start = 0;
+    int rc = -1;
 
     if(slaves == NULL)
     {
@@ -683,12 +1207,21 @@ uint8_t write_coil(uint16_t slave_id, uint8_t coil_addr, uint8_t coil_value, sim
         return 0;
     }
 
-    modbus_set_slave(ctx, real_slave_id);
-    for(uint8_t i = 0; i < slaves[idx].num_of_coils; i++)
+    for(uint16_t i = 0; i < slaves[idx].num_of_coils; i++)
     {
         if(slaves[idx].coils_addr[i] == coil_addr)
         {
-            modbus_write_bit(ctx, coil_addr, coil_value);
+            start = begin_transaction(&slaves[idx], ctx);
+            rc = modbus_write_bit(ctx, coil_addr, coil_value);
+            end_transaction(&slaves[idx], start, rc);
+
+            if(rc == -1)
+            {
+                #ifdef PRINT_DEBUG
+                    fprintf(stderr, "Failed to set coil status, address: %u: %s\n", coil_addr, modbus_strerror(errno));
+                #endif
+                return 0;
+            }
 
             #ifdef PRINT_DEBUG
                 fprintf(stdout, "Set status: %s to coil, address: %u\n", coil_value ? "ON" : "OFF", coil_addr);
@@ -704,11 +1237,12 @@ uint8_t write_coil(uint16_t slave_id, uint8_t coil_addr, uint8_t coil_value, sim
     return 0;
 }
 
-uint8_t write_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, uint16_t holding_reg_value, simple_slave_t* slaves, 
+uint8_t write_holding_register(uint16_t slave_id, uint16_t holding_reg_addr, uint16_t holding_reg_value, simple_slave_t* slaves, 
                                uint8_t num_of_slaves, modbus_t* ctx)
 {
     uint8_t idx = 0;
-    uint8_t real_slave_id = (uint8_t)(slave_id - ((uint16_t)(slave_id / OFFSET_BY_PORT)) * OFFSET_BY_PORT); 
+    uint64_t start = 0;
+    int rc = -1;
 
     if(slaves == NULL)
     {
@@ -728,12 +1262,21 @@ uint8_t write_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, uint
         return 0;
     }
 
-    modbus_set_slave(ctx, real_slave_id);
-    for(uint8_t i = 0; i < slaves[idx].num_of_holding_registers; i++)
+    for(uint16_t i = 0; i < slaves[idx].num_of_holding_registers; i++)
     {
         if(slaves[idx].holding_registers_addr[i] == holding_reg_addr)
         {
-            modbus_write_register(ctx, holding_reg_addr, holding_reg_value);
+            start = begin_transaction(&slaves[idx], ctx);
+            rc = modbus_write_register(ctx, holding_reg_addr, holding_reg_value);
+            end_transaction(&slaves[idx], start, rc);
+
+            if(rc == -1)
+            {
+                #ifdef PRINT_DEBUG
+                    fprintf(stderr, "Failed to set holding register value, address: %u: %s\n", holding_reg_addr, modbus_strerror(errno));
+                #endif
+                return 0;
+            }
 
             #ifdef PRINT_DEBUG
                 fprintf(stdout, "Set value: %u to holding register, address: %u\n", holding_reg_value, holding_reg_addr);
@@ -749,3 +1292,66 @@ uint8_t write_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, uint
     return 0;
 }
 
+uint8_t write_slave_coils(simple_slave_t* slave, uint16_t coil_addr, uint16_t count, const uint8_t* coil_values, modbus_t* ctx)
+{
+    uint64_t start = 0;
+    int rc = -1;
+
+    if(slave == NULL || coil_values == NULL || count == 0 || count > MODBUS_MAX_WRITE_BITS)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to set coils status, invalid arguments.\n");
+        #endif
+        return 0;
+    }
+
+    start = begin_transaction(slave, ctx);
+    rc = (count == 1) ? modbus_write_bit(ctx, coil_addr, coil_values[0]) : modbus_write_bits(ctx, coil_addr, count, coil_values);
+    end_transaction(slave, start, rc);
+
+    if(rc == -1)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to set coils status, address: %u, count: %u: %s\n", coil_addr, count, modbus_strerror(errno));
+        #endif
+        return 0;
+    }
+
+    #ifdef PRINT_DEBUG
+        fprintf(stdout, "Set status of %u coils, address: %u\n", count, coil_addr);
+    #endif
+    return 1;
+}
+
+uint8_t write_slave_holding_registers(simple_slave_t* slave, uint16_t holding_reg_addr, uint16_t count, const uint16_t* holding_reg_values, 
+                                      modbus_t* ctx)
+{
+    uint64_t start = 0;
+    int rc = -1;
+
+    if(slave == NULL || holding_reg_values == NULL || count == 0 || count > MODBUS_MAX_WRITE_REGISTERS)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to set holding registers value, invalid arguments.\n");
+        #endif
+        return 0;
+    }
+
+    start = begin_transaction(slave, ctx);
+    rc = (count == 1) ? modbus_write_register(ctx, holding_reg_addr, holding_reg_values[0]) : 
+                        modbus_write_registers(ctx, holding_reg_addr, count, holding_reg_values);
+    end_transaction(slave, start, rc);
+
+    if(rc == -1)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to set holding registers value, address: %u, count: %u: %s\n", holding_reg_addr, count, modbus_strerror(errno));
+        #endif
+        return 0;
+    }
+
+    #ifdef PRINT_DEBUG
+        fprintf(stdout, "Set value of %u holding registers, address: %u\n", count, holding_reg_addr);
+    #endif
+    return 1;
+}
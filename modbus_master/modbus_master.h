@@ -15,6 +15,9 @@
 
 #define MAX_SLAVE_NAME_LEN 64
 #define RESPONSE_TIMEOUT 100000
+#define RESPONSE_TIMEOUT_FLOOR 20000
+#define RESPONSE_TIMEOUT_CEILING 1000000
+#define RESPONSE_TIMEOUT_MARGIN 10000
 #define SERIAL_PORTS_NUM 6
 #define OFFSET_BY_PORT 1000
 
@@ -33,22 +36,95 @@
 #define MODBUS_PARITY_ODD  'O'
 #define MODBUS_PARITY_EVEN 'E'
 
+#define READ_PLAN_DEFAULT_MAX_GAP 0
+#define DEFAULT_SCAN_PERIOD 1000
+#define DEFAULT_WRITE_WINDOW 0
+
+#define DEADBAND_NONE     0
+#define DEADBAND_ABSOLUTE 1
+#define DEADBAND_PERCENT  2
+
 /**
- * @brief Structure that represents a simple modbus slave used to parse json config file
+ * @brief Structure that represents the deadband of a register used to decide when a
+ * change of value is reported as a spontaneous event
  */
-typedef struct simple_slave 
+typedef struct deadband
 {
-    uint16_t id;
-    char name[MAX_SLAVE_NAME_LEN];
-    uint8_t num_of_coils;
-    uint8_t* coils_addr;
-    uint8_t num_of_discrete_inputs;
-    uint8_t* discrete_inputs_addr;
-    uint8_t num_of_input_registers;
-    uint8_t* input_registers_addr;
-    uint8_t num_of_holding_registers;
-    uint8_t* holding_registers_addr;
-} simple_slave_t;
+    uint8_t type;
+    double value;
+} deadband_t;
+
+#define RTT_HISTOGRAM_BUCKETS 16
+#define RTT_HISTOGRAM_BASE 500
+#define RTT_HISTOGRAM_MAX_SAMPLES 1024
+#define RTT_MIN_SAMPLES 32
+#define RTT_EWMA_WEIGHT 0.125
+#define RTT_TIMEOUT_PERCENTILE 0.99
+
+/**
+ * @brief Structure that holds round trip time statistics of a slave, all times are in microseconds.
+ * Histogram bucket 0 counts round trip times below RTT_HISTOGRAM_BASE, every next bucket covers
+ * twice the range of the previous one and the last bucket is open ended. Counts are halved when
+ * RTT_HISTOGRAM_MAX_SAMPLES is reached so the statistics follow changes of the device.
+ */
+typedef struct rtt_stats
+{
+    double ewma;
+    uint32_t histogram[RTT_HISTOGRAM_BUCKETS];
+    uint32_t samples;
+    uint32_t requests;
+    uint32_t timeouts;
+    uint32_t response_timeout;
+    uint32_t response_timeout_floor;
+    uint32_t response_timeout_ceiling;
+} rtt_stats_t;
+
+#define SLAVE_STATE_ONLINE  0
+#define SLAVE_STATE_SUSPECT 1
+#define SLAVE_STATE_OFFLINE 2
+
+#define SLAVE_OFFLINE_FAILURES   3
+#define SLAVE_PROBE_INTERVAL_MIN 1000
+#define SLAVE_PROBE_INTERVAL_MAX 60000
+
+/**
+ * @brief Structure that holds health state of a slave. A slave that does not answer becomes suspect,
+ * after SLAVE_OFFLINE_FAILURES consecutive missing answers it is offline and it is only probed
+ * once per probe interval. The probe interval doubles after every failed probe up to
+ * SLAVE_PROBE_INTERVAL_MAX. Any answer brings the slave back online. Times are in milliseconds.
+ */
+typedef struct slave_health
+{
+    uint8_t state;
+    uint8_t failures;
+    uint32_t probe_interval;
+    uint64_t next_probe;
+} slave_health_t;
+
+/**
+ * @brief Structure that represents one block read request (FC1/FC2/FC3/FC4) which covers
+ * several configured addresses of a slave
+ */
+typedef struct read_block
+{
+    uint8_t function;
+    uint16_t start_addr;
+    uint16_t count;
+    uint32_t scan_period;
+    uint16_t* points;
+    uint16_t num_of_points;
+} read_block_t;
+
+/**
+ * @brief Structure that holds all block read requests needed to interrogate a slave,
+ * built once when the config file is loaded
+ */
+typedef struct read_plan
+{
+    read_block_t* blocks;
+    uint16_t num_of_blocks;
+    uint16_t* points;
+} read_plan_t;
 
 /**
  * @brief Structure that holds interrogation response of certain slave
@@ -56,15 +132,42 @@ typedef struct simple_slave
 typedef struct interrogation_response
 {
     uint8_t* coils;
-    uint8_t num_of_coils;
+    uint16_t num_of_coils;
     uint8_t* discrete_inputs;
-    uint8_t num_of_discrete_inputs;
+    uint16_t num_of_discrete_inputs;
     uint16_t* input_regs;
-    uint8_t num_of_input_registers;
+    uint16_t num_of_input_registers;
     uint16_t* holding_regs;
-    uint8_t num_of_holding_registers;
+    uint16_t num_of_holding_registers;
 } interrogation_response_t;
 
+/**
+ * @brief Structure that represents a simple modbus slave used to parse json config file
+ */
+typedef struct simple_slave 
+{
+    uint16_t id;
+    char name[MAX_SLAVE_NAME_LEN];
+    uint16_t num_of_coils;
+    uint16_t* coils_addr;
+    uint16_t num_of_discrete_inputs;
+    uint16_t* discrete_inputs_addr;
+    uint16_t num_of_input_registers;
+    uint16_t* input_registers_addr;
+    uint16_t num_of_holding_registers;
+    uint16_t* holding_registers_addr;
+    deadband_t* input_registers_deadband;
+    deadband_t* holding_registers_deadband;
+    uint32_t* coils_scan_period;
+    uint32_t* discrete_inputs_scan_period;
+    uint32_t* input_registers_scan_period;
+    uint32_t* holding_registers_scan_period;
+    read_plan_t read_plan;
+    rtt_stats_t rtt;
+    slave_health_t health;
+    interrogation_response_t response;
+} simple_slave_t;
+
 /**
  * @brief Structure used to represent configuration data for serial port used in modbus connection
  */
@@ -74,6 +177,11 @@ typedef struct serial_configuration
     uint8_t data_bits;
     uint8_t stop_bits;
     char parity;
+    uint16_t max_read_gap;
+    uint32_t poll_interval;
+    uint32_t response_timeout_floor;
+    uint32_t response_timeout_ceiling;
+    uint32_t write_window;
 } serial_configuration_t;
 
 /**
@@ -84,7 +192,42 @@ typedef struct serial_configuration
  * 
  * @returns Dynamically allocated array of existing slave coils/registers addresses or NULL if failure
  */
-uint8_t* parse_address_array(json_t* json_array, uint8_t* count);
+uint16_t* parse_address_array(json_t* json_array, uint16_t* count);
+
+/**
+ * @brief Function that parses deadbands of registers from the slave configuration of json config file.
+ * Each register may define either "deadband" (absolute) or "deadband_percent" (relative to the last
+ * reported value). Registers without a deadband report every change.
+ * 
+ * @param json_array JSON object that points to the array of existing registers
+ * @param count Number of elements in the array
+ * 
+ * @returns Dynamically allocated array of register deadbands or NULL if failure
+ */
+deadband_t* parse_deadband_array(json_t* json_array, uint16_t count);
+
+/**
+ * @brief Function that parses scan periods of coils/registers from the slave configuration of json config file.
+ * Each element may define "scan_period" in milliseconds, elements without it use the default period.
+ * 
+ * @param json_array JSON object that points to the array of existing coils/registers
+ * @param count Number of elements in the array
+ * @param default_period Scan period in milliseconds used for elements without "scan_period"
+ * 
+ * @returns Dynamically allocated array of scan periods or NULL if failure
+ */
+uint32_t* parse_scan_period_array(json_t* json_array, uint16_t count, uint32_t default_period);
+
+/**
+ * @brief Function that checks whether the change of a register value exceeds its deadband
+ * 
+ * @param deadband Deadband of the register
+ * @param reported Last reported value of the register
+ * @param value New value of the register
+ * 
+ * @returns 1 if the change has to be reported, 0 otherwise
+ */
+uint8_t deadband_exceeded(deadband_t* deadband, int16_t reported, int16_t value);
 
 /**
  * @brief Function that parses the json config file and searches for slave devices configuration
@@ -97,6 +240,26 @@ uint8_t* parse_address_array(json_t* json_array, uint8_t* count);
  */
 simple_slave_t** parse_slaves(json_t* root, uint8_t* num_of_slaves, serial_configuration_t* cfg);
 
+/**
+ * @brief Function that merges configured addresses of a slave into block read requests.
+ * Addresses of the same type and scan period are sorted and merged into one block as long as
+ * the distance between neighbouring addresses is not larger than max_gap and the block fits
+ * into one modbus request. Unconfigured addresses inside a block are read and discarded.
+ * 
+ * @param slave Slave object whose read plan is built
+ * @param max_gap Maximum number of unconfigured addresses allowed between two configured ones in a block
+ * 
+ * @returns 1 on success, 0 on failure
+ */
+uint8_t build_read_plan(simple_slave_t* slave, uint16_t max_gap);
+
+/**
+ * @brief Function that releases the memory allocated for a read plan
+ * 
+ * @param plan Read plan to be released
+ */
+void free_read_plan(read_plan_t* plan);
+
 /**
  * @brief Function that releases the memory allocated for slave device objects
  * 
@@ -113,7 +276,17 @@ void free_slaves(simple_slave_t** slaves, uint8_t* num_of_slaves);
 void free_modbus(modbus_t** ctx);
 
 /**
- * @brief Function that releases memory used to store interrogation response data
+ * @brief Function that allocates arrays of an interrogation response sized for all configured points of a slave
+ * 
+ * @param resp Response structure to be initialized
+ * @param slave Slave object
+ * 
+ * @returns 1 on success, 0 on failure
+ */
+uint8_t init_interrogation_response(interrogation_response_t* resp, simple_slave_t* slave);
+
+/**
+ * @brief Function that releases memory used to store interrogation response data. The structure itself is not released.
  * 
  * @param resp - Response structure for releasing
  */
@@ -165,6 +338,75 @@ void print_slaves(simple_slave_t** slaves, uint8_t* num_of_slaves);
  */
 uint8_t get_slave_idx(uint16_t slave_id, simple_slave_t* slaves, uint8_t num_of_slaves);
 
+/**
+ * @brief Function that retreives index of a configured coil/input/register from the slave address arrays
+ * 
+ * @param slave Slave object that is searched
+ * @param function Modbus read function code (FC1, FC2, FC3 or FC4) that selects the address array
+ * @param addr Address of the coil/input/register
+ * 
+ * @return Index in the address array that matches with given address or -1 if address is not configured
+ */
+int get_point_idx(simple_slave_t* slave, uint8_t function, uint16_t addr);
+
+/**
+ * @brief Function that initializes round trip time statistics of a slave. Response timeout of the
+ * slave starts at RESPONSE_TIMEOUT and after RTT_MIN_SAMPLES responses it follows the observed
+ * 99th percentile of round trip time plus RESPONSE_TIMEOUT_MARGIN, limited by floor and ceiling.
+ * 
+ * @param rtt Statistics to be initialized
+ * @param floor Lowest allowed response timeout in microseconds
+ * @param ceiling Highest allowed response timeout in microseconds
+ */
+void init_rtt_stats(rtt_stats_t* rtt, uint32_t floor, uint32_t ceiling);
+
+/**
+ * @brief Function that estimates a percentile of round trip time from the histogram
+ * 
+ * @param rtt Round trip time statistics
+ * @param percentile Percentile in range (0, 1]
+ * 
+ * @returns Estimated round trip time in microseconds or 0 if there are no samples
+ */
+uint32_t get_rtt_percentile(rtt_stats_t* rtt, double percentile);
+
+/**
+ * @brief Function that copies round trip time statistics of a slave. Statistics are updated
+ * by the thread that uses the modbus context, so the copy is only a snapshot.
+ * 
+ * @param slave Slave object
+ * @param stats Structure where statistics are copied
+ */
+void get_rtt_stats(simple_slave_t* slave, rtt_stats_t* stats);
+
+/**
+ * @brief Function that initializes health state of a slave as online
+ * 
+ * @param health Health state to be initialized
+ */
+void init_slave_health(slave_health_t* health);
+
+/**
+ * @brief Function that checks whether requests may be sent to a slave. Offline slaves are
+ * only available when their next probe is due.
+ * 
+ * @param slave Slave object
+ * @param now Current monotonic time in milliseconds
+ * 
+ * @returns 1 if a request may be sent, 0 if the slave has to be skipped
+ */
+uint8_t is_slave_available(simple_slave_t* slave, uint64_t now);
+
+/**
+ * @brief Function that updates health state of a slave with the outcome of a request. Called
+ * automatically by all functions that send modbus requests.
+ * 
+ * @param slave Slave object
+ * @param answered 1 if the slave answered (even with an exception), 0 if the request timed out
+ * @param now Current monotonic time in milliseconds
+ */
+void update_slave_health(simple_slave_t* slave, uint8_t answered, uint64_t now);
+
 /**
  * @brief Function that gathers data of all coils, inputs and registers of the specified slave
  * 
@@ -173,61 +415,79 @@ uint8_t get_slave_idx(uint16_t slave_id, simple_slave_t* slaves, uint8_t num_of_
  * @param num_of_slaves Number of allocated slave objects
  * @param ctx Initialized modbus context
  * 
- * @returns Dynamically allocated and filled interrogation response structure or NULL if failure
+ * @returns Interrogation response buffer of the slave or NULL if failure. The buffer is allocated at config load,
+ * it is overwritten by the next interrogation and must not be released by the caller.
  */
 interrogation_response_t* interrogate_slave(uint16_t slave_id, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
 
+/**
+ * @brief Function that executes one block read request of a slave and scatters the
+ * received values into the matching fields of the response structure
+ * 
+ * @param slave Slave object that owns the block
+ * @param block Block read request from the slave read plan
+ * @param resp Response structure with arrays sized for the slave configuration
+ * @param ctx Initialized modbus context
+ * 
+ * @returns 1 on success, 0 on failure
+ */
+uint8_t read_block(simple_slave_t* slave, read_block_t* block, interrogation_response_t* resp, modbus_t* ctx);
+
 /**
  * @brief Function that reads status of one coil
  * 
  * @param slave_id Address (id) of the slave device
  * @param coil_addr Address of the coil to be read
+ * @param value Variable where the status of the coil is stored
  * @param slaves The array of existing slaves
  * @param num_of_slaves Number of allocated slave objects
  * @param ctx Initialized modbus context
  * 
- * @returns Dynamically allocated variable holding the status of a coil or NULL if failure
+ * @returns 1 on success, 0 on failure (invalid address or no valid response from the slave)
  */
-uint8_t* read_coil(uint16_t slave_id, uint8_t coil_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
+uint8_t read_coil(uint16_t slave_id, uint16_t coil_addr, uint8_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
 
 /**
  * @brief Function that reads status of one discrete input
  * 
  * @param slave_id Address (id) of the slave device
  * @param discrete_input_addr Address of the discrete input to be read
+ * @param value Variable where the status of the discrete input is stored
  * @param slaves The array of existing slaves
  * @param num_of_slaves Number of allocated slave objects
  * @param ctx Initialized modbus context
  * 
- * @returns Dynamically allocated variable holding the status of a discrete input or NULL if failure
+ * @returns 1 on success, 0 on failure (invalid address or no valid response from the slave)
  */
-uint8_t* read_discrete_input(uint16_t slave_id, uint8_t discrete_input_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
+uint8_t read_discrete_input(uint16_t slave_id, uint16_t discrete_input_addr, uint8_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
 
 /**
  * @brief Function that reads value from one input register
  * 
  * @param slave_id Address (id) of the slave device
  * @param input_reg_addr Address of the input register to be read
+ * @param value Variable where the value of the input register is stored
  * @param slaves The array of existing slaves
  * @param num_of_slaves Number of allocated slave objects
  * @param ctx Initialized modbus context
  * 
- * @returns Dynamically allocated variable holding the value of an input register or NULL if failure
+ * @returns 1 on success, 0 on failure (invalid address or no valid response from the slave)
  */
-uint16_t* read_input_register(uint16_t slave_id, uint8_t input_reg_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
+uint8_t read_input_register(uint16_t slave_id, uint16_t input_reg_addr, uint16_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
 
 /**
  * @brief Function that reads value from one holding register
  * 
  * @param slave_id Address (id) of the slave device
  * @param holding_reg_addr Address of the holding register to be read
+ * @param value Variable where the value of the holding register is stored
  * @param slaves The array of existing slaves
  * @param num_of_slaves Number of allocated slave objects
  * @param ctx Initialized modbus context
  * 
- * @returns Dynamically allocated variable holding the value of a holding register or NULL if failure
+ * @returns 1 on success, 0 on failure (invalid address or no valid response from the slave)
  */
-uint16_t* read_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
+uint8_t read_holding_register(uint16_t slave_id, uint16_t holding_reg_addr, uint16_t* value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
 
 /**
  * @brief Function that sets state of one coil
@@ -239,9 +499,9 @@ uint16_t* read_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, sim
  * @param num_of_slaves Number of allocated slave objects
  * @param ctx Initialized modbus context
  * 
- * @returns 1 on succes, 0 on failure
+ * @returns 1 on succes, 0 on failure (invalid address or no valid response from the slave)
  */
-uint8_t write_coil(uint16_t slave_id, uint8_t coil_addr, uint8_t coil_value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
+uint8_t write_coil(uint16_t slave_id, uint16_t coil_addr, uint8_t coil_value, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
 
 /**
  * @brief Function that writes value to one holding register
@@ -253,11 +513,42 @@ uint8_t write_coil(uint16_t slave_id, uint8_t coil_addr, uint8_t coil_value, sim
  * @param num_of_slaves Number of allocated slave objects
  * @param ctx Initialized modbus context
  * 
- * @returns 1 on succes, 0 on failure
+ * @returns 1 on succes, 0 on failure (invalid address or no valid response from the slave)
  */
-uint8_t write_holding_register(uint16_t slave_id, uint8_t holding_reg_addr, uint16_t holding_reg_value, simple_slave_t* slaves, 
+uint8_t write_holding_register(uint16_t slave_id, uint16_t holding_reg_addr, uint16_t holding_reg_value, simple_slave_t* slaves, 
                                uint8_t num_of_slaves, modbus_t* ctx);
 
+/**
+ * @brief Function that sets state of contiguous coils of an already resolved slave. The address range
+ * is not checked against the configuration, the caller must have resolved every address already.
+ * One coil is written with FC5, more coils with one FC15 request.
+ * 
+ * @param slave Slave object
+ * @param coil_addr Address of the first coil to set
+ * @param count Number of coils to set
+ * @param coil_values Values to be written, valid values are COIL_ON_VALUE and COIL_OFF_VALUE
+ * @param ctx Initialized modbus context
+ * 
+ * @returns 1 on succes, 0 on failure (no valid response from the slave)
+ */
+uint8_t write_slave_coils(simple_slave_t* slave, uint16_t coil_addr, uint16_t count, const uint8_t* coil_values, modbus_t* ctx);
+
+/**
+ * @brief Function that writes values to contiguous holding registers of an already resolved slave. The address
+ * range is not checked against the configuration, the caller must have resolved every address already.
+ * One register is written with FC6, more registers with one FC16 request.
+ * 
+ * @param slave Slave object
+ * @param holding_reg_addr Address of the first holding register to be written
+ * @param count Number of holding registers to be written
+ * @param holding_reg_values Values to be written
+ * @param ctx Initialized modbus context
+ * 
+ * @returns 1 on succes, 0 on failure (no valid response from the slave)
+ */
+uint8_t write_slave_holding_registers(simple_slave_t* slave, uint16_t holding_reg_addr, uint16_t count, const uint16_t* holding_reg_values, 
+                                      modbus_t* ctx);
+
 
 
 #endif
@@ -36,10 +36,10 @@ int main()
 
     uint8_t idx = 0;
     uint16_t slave_id = 0;
-    uint8_t target_address = 0;
+    uint16_t target_address = 0;
     uint16_t target_value = 0;
-    uint8_t* recv_value8 = NULL;
-    uint16_t* recv_value16 = NULL;
+    uint8_t recv_value8 = 0;
+    uint16_t recv_value16 = 0;
     interrogation_response_t* resp = NULL;
 
     /* Add CTRL-C handler */
@@ -114,102 +114,93 @@ int main()
             else
             {
                 fprintf(stdout, "Slave interrogation successful.\n");
-                free_interrogation_response(resp);
             }
             break;
         case READ_COIL_CMD:
             fprintf(stdout, "Slave ID: ");
             scanf("%hu", &slave_id);
             fprintf(stdout, "Coil address: ");
-            scanf("%hhu", &target_address);
+            scanf("%hu", &target_address);
             idx = slave_id / OFFSET_BY_PORT - 1;
             if(idx < 0 || idx >= SERIAL_PORTS_NUM)
             {
                 fprintf(stderr, "Invalid slave ID, index out of bounds.\n");
                 break;
             }
-            recv_value8 = read_coil(slave_id, target_address, slaves[idx], num_of_slaves[idx], ctx[idx]);
-            if(recv_value8 == NULL)
+            if(read_coil(slave_id, target_address, &recv_value8, slaves[idx], num_of_slaves[idx], ctx[idx]) == 0)
             {
                 fprintf(stdout, "Reading coil status failed.\n");
             }
             else
             {
                 fprintf(stdout, "Coil status reading successful.\n");
-                free(recv_value8);
             }
             break;
         case READ_DISCRETE_INPUT_CMD:
             fprintf(stdout, "Slave ID: ");
             scanf("%hu", &slave_id);
             fprintf(stdout, "Discrete input address: ");
-            scanf("%hhu", &target_address);
+            scanf("%hu", &target_address);
             idx = slave_id / OFFSET_BY_PORT - 1;
             if(idx < 0 || idx >= SERIAL_PORTS_NUM)
             {
                 fprintf(stderr, "Invalid slave ID, index out of bounds.\n");
                 break;
             }
-            recv_value8 = read_discrete_input(slave_id, target_address, slaves[idx], num_of_slaves[idx], ctx[idx]);
-            if(recv_value8 == NULL)
+            if(read_discrete_input(slave_id, target_address, &recv_value8, slaves[idx], num_of_slaves[idx], ctx[idx]) == 0)
             {
                 fprintf(stdout, "Reading discrete input status failed.\n");
             }
             else
             {
                 fprintf(stdout, "Discrete input status reading successful.\n");
-                free(recv_value8);
             }
             break;
         case READ_INPUT_REGISTER_CMD:
             fprintf(stdout, "Slave ID: ");
             scanf("%hu", &slave_id);
             fprintf(stdout, "Input register address: ");
-            scanf("%hhu", &target_address);
+            scanf("%hu", &target_address);
             idx = slave_id / OFFSET_BY_PORT - 1;
             if(idx < 0 || idx >= SERIAL_PORTS_NUM)
             {
                 fprintf(stderr, "Invalid slave ID, index out of bounds.\n");
                 break;
             }
-            recv_value16 = read_input_register(slave_id, target_address, slaves[idx], num_of_slaves[idx], ctx[idx]);
-            if(recv_value16 == NULL)
+            if(read_input_register(slave_id, target_address, &recv_value16, slaves[idx], num_of_slaves[idx], ctx[idx]) == 0)
             {
                 fprintf(stdout, "Reading input register value failed.\n");
             }
             else
             {
                 fprintf(stdout, "Input register value reading successful.\n");
-                free(recv_value16);
             }
             break;
         case READ_HOLDING_REGISTER_CMD:
             fprintf(stdout, "Slave ID: ");
             scanf("%hu", &slave_id);
             fprintf(stdout, "Holding register address: ");
-            scanf("%hhu", &target_address);
+            scanf("%hu", &target_address);
             idx = slave_id / OFFSET_BY_PORT - 1;
             if(idx < 0 || idx >= SERIAL_PORTS_NUM)
             {
                 fprintf(stderr, "Invalid slave ID, index out of bounds.\n");
                 break;
             }
-            recv_value16 = read_holding_register(slave_id, target_address, slaves[idx], num_of_slaves[idx], ctx[idx]);
-            if(recv_value16 == NULL)
+            if(read_holding_register(slave_id, target_address, &recv_value16, slaves[idx], num_of_slaves[idx], ctx[idx]) == 0)
             {
                 fprintf(stdout, "Reading holding register value failed.\n");
             }
             else
             {
                 fprintf(stdout, "Holding register value reading successful.\n");
-                free(recv_value16);
             }
             break;
         case WRITE_COIL_CMD:
             fprintf(stdout, "Slave ID: ");
             scanf("%hu", &slave_id);
             fprintf(stdout, "Coil address: ");
-            scanf("%hhu", &target_address);
+            scanf("%hu", &target_address);
             fprintf(stdout, "Coil value (0, 1): ");
             scanf("%hu", &target_value);
             if(target_value > 0)
@@ -239,7 +230,7 @@ int main()
             fprintf(stdout, "Slave ID: ");
             scanf("%hu", &slave_id);
             fprintf(stdout, "Holding register address: ");
-            scanf("%hhu", &target_address);
+            scanf("%hu", &target_address);
             fprintf(stdout, "Holding register value (0 - 65535): ");
             scanf("%hu", &target_value);
             idx = slave_id / OFFSET_BY_PORT - 1;
@@ -65,6 +65,34 @@
  */
 #define CONFIG_CS104_MAX_CLIENT_CONNECTIONS 100
 
+/**
+ * Size of the CS 104 receive buffer of each connection. The socket is read in chunks of up to this
+ * size and all complete APDUs are handled before the socket is read again.
+ * Has to be at least 255 bytes (maximum APDU size).
+ */
+#define CONFIG_CS104_RECV_BUFFER_SIZE 1024
+
+/**
+ * Size of the CS 104 slave transmit buffer of each connection. Waiting ASDUs are collected
+ * in this buffer and written to the socket at once.
+ * Has to be at least 255 bytes (maximum APDU size).
+ */
+#define CONFIG_CS104_SEND_BUFFER_SIZE 2048
+
+/**
+ * Support a memory mapped file as low-priority queue of the CS 104 slave (see CS104_Slave_setPersistentQueue).
+ * Requires the file system HAL.
+ */
+#define CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE 1
+
+/**
+ * The persistent queue file is synchronized with the storage device when this number of
+ * ASDUs was added or when the last synchronization is older than CONFIG_CS104_PERSISTENT_QUEUE_SYNC_INTERVAL ms.
+ */
+#define CONFIG_CS104_PERSISTENT_QUEUE_SYNC_ENTRIES 256
+
+#define CONFIG_CS104_PERSISTENT_QUEUE_SYNC_INTERVAL 100
+
 /* activate TCP keep alive mechanism. 1 -> activate */
 #define CONFIG_ACTIVATE_TCP_KEEPALIVE 0
 
@@ -0,0 +1,131 @@
+/*
+ * Compares the decoding of M_ME_NB_1 (measured value, scaled) ASDUs with CS101_ASDU_getElement,
+ * which allocates and frees one information object per element, against CS101_ASDU_forEachElement,
+ * which decodes all elements into one stack instance.
+ *
+ * Usage: asdu_decode_benchmark [iterations]
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cs101_information_objects.h"
+#include "iec60870_common.h"
+
+#include "hal_time.h"
+
+#define DEFAULT_ITERATIONS 200000
+
+/* Application layer parameters of IEC 60870-5-104 */
+static struct sCS101_AppLayerParameters alParameters = {
+    /* .sizeOfTypeId = */ 1,
+    /* .sizeOfVSQ = */ 1,
+    /* .sizeOfCOT = */ 2,
+    /* .originatorAddress = */ 0,
+    /* .sizeOfCA = */ 2,
+    /* .sizeOfIOA = */ 3,
+    /* .maxSizeOfASDU = */ 249
+};
+
+static bool
+sumValues(void* parameter, CS101_ASDU asdu, int index, InformationObject io)
+{
+    long* sum = (long*) parameter;
+
+    *sum += MeasuredValueScaled_getValue((MeasuredValueScaled) io) + MeasuredValueScaled_getQuality((MeasuredValueScaled) io);
+
+    return true;
+}
+
+static CS101_ASDU
+createAsdu(bool isSequence)
+{
+    CS101_ASDU asdu = CS101_ASDU_create(&alParameters, isSequence, CS101_COT_SPONTANEOUS, 0, 1, false, false);
+    MeasuredValueScaled io = NULL;
+    int i = 0;
+
+    /* Fill the ASDU up to its maximum size */
+    while (true) {
+        io = MeasuredValueScaled_create(NULL, 100 + i, i, IEC60870_QUALITY_GOOD);
+
+        bool added = CS101_ASDU_addInformationObject(asdu, (InformationObject) io);
+
+        MeasuredValueScaled_destroy(io);
+
+        if (added == false)
+            break;
+
+        i++;
+    }
+
+    return asdu;
+}
+
+static void
+runBenchmark(CS101_ASDU asdu, int iterations)
+{
+    int elements = CS101_ASDU_getNumberOfElements(asdu);
+    long sumGetElement = 0;
+    long sumForEach = 0;
+    uint64_t start;
+    uint64_t getElementTime;
+    uint64_t forEachTime;
+    int i;
+    int j;
+
+    start = Hal_getMonotonicTimeInNs();
+
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < elements; j++) {
+            MeasuredValueScaled io = (MeasuredValueScaled) CS101_ASDU_getElement(asdu, j);
+
+            sumGetElement += MeasuredValueScaled_getValue(io) + MeasuredValueScaled_getQuality(io);
+
+            MeasuredValueScaled_destroy(io);
+        }
+    }
+
+    getElementTime = Hal_getMonotonicTimeInNs() - start;
+
+    start = Hal_getMonotonicTimeInNs();
+
+    for (i = 0; i < iterations; i++)
+        CS101_ASDU_forEachElement(asdu, sumValues, &sumForEach);
+
+    forEachTime = Hal_getMonotonicTimeInNs() - start;
+
+    if (sumGetElement != sumForEach)
+        printf("  ERROR: decoded values differ\n");
+
+    printf("  %s, %i elements per ASDU, %i ASDUs\n", CS101_ASDU_isSequence(asdu) ? "SQ=1" : "SQ=0", elements, iterations);
+    printf("    getElement:     %6.1f ns/element\n", (double) getElementTime / ((double) iterations * elements));
+    printf("    forEachElement: %6.1f ns/element (%.2fx)\n", (double) forEachTime / ((double) iterations * elements),
+            (double) getElementTime / (double) forEachTime);
+}
+
+int
+main(int argc, char** argv)
+{
+    int iterations = DEFAULT_ITERATIONS;
+
+    if (argc > 1)
+        iterations = atoi(argv[1]);
+
+    if (iterations < 1) {
+        printf("Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Decoding M_ME_NB_1 ASDUs\n");
+
+    CS101_ASDU asdu = createAsdu(false);
+    runBenchmark(asdu, iterations);
+    CS101_ASDU_destroy(asdu);
+
+    asdu = createAsdu(true);
+    runBenchmark(asdu, iterations);
+    CS101_ASDU_destroy(asdu);
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * Measures the contention of CS104_Slave_enqueueASDU when several threads add events to the
+ * low-priority queue of a CS 104 slave at the same time. A client connected over the loopback
+ * interface receives the ASDUs, so the queue is drained by the sending connection as in normal operation.
+ *
+ * Usage: cs104_enqueue_benchmark [max producers] [duration per run in ms] [tcp port]
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cs104_slave.h"
+#include "cs104_connection.h"
+
+#include "hal_thread.h"
+#include "hal_time.h"
+
+#define DEFAULT_MAX_PRODUCERS 8
+#define DEFAULT_DURATION 2000
+#define DEFAULT_PORT 2414
+
+#define MAX_PRODUCERS 64
+
+typedef struct
+{
+    CS104_Slave slave;
+    int index;
+    uint64_t enqueued;
+} Producer;
+
+static volatile bool producing = false;
+
+static Semaphore receivedLock;
+static uint64_t received = 0;
+
+static bool
+asduReceivedHandler(void* parameter, int address, CS101_ASDU asdu)
+{
+    Semaphore_wait(receivedLock);
+    received++;
+    Semaphore_post(receivedLock);
+
+    return true;
+}
+
+static uint64_t
+getReceived(void)
+{
+    uint64_t value;
+
+    Semaphore_wait(receivedLock);
+    value = received;
+    Semaphore_post(receivedLock);
+
+    return value;
+}
+
+static void*
+producerThread(void* parameter)
+{
+    Producer* producer = (Producer*) parameter;
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(producer->slave);
+    CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_SPONTANEOUS, 0, 1, false, false);
+    MeasuredValueScaled io = MeasuredValueScaled_create(NULL, 100 + producer->index, producer->index, IEC60870_QUALITY_GOOD);
+
+    CS101_ASDU_addInformationObject(asdu, (InformationObject) io);
+    MeasuredValueScaled_destroy(io);
+
+    while (producing) {
+        CS104_Slave_enqueueASDU(producer->slave, asdu);
+        producer->enqueued++;
+    }
+
+    CS101_ASDU_destroy(asdu);
+
+    return NULL;
+}
+
+static void
+runBenchmark(CS104_Slave slave, int numberOfProducers, int duration)
+{
+    Producer producers[MAX_PRODUCERS];
+    Thread threads[MAX_PRODUCERS];
+    uint64_t enqueued = 0;
+    uint64_t receivedAtStart = getReceived();
+    uint64_t start;
+    uint64_t elapsed;
+    int i;
+
+    producing = true;
+
+    start = Hal_getMonotonicTimeInNs();
+
+    for (i = 0; i < numberOfProducers; i++) {
+        producers[i].slave = slave;
+        producers[i].index = i;
+        producers[i].enqueued = 0;
+
+        threads[i] = Thread_create(producerThread, &(producers[i]), false);
+        Thread_start(threads[i]);
+    }
+
+    Thread_sleep(duration);
+
+    producing = false;
+
+    for (i = 0; i < numberOfProducers; i++) {
+        Thread_destroy(threads[i]);
+        enqueued += producers[i].enqueued;
+    }
+
+    elapsed = Hal_getMonotonicTimeInNs() - start;
+
+    printf("%9i %14.0f %14.1f %14.0f\n", numberOfProducers, (double) enqueued * 1e9 / (double) elapsed,
+            (double) elapsed * numberOfProducers / (double) enqueued,
+            (double) (getReceived() - receivedAtStart) * 1e9 / (double) elapsed);
+}
+
+int
+main(int argc, char** argv)
+{
+    int maxProducers = DEFAULT_MAX_PRODUCERS;
+    int duration = DEFAULT_DURATION;
+    int port = DEFAULT_PORT;
+    int i;
+
+    if (argc > 1)
+        maxProducers = atoi(argv[1]);
+
+    if (argc > 2)
+        duration = atoi(argv[2]);
+
+    if (argc > 3)
+        port = atoi(argv[3]);
+
+    if ((maxProducers < 1) || (maxProducers > MAX_PRODUCERS) || (duration < 1)) {
+        printf("Usage: %s [max producers (1-%i)] [duration per run in ms] [tcp port]\n", argv[0], MAX_PRODUCERS);
+        return 1;
+    }
+
+    receivedLock = Semaphore_create(1);
+
+    CS104_Slave slave = CS104_Slave_create(10000, 100);
+
+    CS104_Slave_setLocalAddress(slave, "127.0.0.1");
+    CS104_Slave_setLocalPort(slave, port);
+    CS104_Slave_setServerMode(slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
+
+    CS104_Slave_start(slave);
+
+    if (CS104_Slave_isRunning(slave) == false) {
+        printf("Starting server failed!\n");
+        CS104_Slave_destroy(slave);
+        return 1;
+    }
+
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", port);
+
+    CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
+
+    if (CS104_Connection_connect(con) == false) {
+        printf("Connecting to server failed!\n");
+        CS104_Connection_destroy(con);
+        CS104_Slave_stop(slave);
+        CS104_Slave_destroy(slave);
+        return 1;
+    }
+
+    CS104_Connection_sendStartDT(con);
+
+    Thread_sleep(500);
+
+    printf("producers     enqueue/s  ns/enqueue/thr     received/s\n");
+
+    for (i = 1; i <= maxProducers; i++)
+        runBenchmark(slave, i, duration);
+
+    CS104_Connection_destroy(con);
+
+    CS104_Slave_stop(slave);
+    CS104_Slave_destroy(slave);
+
+    Semaphore_destroy(receivedLock);
+
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Checks that the ASDUs of a persistent low-priority queue survive a clean shutdown of the slave.
+ * A first slave instance enqueues ASDUs without a connected client and is stopped and destroyed.
+ * A second slave instance opens the same queue file and has to send all ASDUs in the original
+ * order to a client.
+ *
+ * Usage: cs104_persistent_queue_check [number of ASDUs] [queue file] [tcp port]
+ *
+ * Returns 0 when all ASDUs were received in order.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cs104_slave.h"
+#include "cs104_connection.h"
+
+#include "hal_thread.h"
+#include "hal_time.h"
+
+#define DEFAULT_NUMBER_OF_ASDUS 500
+#define DEFAULT_QUEUE_FILE "cs104_persistent_queue_check.queue"
+#define DEFAULT_PORT 2416
+
+/* Longest time to wait for all ASDUs */
+#define RECEIVE_TIMEOUT 10000
+
+static Semaphore receivedLock;
+static int received = 0;
+static int outOfOrder = 0;
+
+static bool
+asduReceivedHandler(void* parameter, int address, CS101_ASDU asdu)
+{
+    InformationObject io = CS101_ASDU_getElement(asdu, 0);
+
+    if (io) {
+        Semaphore_wait(receivedLock);
+
+        /* the IOAs are enqueued in ascending order starting with 1 */
+        if (InformationObject_getObjectAddress(io) != received + 1)
+            outOfOrder++;
+
+        received++;
+
+        Semaphore_post(receivedLock);
+
+        InformationObject_destroy(io);
+    }
+
+    return true;
+}
+
+static int
+getReceived(void)
+{
+    int value;
+
+    Semaphore_wait(receivedLock);
+    value = received;
+    Semaphore_post(receivedLock);
+
+    return value;
+}
+
+static CS104_Slave
+startSlave(int numberOfAsdus, const char* queueFile, int port)
+{
+    CS104_Slave slave = CS104_Slave_create(numberOfAsdus, 100);
+
+    CS104_Slave_setLocalAddress(slave, "127.0.0.1");
+    CS104_Slave_setLocalPort(slave, port);
+    CS104_Slave_setServerMode(slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
+    CS104_Slave_setPersistentQueue(slave, queueFile);
+
+    CS104_Slave_start(slave);
+
+    if (CS104_Slave_isRunning(slave) == false) {
+        printf("Starting server failed!\n");
+        CS104_Slave_destroy(slave);
+        return NULL;
+    }
+
+    return slave;
+}
+
+static void
+enqueueAsdus(CS104_Slave slave, int numberOfAsdus)
+{
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(slave);
+    int i;
+
+    for (i = 0; i < numberOfAsdus; i++) {
+        CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_SPONTANEOUS, 0, 1, false, false);
+
+        MeasuredValueScaled io = MeasuredValueScaled_create(NULL, i + 1, i, IEC60870_QUALITY_GOOD);
+
+        CS101_ASDU_addInformationObject(asdu, (InformationObject) io);
+        MeasuredValueScaled_destroy(io);
+
+        CS104_Slave_enqueueASDU(slave, asdu);
+
+        CS101_ASDU_destroy(asdu);
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    int numberOfAsdus = DEFAULT_NUMBER_OF_ASDUS;
+    const char* queueFile = DEFAULT_QUEUE_FILE;
+    int port = DEFAULT_PORT;
+    bool success = false;
+
+    if (argc > 1)
+        numberOfAsdus = atoi(argv[1]);
+
+    if (argc > 2)
+        queueFile = argv[2];
+
+    if (argc > 3)
+        port = atoi(argv[3]);
+
+    if (numberOfAsdus < 1) {
+        printf("Usage: %s [number of ASDUs] [queue file] [tcp port]\n", argv[0]);
+        return 1;
+    }
+
+    /* start with an empty queue */
+    remove(queueFile);
+
+    receivedLock = Semaphore_create(1);
+
+    CS104_Slave slave = startSlave(numberOfAsdus, queueFile, port);
+
+    if (slave == NULL)
+        goto exit_program;
+
+    enqueueAsdus(slave, numberOfAsdus);
+
+    /* clean shutdown */
+    CS104_Slave_stop(slave);
+    CS104_Slave_destroy(slave);
+
+    slave = startSlave(numberOfAsdus, queueFile, port);
+
+    if (slave == NULL)
+        goto exit_program;
+
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", port);
+
+    CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
+
+    if (CS104_Connection_connect(con)) {
+        uint64_t start = Hal_getMonotonicTimeInMs();
+
+        CS104_Connection_sendStartDT(con);
+
+        while ((getReceived() < numberOfAsdus) && (Hal_getMonotonicTimeInMs() - start < RECEIVE_TIMEOUT))
+            Thread_sleep(1);
+
+        /* give the slave time to send ASDUs that should not be there */
+        Thread_sleep(100);
+    }
+    else
+        printf("Connecting to server failed!\n");
+
+    CS104_Connection_destroy(con);
+
+    CS104_Slave_stop(slave);
+    CS104_Slave_destroy(slave);
+
+    printf("%i of %i ASDUs received after restart, %i out of order\n", received, numberOfAsdus, outOfOrder);
+
+    success = (received == numberOfAsdus) && (outOfOrder == 0);
+
+exit_program:
+    remove(queueFile);
+
+    Semaphore_destroy(receivedLock);
+
+    printf("%s\n", success ? "PASSED" : "FAILED");
+
+    return success ? 0 : 1;
+}
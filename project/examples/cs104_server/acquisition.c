@@ -0,0 +1,768 @@
+/**
+ * @file acquisition.c
+ *
+ * @brief This file contains implementation of acquisition worker threads and
+ * the process image shared with IEC 104 handlers
+ *
+ * @details Every worker owns the modbus line of its serial port, no other thread issues
+ * modbus requests. The process image is protected with one lock per port and it is only
+ * held while values are copied, never while a modbus request is in progress. To enable debug messages, please
+ * define PRINT_DEBUG.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acquisition.h"
+
+#define PRINT_DEBUG
+
+/* Longest idle wait of a worker without due blocks, the wakeup semaphore ends it earlier */
+#define ACQUISITION_MAX_IDLE 1000
+
+static point_value_t* alloc_points(uint16_t count)
+{
+    point_value_t* points = (point_value_t*) calloc(count > 0 ? count : 1, sizeof(point_value_t));
+
+    if(points != NULL)
+    {
+        for(uint16_t i = 0; i < count; i++)
+        {
+            points[i].quality = IEC60870_QUALITY_INVALID;
+            points[i].reported_quality = IEC60870_QUALITY_INVALID;
+        }
+    }
+    return points;
+}
+
+static uint16_t get_buffer_value(interrogation_response_t* buffer, uint8_t function, uint16_t point)
+{
+    switch(function)
+    {
+        case MODBUS_FC_READ_COILS:
+            return buffer->coils[point];
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            return buffer->discrete_inputs[point];
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            return buffer->input_regs[point];
+        default:
+            return buffer->holding_regs[point];
+    }
+}
+
+point_value_t* get_image_points(slave_image_t* image, uint8_t function)
+{
+    switch(function)
+    {
+        case MODBUS_FC_READ_COILS:
+            return image->coils;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            return image->discrete_inputs;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            return image->input_regs;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            return image->holding_regs;
+        default:
+            return NULL;
+    }
+}
+
+static uint8_t is_changed(simple_slave_t* slave, uint8_t function, uint16_t point, point_value_t* value)
+{
+    if(value->quality != value->reported_quality)
+    {
+        return 1;
+    }
+
+    switch(function)
+    {
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            return deadband_exceeded(&slave->input_registers_deadband[point], (int16_t) value->reported_value, (int16_t) value->value);
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            return deadband_exceeded(&slave->holding_registers_deadband[point], (int16_t) value->reported_value, (int16_t) value->value);
+        default:
+            return value->value != value->reported_value;
+    }
+}
+
+static void update_image(acquisition_port_t* acq, uint8_t slave_idx, read_block_t* block, uint8_t success)
+{
+    acquisition_event_t* events = acq->events;
+    uint16_t num_of_events = 0;
+    point_value_t* points = get_image_points(&acq->image[slave_idx], block->function);
+    uint64_t timestamp = Hal_getTimeInMs();
+    uint16_t point = 0;
+    QualityDescriptor failed_quality = IEC60870_QUALITY_NON_TOPICAL;
+
+    /* Values of an offline slave cannot be trusted at all */
+    if(acq->slaves[slave_idx].health.state == SLAVE_STATE_OFFLINE)
+    {
+        failed_quality |= IEC60870_QUALITY_INVALID;
+    }
+
+    acquisition_lock_image(acq);
+    for(uint16_t i = 0; i < block->num_of_points; i++)
+    {
+        point = block->points[i];
+        if(success)
+        {
+            points[point].value = get_buffer_value(&acq->slaves[slave_idx].response, block->function, point);
+            points[point].quality = IEC60870_QUALITY_GOOD;
+            points[point].timestamp = timestamp;
+        }
+        else
+        {
+            /* Keep the last known value but report that it is not up to date anymore */
+            points[point].quality |= failed_quality;
+        }
+
+        if(acq->event_handler != NULL && is_changed(&acq->slaves[slave_idx], block->function, point, &points[point]))
+        {
+            points[point].reported_value = points[point].value;
+            points[point].reported_quality = points[point].quality;
+            events[num_of_events].point = point;
+            events[num_of_events].value = points[point];
+            num_of_events++;
+        }
+    }
+    acq->stats.events += num_of_events;
+    acquisition_unlock_image(acq);
+
+    if(num_of_events > 0)
+    {
+        acq->event_handler(acq->event_handler_parameter, &acq->slaves[slave_idx], block->function, events, num_of_events);
+    }
+}
+
+/* Mark every point of a slave that just went offline, not only those of the failed block */
+static void invalidate_slave(acquisition_port_t* acq, uint8_t slave_idx)
+{
+    read_block_t* block = NULL;
+
+    for(uint16_t i = 0; i < acq->slaves[slave_idx].read_plan.num_of_blocks; i++)
+    {
+        block = &acq->slaves[slave_idx].read_plan.blocks[i];
+        update_image(acq, slave_idx, block, 0);
+    }
+}
+
+static scan_entry_t* get_next_entry(acquisition_port_t* acq)
+{
+    scan_entry_t* next = NULL;
+
+    for(uint16_t i = 0; i < acq->num_of_entries; i++)
+    {
+        if(next == NULL || acq->schedule[i].deadline < next->deadline)
+        {
+            next = &acq->schedule[i];
+        }
+    }
+    return next;
+}
+
+static void update_stats_window(acquisition_port_t* acq, uint64_t now)
+{
+    uint64_t window = now - acq->window_start;
+    double demand = 0;
+
+    if(window < ACQUISITION_STATS_WINDOW)
+    {
+        return;
+    }
+
+    for(uint16_t i = 0; i < acq->num_of_entries; i++)
+    {
+        demand += acq->schedule[i].cost / acq->schedule[i].block->scan_period;
+    }
+
+    acquisition_lock_image(acq);
+    acq->stats.utilisation = 100.0 * acq->window_busy / (window * 1000000.0);
+    acq->stats.demand = 100.0 * demand;
+    acquisition_unlock_image(acq);
+
+    #ifdef PRINT_DEBUG
+        if(demand > 1.0)
+        {
+            fprintf(stderr, "Serial port %u is oversubscribed, bus utilisation: %.1f %%, demand: %.1f %%\n", 
+                acq->port + 1, acq->stats.utilisation, acq->stats.demand);
+        }
+    #endif
+
+    acq->window_start = now;
+    acq->window_busy = 0;
+}
+
+/* Take the oldest command together with all queued writes of the same kind to the same slave. Returns NULL
+   when the queue is empty or the oldest command is still within its coalescing window. */
+static acquisition_command_t* pop_commands(acquisition_port_t* acq, bool flush, uint64_t* wait)
+{
+    acquisition_command_t* batch = NULL;
+    acquisition_command_t* batch_tail = NULL;
+    acquisition_command_t* prev = NULL;
+    acquisition_command_t* cmd = NULL;
+    acquisition_command_t* next = NULL;
+    uint64_t now = Hal_getMonotonicTimeInNs();
+    uint64_t due = 0;
+
+    Semaphore_wait(acq->command_lock);
+    cmd = acq->commands_head;
+    if(cmd != NULL)
+    {
+        due = cmd->queued_at + acq->write_window * 1000000ULL;
+        if(flush == false && now < due)
+        {
+            *wait = (due - now + 999999) / 1000000;
+            cmd = NULL;
+        }
+    }
+
+    if(cmd != NULL)
+    {
+        batch = cmd;
+        while(cmd != NULL)
+        {
+            next = cmd->next;
+            if(cmd->slave_idx == batch->slave_idx && cmd->type == batch->type)
+            {
+                if(prev == NULL)
+                {
+                    acq->commands_head = next;
+                }
+                else
+                {
+                    prev->next = next;
+                }
+                if(acq->commands_tail == cmd)
+                {
+                    acq->commands_tail = prev;
+                }
+
+                cmd->next = NULL;
+                if(batch_tail != NULL)
+                {
+                    batch_tail->next = cmd;
+                }
+                batch_tail = cmd;
+            }
+            else
+            {
+                prev = cmd;
+            }
+            cmd = next;
+        }
+    }
+    Semaphore_post(acq->command_lock);
+
+    return batch;
+}
+
+/* Stable insertion sort by address, so of two writes to the same address the newest one comes last */
+static acquisition_command_t* sort_commands(acquisition_command_t* batch)
+{
+    acquisition_command_t* sorted = NULL;
+    acquisition_command_t** pos = NULL;
+    acquisition_command_t* cmd = NULL;
+
+    while(batch != NULL)
+    {
+        cmd = batch;
+        batch = batch->next;
+
+        pos = &sorted;
+        while(*pos != NULL && (*pos)->address <= cmd->address)
+        {
+            pos = &(*pos)->next;
+        }
+        cmd->next = *pos;
+        *pos = cmd;
+    }
+    return sorted;
+}
+
+static void complete_command(acquisition_port_t* acq, acquisition_command_t* cmd, uint8_t result)
+{
+    /* Time from reception of the command until its confirmation can be sent */
+    double latency = (Hal_getMonotonicTimeInNs() - cmd->queued_at) / 1000000.0;
+
+    acquisition_lock_image(acq);
+    acq->stats.commands++;
+    acq->stats.command_latency_avg += (latency - acq->stats.command_latency_avg) / acq->stats.commands;
+    if(latency > acq->stats.command_latency_max)
+    {
+        acq->stats.command_latency_max = latency;
+    }
+    acquisition_unlock_image(acq);
+
+    if(cmd->handler != NULL)
+    {
+        cmd->handler(cmd->handler_parameter, result);
+    }
+    free(cmd);
+}
+
+/* Read the blocks covering the written address as soon as possible so the new state is reported */
+static void reschedule_written_block(acquisition_port_t* acq, acquisition_command_t* cmd, uint64_t now)
+{
+    uint8_t function = (cmd->type == ACQUISITION_CMD_WRITE_COIL) ? MODBUS_FC_READ_COILS : MODBUS_FC_READ_HOLDING_REGISTERS;
+    read_block_t* block = NULL;
+
+    for(uint16_t i = 0; i < acq->num_of_entries; i++)
+    {
+        block = acq->schedule[i].block;
+        if(acq->schedule[i].slave_idx == cmd->slave_idx && block->function == function &&
+           cmd->address >= block->start_addr && cmd->address < block->start_addr + block->count)
+        {
+            acq->schedule[i].deadline = now;
+        }
+    }
+}
+
+static void execute_batch(acquisition_port_t* acq, acquisition_command_t* batch)
+{
+    uint8_t bits[MODBUS_MAX_WRITE_BITS];
+    uint16_t regs[MODBUS_MAX_WRITE_REGISTERS];
+    acquisition_command_t* cmd = NULL;
+    acquisition_command_t* next = NULL;
+    uint16_t max = (batch->type == ACQUISITION_CMD_WRITE_COIL) ? MODBUS_MAX_WRITE_BITS : MODBUS_MAX_WRITE_REGISTERS;
+    uint16_t count = 0;
+    uint16_t offset = 0;
+    uint64_t start = 0;
+    uint8_t result = 0;
+    simple_slave_t* slave = &acq->slaves[batch->slave_idx];
+
+    /* Fail fast, the negative confirmation should not wait for a response timeout */
+    if(is_slave_available(slave, Hal_getMonotonicTimeInMs()) == 0)
+    {
+        for(cmd = batch; cmd != NULL; cmd = next)
+        {
+            next = cmd->next;
+            complete_command(acq, cmd, 0);
+        }
+        return;
+    }
+
+    batch = sort_commands(batch);
+    while(batch != NULL)
+    {
+        /* Run of writes to contiguous addresses, a repeated address keeps the newest value */
+        count = 0;
+        for(cmd = batch; cmd != NULL; cmd = cmd->next)
+        {
+            offset = cmd->address - batch->address;
+            if(offset > count || offset >= max)
+            {
+                break;
+            }
+            if(offset == count)
+            {
+                count++;
+            }
+            bits[offset] = (uint8_t) cmd->value;
+            regs[offset] = cmd->value;
+        }
+
+        start = Hal_getMonotonicTimeInNs();
+        /* Every address of the run was resolved when its command was queued, so no lookup is needed here */
+        if(batch->type == ACQUISITION_CMD_WRITE_COIL)
+        {
+            result = write_slave_coils(slave, batch->address, count, bits, acq->ctx);
+        }
+        else
+        {
+            result = write_slave_holding_registers(slave, batch->address, count, regs, acq->ctx);
+        }
+        acq->window_busy += Hal_getMonotonicTimeInNs() - start;
+
+        /* Every command of the run gets the combined result */
+        for(next = batch; next != cmd; )
+        {
+            batch = next;
+            next = batch->next;
+            if(result)
+            {
+                reschedule_written_block(acq, batch, Hal_getMonotonicTimeInMs());
+            }
+            complete_command(acq, batch, result);
+        }
+        batch = cmd;
+    }
+}
+
+/* Returns the time in milliseconds until the oldest queued command is due */
+static uint64_t execute_commands(acquisition_port_t* acq, bool flush)
+{
+    acquisition_command_t* batch = NULL;
+    uint64_t wait = ACQUISITION_MAX_IDLE;
+
+    while((batch = pop_commands(acq, flush, &wait)) != NULL)
+    {
+        execute_batch(acq, batch);
+    }
+    return wait;
+}
+
+static void* acquisition_thread(void* parameter)
+{
+    acquisition_port_t* acq = (acquisition_port_t*) parameter;
+    scan_entry_t* entry = NULL;
+    simple_slave_t* slave = NULL;
+    uint8_t state = SLAVE_STATE_ONLINE;
+    uint64_t now = 0;
+    uint64_t start = 0;
+    uint64_t cost = 0;
+    uint64_t wait = 0;
+    uint8_t success = 0;
+
+    #ifdef PRINT_DEBUG
+        fprintf(stdout, "Acquisition started on serial port %u\n", acq->port + 1);
+    #endif
+
+    now = Hal_getMonotonicTimeInMs();
+    acq->window_start = now;
+    acq->window_busy = 0;
+    for(uint16_t i = 0; i < acq->num_of_entries; i++)
+    {
+        acq->schedule[i].deadline = now;
+    }
+
+    while(acq->running)
+    {
+        /* Commands always go first, polling continues in the next gap between them */
+        wait = execute_commands(acq, false);
+
+        /* Earliest deadline first, idle until the next block or command is due */
+        entry = get_next_entry(acq);
+        now = Hal_getMonotonicTimeInMs();
+
+        if(entry == NULL || entry->deadline > now)
+        {
+            if(entry != NULL && entry->deadline - now < wait)
+            {
+                wait = entry->deadline - now;
+            }
+            /* Submitted commands end the wait, so they are executed in the current gap */
+            Semaphore_waitTimeout(acq->wakeup, (int) wait);
+            update_stats_window(acq, Hal_getMonotonicTimeInMs());
+            continue;
+        }
+
+        slave = &acq->slaves[entry->slave_idx];
+        if(is_slave_available(slave, now) == 0)
+        {
+            /* Offline slave, its blocks wait for the next probe instead of blocking the line */
+            entry->deadline = slave->health.next_probe;
+            continue;
+        }
+
+        state = slave->health.state;
+        start = Hal_getMonotonicTimeInNs();
+        success = read_block(slave, entry->block, &slave->response, acq->ctx);
+        cost = Hal_getMonotonicTimeInNs() - start;
+
+        if(state != SLAVE_STATE_OFFLINE && slave->health.state == SLAVE_STATE_OFFLINE)
+        {
+            invalidate_slave(acq, entry->slave_idx);
+        }
+        else
+        {
+            update_image(acq, entry->slave_idx, entry->block, success);
+        }
+
+        acquisition_lock_image(acq);
+        acq->stats.requests++;
+        if(success == 0)
+        {
+            acq->stats.failed_requests++;
+        }
+        /* Block was not read for more than one whole scan period after it became due */
+        if(now - entry->deadline > entry->block->scan_period)
+        {
+            acq->stats.deadline_misses++;
+        }
+        acquisition_unlock_image(acq);
+
+        acq->window_busy += cost;
+        entry->cost = (entry->cost == 0) ? cost / 1000000.0 : 0.875 * entry->cost + 0.125 * (cost / 1000000.0);
+
+        now = Hal_getMonotonicTimeInMs();
+        entry->deadline += entry->block->scan_period;
+        if(entry->deadline < now)
+        {
+            entry->deadline = now;
+        }
+
+        update_stats_window(acq, now);
+    }
+
+    /* Do not leave callers waiting for commands that were queued while stopping */
+    execute_commands(acq, true);
+
+    #ifdef PRINT_DEBUG
+        fprintf(stdout, "Acquisition stopped on serial port %u\n", acq->port + 1);
+    #endif
+
+    return NULL;
+}
+
+uint8_t acquisition_init(acquisition_port_t* acq, uint8_t port, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx)
+{
+    uint16_t entry = 0;
+    uint16_t max_points = 0;
+
+    acq->port = port;
+    acq->slaves = slaves;
+    acq->num_of_slaves = num_of_slaves;
+    acq->ctx = ctx;
+    acq->num_of_entries = 0;
+    acq->window_start = 0;
+    acq->window_busy = 0;
+    memset(&acq->stats, 0, sizeof(acquisition_stats_t));
+    acq->thread = NULL;
+    acq->running = false;
+    acq->event_handler = NULL;
+    acq->event_handler_parameter = NULL;
+    acq->image_lock = Semaphore_create(1);
+    acq->command_lock = Semaphore_create(1);
+    acq->wakeup = Semaphore_create(0);
+    acq->commands_head = NULL;
+    acq->commands_tail = NULL;
+    acq->write_window = DEFAULT_WRITE_WINDOW;
+    acq->schedule = NULL;
+    acq->image = (slave_image_t*) calloc(num_of_slaves, sizeof(slave_image_t));
+    acq->events = NULL;
+
+    if(acq->image == NULL)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for process image of serial port %u.\n", port + 1);
+        #endif
+        return 0;
+    }
+
+    for(uint8_t i = 0; i < num_of_slaves; i++)
+    {
+        acq->image[i].coils = alloc_points(slaves[i].num_of_coils);
+        acq->image[i].discrete_inputs = alloc_points(slaves[i].num_of_discrete_inputs);
+        acq->image[i].input_regs = alloc_points(slaves[i].num_of_input_registers);
+        acq->image[i].holding_regs = alloc_points(slaves[i].num_of_holding_registers);
+
+        if(acq->image[i].coils == NULL || acq->image[i].discrete_inputs == NULL || acq->image[i].input_regs == NULL ||
+           acq->image[i].holding_regs == NULL)
+        {
+            #ifdef PRINT_DEBUG
+                fprintf(stderr, "Failed to allocate memory for process image of slave: %u.\n", slaves[i].id);
+            #endif
+            return 0;
+        }
+
+        acq->num_of_entries += slaves[i].read_plan.num_of_blocks;
+        for(uint16_t j = 0; j < slaves[i].read_plan.num_of_blocks; j++)
+        {
+            if(slaves[i].read_plan.blocks[j].num_of_points > max_points)
+            {
+                max_points = slaves[i].read_plan.blocks[j].num_of_points;
+            }
+        }
+    }
+
+    /* Changes are collected per block, so the largest block bounds the number of events */
+    acq->events = (acquisition_event_t*) calloc(max_points > 0 ? max_points : 1, sizeof(acquisition_event_t));
+    if(acq->events == NULL)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for events of serial port %u.\n", port + 1);
+        #endif
+        return 0;
+    }
+
+    /* Schedule holds every block of every slave on this serial port */
+    acq->schedule = (scan_entry_t*) calloc(acq->num_of_entries > 0 ? acq->num_of_entries : 1, sizeof(scan_entry_t));
+    if(acq->schedule == NULL)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for schedule of serial port %u.\n", port + 1);
+        #endif
+        return 0;
+    }
+
+    for(uint8_t i = 0; i < num_of_slaves; i++)
+    {
+        for(uint16_t j = 0; j < slaves[i].read_plan.num_of_blocks; j++)
+        {
+            acq->schedule[entry].slave_idx = i;
+            acq->schedule[entry].block = &slaves[i].read_plan.blocks[j];
+            entry++;
+        }
+    }
+
+    return 1;
+}
+
+void acquisition_set_event_handler(acquisition_port_t* acq, acquisition_event_handler handler, void* parameter)
+{
+    acq->event_handler = handler;
+    acq->event_handler_parameter = parameter;
+}
+
+void acquisition_set_write_window(acquisition_port_t* acq, uint32_t write_window)
+{
+    acq->write_window = write_window;
+}
+
+void acquisition_start(acquisition_port_t* acq)
+{
+    acq->running = true;
+    acq->thread = Thread_create(acquisition_thread, (void*) acq, false);
+
+    if(acq->thread != NULL)
+    {
+        Thread_start(acq->thread);
+    }
+}
+
+void acquisition_stop(acquisition_port_t* acq)
+{
+    /* Commands are only accepted while running, see enqueue_command() */
+    Semaphore_wait(acq->command_lock);
+    acq->running = false;
+    Semaphore_post(acq->command_lock);
+    Semaphore_post(acq->wakeup);
+
+    if(acq->thread != NULL)
+    {
+        Thread_destroy(acq->thread);
+        acq->thread = NULL;
+    }
+}
+
+void acquisition_destroy(acquisition_port_t* acq)
+{
+    if(acq->image != NULL)
+    {
+        for(uint8_t i = 0; i < acq->num_of_slaves; i++)
+        {
+            free(acq->image[i].coils);
+            free(acq->image[i].discrete_inputs);
+            free(acq->image[i].input_regs);
+            free(acq->image[i].holding_regs);
+        }
+        free(acq->image);
+        acq->image = NULL;
+    }
+
+    free(acq->schedule);
+    acq->schedule = NULL;
+
+    free(acq->events);
+    acq->events = NULL;
+
+    Semaphore_destroy(acq->image_lock);
+    Semaphore_destroy(acq->command_lock);
+    Semaphore_destroy(acq->wakeup);
+}
+
+void acquisition_get_stats(acquisition_port_t* acq, acquisition_stats_t* stats)
+{
+    acquisition_lock_image(acq);
+    *stats = acq->stats;
+    acquisition_unlock_image(acq);
+}
+
+void acquisition_lock_image(acquisition_port_t* acq)
+{
+    Semaphore_wait(acq->image_lock);
+}
+
+void acquisition_unlock_image(acquisition_port_t* acq)
+{
+    Semaphore_post(acq->image_lock);
+}
+
+/* Takes the modbus address from the configuration, so the worker never has to search for the point */
+static uint8_t resolve_command(acquisition_port_t* acq, acquisition_command_t* cmd, uint8_t type, uint8_t slave_idx, int point, 
+                               uint16_t value)
+{
+    simple_slave_t* slave = NULL;
+
+    if(slave_idx >= acq->num_of_slaves || point < 0)
+    {
+        return 0;
+    }
+    slave = &acq->slaves[slave_idx];
+
+    if(type == ACQUISITION_CMD_WRITE_COIL && point < slave->num_of_coils)
+    {
+        cmd->address = slave->coils_addr[point];
+    }
+    else if(type == ACQUISITION_CMD_WRITE_HOLDING_REGISTER && point < slave->num_of_holding_registers)
+    {
+        cmd->address = slave->holding_registers_addr[point];
+    }
+    else
+    {
+        return 0;
+    }
+
+    cmd->type = type;
+    cmd->slave_idx = slave_idx;
+    cmd->point = (uint16_t) point;
+    cmd->value = value;
+    return 1;
+}
+
+static uint8_t enqueue_command(acquisition_port_t* acq, acquisition_command_t* cmd)
+{
+    cmd->next = NULL;
+    cmd->queued_at = Hal_getMonotonicTimeInNs();
+
+    Semaphore_wait(acq->command_lock);
+    if(acq->running == false)
+    {
+        Semaphore_post(acq->command_lock);
+        return 0;
+    }
+
+    if(acq->commands_tail == NULL)
+    {
+        acq->commands_head = cmd;
+    }
+    else
+    {
+        acq->commands_tail->next = cmd;
+    }
+    acq->commands_tail = cmd;
+    Semaphore_post(acq->command_lock);
+
+    Semaphore_post(acq->wakeup);
+
+    return 1;
+}
+
+uint8_t acquisition_submit_write(acquisition_port_t* acq, uint8_t type, uint8_t slave_idx, uint16_t point, uint16_t value,
+                                 acquisition_command_handler handler, void* parameter)
+{
+    acquisition_command_t* cmd = (acquisition_command_t*) malloc(sizeof(acquisition_command_t));
+
+    if(cmd == NULL)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for command on serial port %u.\n", acq->port + 1);
+        #endif
+        return 0;
+    }
+
+    if(resolve_command(acq, cmd, type, slave_idx, point, value) == 0)
+    {
+        free(cmd);
+        return 0;
+    }
+    cmd->handler = handler;
+    cmd->handler_parameter = parameter;
+
+    if(enqueue_command(acq, cmd) == 0)
+    {
+        free(cmd);
+        return 0;
+    }
+    return 1;
+}
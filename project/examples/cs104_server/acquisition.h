@@ -0,0 +1,273 @@
+/**
+ * @file acquisition.h
+ *
+ * @brief This file contains declarations of types and functions used to
+ * continuously acquire data from modbus slaves into an in-memory process image
+ *
+ * @details One acquisition worker thread is created for every active serial port.
+ * The worker polls all blocks of the slave read plans connected to its port, each block
+ * with its own scan period, and stores received values, together with quality and timestamp,
+ * in the process image. The block with the earliest deadline is always read next.
+ * Control commands are put into a separate queue of the worker which is always served
+ * before polling, so a command waits for one modbus transaction at most after its
+ * coalescing window. Writes to contiguous addresses of one slave are merged into one request.
+ * IEC 104 requests are answered from the process image instead of the modbus line.
+ * Points whose value or quality changed since they were last reported are passed
+ * to the event handler, registers are only reported when the change exceeds their deadband.
+ * Slaves that stopped answering are taken offline and only probed with exponential backoff,
+ * all their points are then reported as invalid and not topical.
+ */
+
+#ifndef _ACQUISITION_H_
+#define _ACQUISITION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "modbus_master.h"
+#include "cs101_information_objects.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+
+#define ACQUISITION_STATS_WINDOW 10000
+
+#define ACQUISITION_CMD_WRITE_COIL             0
+#define ACQUISITION_CMD_WRITE_HOLDING_REGISTER 1
+
+/**
+ * @brief Structure that represents one point of the process image
+ */
+typedef struct point_value
+{
+    uint16_t value;
+    QualityDescriptor quality;
+    uint64_t timestamp;
+    uint16_t reported_value;
+    QualityDescriptor reported_quality;
+} point_value_t;
+
+/**
+ * @brief Structure that holds process image of one slave, arrays are indexed in the
+ * same way as address arrays of the matching simple_slave_t object
+ */
+typedef struct slave_image
+{
+    point_value_t* coils;
+    point_value_t* discrete_inputs;
+    point_value_t* input_regs;
+    point_value_t* holding_regs;
+} slave_image_t;
+
+/**
+ * @brief Structure that represents one block read request in the schedule of a serial port
+ */
+typedef struct scan_entry
+{
+    uint8_t slave_idx;
+    read_block_t* block;
+    uint64_t deadline;
+    double cost;
+} scan_entry_t;
+
+/**
+ * @brief Structure that holds bus statistics of a serial port. Utilisation is the share of time
+ * the line was busy during the last statistics window, demand is the share of time needed to
+ * read all blocks within their scan periods. Demand above 100 % means the port is oversubscribed.
+ */
+typedef struct acquisition_stats
+{
+    uint32_t requests;
+    uint32_t failed_requests;
+    uint32_t deadline_misses;
+    double utilisation;
+    double demand;
+    uint32_t commands;
+    double command_latency_avg;
+    double command_latency_max;
+    uint32_t events;
+} acquisition_stats_t;
+
+/**
+ * @brief Callback invoked from the acquisition worker thread when a submitted command was executed
+ * 
+ * @param parameter User provided parameter
+ * @param result 1 if the command was executed successfully, 0 on failure
+ */
+typedef void (*acquisition_command_handler)(void* parameter, uint8_t result);
+
+/**
+ * @brief Structure that represents one control command waiting in the command queue of a serial port.
+ * Slave, point and modbus address are resolved when the command is queued, point is the index in
+ * the address array of the slave.
+ */
+typedef struct acquisition_command
+{
+    uint8_t type;
+    uint8_t slave_idx;
+    uint16_t point;
+    uint16_t address;
+    uint16_t value;
+    uint64_t queued_at;
+    acquisition_command_handler handler;
+    void* handler_parameter;
+    struct acquisition_command* next;
+} acquisition_command_t;
+
+/**
+ * @brief Structure that represents a change of one point detected by the acquisition worker
+ */
+typedef struct acquisition_event
+{
+    uint16_t point;
+    point_value_t value;
+} acquisition_event_t;
+
+/**
+ * @brief Callback invoked from the acquisition worker thread with all changed points of one block read
+ * 
+ * @param parameter User provided parameter
+ * @param slave Slave object that owns the changed points
+ * @param function Modbus read function code (FC1, FC2, FC3 or FC4) of the changed points
+ * @param events Array of changed points, point index refers to the slave address array
+ * @param num_of_events Number of changed points
+ */
+typedef void (*acquisition_event_handler)(void* parameter, simple_slave_t* slave, uint8_t function, 
+                                          acquisition_event_t* events, uint16_t num_of_events);
+
+/**
+ * @brief Structure that holds state of the acquisition worker of one serial port
+ */
+typedef struct acquisition_port
+{
+    uint8_t port;
+    simple_slave_t* slaves;
+    uint8_t num_of_slaves;
+    modbus_t* ctx;
+    slave_image_t* image;
+    acquisition_event_t* events;
+    scan_entry_t* schedule;
+    uint16_t num_of_entries;
+    acquisition_stats_t stats;
+    uint64_t window_start;
+    uint64_t window_busy;
+    acquisition_event_handler event_handler;
+    void* event_handler_parameter;
+    acquisition_command_t* commands_head;
+    acquisition_command_t* commands_tail;
+    uint32_t write_window;
+    Semaphore image_lock;
+    Semaphore command_lock;
+    Semaphore wakeup;
+    Thread thread;
+    bool running;
+} acquisition_port_t;
+
+/**
+ * @brief Function that initializes acquisition worker state and process image of one serial port.
+ * All points of the process image start with invalid quality until they are read for the first time.
+ *
+ * @param acq Acquisition port object to be initialized
+ * @param port Index of the serial port
+ * @param slaves The array of slaves connected to the serial port
+ * @param num_of_slaves Number of slave objects in the array
+ * @param ctx Initialized modbus context of the serial port
+ *
+ * @returns 1 on success, 0 on failure
+ */
+uint8_t acquisition_init(acquisition_port_t* acq, uint8_t port, simple_slave_t* slaves, uint8_t num_of_slaves, modbus_t* ctx);
+
+/**
+ * @brief Function that sets the handler for changes detected in the process image.
+ * Must be called before the acquisition worker is started.
+ *
+ * @param acq Initialized acquisition port object
+ * @param handler Callback function or NULL to disable change reporting
+ * @param parameter User provided parameter passed to the callback
+ */
+void acquisition_set_event_handler(acquisition_port_t* acq, acquisition_event_handler handler, void* parameter);
+
+/**
+ * @brief Function that sets the write coalescing window of a serial port. A write command waits
+ * in the queue for up to this time so that writes to contiguous addresses of the same slave
+ * arriving in a burst are merged into one FC15 or FC16 request. Commands that are already queued
+ * together are merged even without a window. Must be called before the acquisition worker is started.
+ *
+ * @param acq Initialized acquisition port object
+ * @param write_window Coalescing window in milliseconds, 0 disables waiting
+ */
+void acquisition_set_write_window(acquisition_port_t* acq, uint32_t write_window);
+
+/**
+ * @brief Function that starts the acquisition worker thread of a serial port
+ *
+ * @param acq Initialized acquisition port object
+ */
+void acquisition_start(acquisition_port_t* acq);
+
+/**
+ * @brief Function that stops the acquisition worker thread and waits for it to finish
+ *
+ * @param acq Acquisition port object
+ */
+void acquisition_stop(acquisition_port_t* acq);
+
+/**
+ * @brief Function that releases the memory used by the process image and worker state
+ *
+ * @param acq Acquisition port object
+ */
+void acquisition_destroy(acquisition_port_t* acq);
+
+/**
+ * @brief Function that locks the process image of a serial port. Must be held while reading
+ * the image of any slave on that port.
+ *
+ * @param acq Acquisition port object
+ */
+void acquisition_lock_image(acquisition_port_t* acq);
+
+/**
+ * @brief Function that unlocks the process image of a serial port
+ *
+ * @param acq Acquisition port object
+ */
+void acquisition_unlock_image(acquisition_port_t* acq);
+
+/**
+ * @brief Function that queues a write command without waiting for its result. The handler is called
+ * from the acquisition worker once the command was executed, possibly merged with other writes.
+ * The point is given by indexes, as found in the routing table, so no address lookup is needed.
+ *
+ * @param acq Acquisition port object
+ * @param type Command type, ACQUISITION_CMD_WRITE_COIL or ACQUISITION_CMD_WRITE_HOLDING_REGISTER
+ * @param slave_idx Index of the slave in the slave array of the serial port
+ * @param point Index of the coil or holding register in the address array of the slave
+ * @param value Value to be written
+ * @param handler Callback function invoked with the result
+ * @param parameter User provided parameter passed to the callback
+ *
+ * @returns 1 if the command was queued, 0 on failure (the handler will not be called)
+ */
+uint8_t acquisition_submit_write(acquisition_port_t* acq, uint8_t type, uint8_t slave_idx, uint16_t point, uint16_t value,
+                                 acquisition_command_handler handler, void* parameter);
+
+/**
+ * @brief Function that copies bus statistics of a serial port
+ *
+ * @param acq Acquisition port object
+ * @param stats Structure where statistics are copied
+ */
+void acquisition_get_stats(acquisition_port_t* acq, acquisition_stats_t* stats);
+
+/**
+ * @brief Function that returns the process image array of a slave for the given read function
+ *
+ * @param image Process image of the slave
+ * @param function Modbus read function code (FC1, FC2, FC3 or FC4)
+ *
+ * @returns Process image array or NULL if function code is not valid
+ */
+point_value_t* get_image_points(slave_image_t* image, uint8_t function);
+
+#endif
+/* end of file */
@@ -0,0 +1,203 @@
+/**
+ * @file routing.c
+ *
+ * @brief This file contains implementation of the routing table between IEC 104 addresses and modbus points
+ *
+ * @details To enable debug messages, please define PRINT_DEBUG.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "routing.h"
+
+#define PRINT_DEBUG
+
+static uint32_t get_hash(routing_table_t* table, uint16_t ca, uint32_t ioa)
+{
+    /* Fibonacci hashing of the combined 40 bit key */
+    uint64_t key = ((uint64_t) ca << 24) | (ioa & 0xFFFFFF);
+
+    return (uint32_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (table->size - 1);
+}
+
+static point_route_t* find_entry(routing_table_t* table, uint16_t ca, uint32_t ioa)
+{
+    uint32_t pos = 0;
+
+    if(table->entries == NULL)
+    {
+        return NULL;
+    }
+
+    pos = get_hash(table, ca, ioa);
+    while(table->entries[pos].used)
+    {
+        if(table->entries[pos].ca == ca && table->entries[pos].ioa == ioa)
+        {
+            return &table->entries[pos];
+        }
+        pos = (pos + 1) & (table->size - 1);
+    }
+    return NULL;
+}
+
+static uint8_t add_entry(routing_table_t* table, point_route_t* route)
+{
+    uint32_t pos = get_hash(table, route->ca, route->ioa);
+
+    while(table->entries[pos].used)
+    {
+        if(table->entries[pos].ca == route->ca && table->entries[pos].ioa == route->ioa)
+        {
+            #ifdef PRINT_DEBUG
+                fprintf(stderr, "Failed to build routing table, duplicate address CA: %u, IOA: %u.\n", route->ca, route->ioa);
+            #endif
+            return 0;
+        }
+        pos = (pos + 1) & (table->size - 1);
+    }
+
+    table->entries[pos] = *route;
+    table->entries[pos].used = true;
+    table->num_of_entries++;
+    return 1;
+}
+
+static uint8_t add_points(routing_table_t* table, point_route_t* station, uint8_t function, uint16_t* addresses, uint16_t count)
+{
+    point_route_t route = *station;
+    uint32_t ioa_end = (function == MODBUS_FC_READ_COILS) ? COIL_ADDRESS_END :
+                       (function == MODBUS_FC_READ_DISCRETE_INPUTS) ? DISCRETE_INPUT_ADDRESS_END :
+                       (function == MODBUS_FC_READ_INPUT_REGISTERS) ? INPUT_REGISTER_ADDRESS_END : HOLDING_REGISTER_ADDRESS_END;
+
+    route.function = function;
+    route.type = (function == MODBUS_FC_READ_COILS || function == MODBUS_FC_READ_DISCRETE_INPUTS) ? M_SP_NA_1 : M_ME_NB_1;
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        route.ioa = routing_get_ioa(function, addresses[i]);
+        route.address = addresses[i];
+        route.point = i;
+
+        if(route.ioa > ioa_end)
+        {
+            #ifdef PRINT_DEBUG
+                fprintf(stderr, "Failed to build routing table, address %u of slave %u does not fit its IOA range.\n",
+                    addresses[i], station->ca);
+            #endif
+            return 0;
+        }
+
+        if(add_entry(table, &route) == 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+uint8_t routing_init(routing_table_t* table, simple_slave_t** slaves, uint8_t* num_of_slaves)
+{
+    point_route_t station;
+    simple_slave_t* slave = NULL;
+    uint32_t total = 0;
+
+    table->entries = NULL;
+    table->size = 1;
+    table->num_of_entries = 0;
+
+    for(uint8_t j = 0; j < SERIAL_PORTS_NUM; j++)
+    {
+        for(uint8_t i = 0; slaves[j] != NULL && i < num_of_slaves[j]; i++)
+        {
+            slave = &slaves[j][i];
+            total += 1 + slave->num_of_coils + slave->num_of_discrete_inputs + slave->num_of_input_registers + slave->num_of_holding_registers;
+        }
+    }
+
+    /* Keep the load factor at or below one half so probe sequences stay short */
+    while(table->size < 2 * total)
+    {
+        table->size <<= 1;
+    }
+
+    table->entries = (point_route_t*) calloc(table->size, sizeof(point_route_t));
+    if(table->entries == NULL)
+    {
+        #ifdef PRINT_DEBUG
+            fprintf(stderr, "Failed to allocate memory for routing table.\n");
+        #endif
+        return 0;
+    }
+
+    for(uint8_t j = 0; j < SERIAL_PORTS_NUM; j++)
+    {
+        for(uint8_t i = 0; slaves[j] != NULL && i < num_of_slaves[j]; i++)
+        {
+            slave = &slaves[j][i];
+
+            station.ca = slave->id;
+            station.ioa = ROUTING_STATION_IOA;
+            station.port = j;
+            station.slave_idx = i;
+            station.function = 0;
+            station.address = 0;
+            station.point = 0;
+            station.type = (TypeID) 0;
+
+            if(add_entry(table, &station) == 0 ||
+               add_points(table, &station, MODBUS_FC_READ_COILS, slave->coils_addr, slave->num_of_coils) == 0 ||
+               add_points(table, &station, MODBUS_FC_READ_DISCRETE_INPUTS, slave->discrete_inputs_addr, slave->num_of_discrete_inputs) == 0 ||
+               add_points(table, &station, MODBUS_FC_READ_INPUT_REGISTERS, slave->input_registers_addr, slave->num_of_input_registers) == 0 ||
+               add_points(table, &station, MODBUS_FC_READ_HOLDING_REGISTERS, slave->holding_registers_addr, slave->num_of_holding_registers) == 0)
+            {
+                routing_destroy(table);
+                return 0;
+            }
+        }
+    }
+
+    #ifdef PRINT_DEBUG
+        fprintf(stdout, "Routing table holds %u addresses in %u slots\n", table->num_of_entries, table->size);
+    #endif
+
+    return 1;
+}
+
+void routing_destroy(routing_table_t* table)
+{
+    free(table->entries);
+    table->entries = NULL;
+    table->size = 1;
+    table->num_of_entries = 0;
+}
+
+point_route_t* routing_find_point(routing_table_t* table, uint16_t ca, uint32_t ioa)
+{
+    /* IOA 0 is reserved for station entries */
+    if(ioa == ROUTING_STATION_IOA)
+    {
+        return NULL;
+    }
+    return find_entry(table, ca, ioa);
+}
+
+point_route_t* routing_find_station(routing_table_t* table, uint16_t ca)
+{
+    return find_entry(table, ca, ROUTING_STATION_IOA);
+}
+
+uint32_t routing_get_ioa(uint8_t function, uint16_t address)
+{
+    switch(function)
+    {
+        case MODBUS_FC_READ_COILS:
+            return COIL_ADDRESS_START + address;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            return DISCRETE_INPUT_ADDRESS_START + address;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            return INPUT_REGISTER_ADDRESS_START + address;
+        default:
+            return HOLDING_REGISTER_ADDRESS_START + address;
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file routing.h
+ *
+ * @brief This file contains declarations of types and functions used to
+ * route IEC 104 addresses (common address and information object address) to modbus points
+ *
+ * @details The routing table is built once at startup from the slave configuration.
+ * Every configured point gets one entry and every slave gets one station entry with IOA 0.
+ * Entries are kept in an open addressing hash table with linear probing. The table size is
+ * a power of two, at least twice the number of entries, so a lookup takes constant time
+ * regardless of the number of configured points.
+ */
+
+#ifndef _ROUTING_H_
+#define _ROUTING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "modbus_master.h"
+#include "iec60870_common.h"
+
+/**
+ * IOA ranges of modbus points, IOA = start of the range + modbus address
+ */
+#define COIL_ADDRESS_START                  1
+#define COIL_ADDRESS_END                10000
+
+#define DISCRETE_INPUT_ADDRESS_START    10001
+#define DISCRETE_INPUT_ADDRESS_END      20000
+
+#define INPUT_REGISTER_ADDRESS_START    30001
+#define INPUT_REGISTER_ADDRESS_END      40000
+
+#define HOLDING_REGISTER_ADDRESS_START  40001
+#define HOLDING_REGISTER_ADDRESS_END    50000
+
+#define ROUTING_STATION_IOA 0
+
+/**
+ * @brief Structure that describes where an IEC 104 address is found on the modbus side.
+ * Station entries (IOA 0) only hold port and slave.
+ */
+typedef struct point_route
+{
+    uint16_t ca;
+    uint32_t ioa;
+    uint8_t port;
+    uint8_t slave_idx;
+    uint8_t function;
+    uint16_t address;
+    uint16_t point;
+    TypeID type;
+    bool used;
+} point_route_t;
+
+/**
+ * @brief Structure that holds the routing table
+ */
+typedef struct routing_table
+{
+    point_route_t* entries;
+    uint32_t size;
+    uint32_t num_of_entries;
+} routing_table_t;
+
+/**
+ * @brief Function that builds the routing table from the slave configuration of all serial ports
+ *
+ * @param table Routing table to be initialized
+ * @param slaves The array of slave arrays, one for each serial port
+ * @param num_of_slaves Number of slaves on each serial port
+ *
+ * @returns 1 on success, 0 on failure (memory allocation, address out of its IOA range or duplicate address)
+ */
+uint8_t routing_init(routing_table_t* table, simple_slave_t** slaves, uint8_t* num_of_slaves);
+
+/**
+ * @brief Function that releases the memory used by the routing table
+ *
+ * @param table Routing table
+ */
+void routing_destroy(routing_table_t* table);
+
+/**
+ * @brief Function that finds the modbus point of an IEC 104 address
+ *
+ * @param table Routing table
+ * @param ca Common address of ASDU (slave ID)
+ * @param ioa Information object address
+ *
+ * @returns Point descriptor or NULL if the address is not configured
+ */
+point_route_t* routing_find_point(routing_table_t* table, uint16_t ca, uint32_t ioa);
+
+/**
+ * @brief Function that finds the slave of a common address
+ *
+ * @param table Routing table
+ * @param ca Common address of ASDU (slave ID)
+ *
+ * @returns Station descriptor or NULL if no slave has this common address
+ */
+point_route_t* routing_find_station(routing_table_t* table, uint16_t ca);
+
+/**
+ * @brief Function that returns the information object address of a modbus point
+ *
+ * @param function Modbus read function code (FC1, FC2, FC3 or FC4)
+ * @param address Modbus address of the point
+ *
+ * @returns Information object address
+ */
+uint32_t routing_get_ioa(uint8_t function, uint16_t address);
+
+#endif
+/* end of file */
@@ -6,6 +6,8 @@
 
 #include "cs104_slave.h"
 #include "modbus_master.h"
+#include "acquisition.h"
+#include "routing.h"
 
 #include "hal_thread.h"
 #include "hal_time.h"
@@ -15,21 +17,33 @@
  */
 #define MAX_STATIONS 6
 
-#define COIL_ADDRESS_START                  1
-#define COIL_ADDRESS_END                10000
+#define BUS_STATS_PRINT_INTERVAL        60000
 
-#define DISCRETE_INPUT_ADDRESS_START    10001
-#define DISCRETE_INPUT_ADDRESS_END      20000
+/* Maximum number of elements of an ASDU */
+#define MAX_SEQUENCE_POINTS             127
 
-#define INPUT_REGISTER_ADDRESS_START    30001
-#define INPUT_REGISTER_ADDRESS_END      40000
-
-#define HOLDING_REGISTER_ADDRESS_START  40001
-#define HOLDING_REGISTER_ADDRESS_END    50000
+/* Maximum number of station interrogations that are answered at the same time */
+#define MAX_INTERROGATIONS              8
 
 const char* DEVICE_PATHS[SERIAL_PORTS_NUM] = {"/dev/ttyS1", "/dev/ttyS2", "/dev/ttyS3", "/dev/ttyS4", "/dev/ttyS6", "/dev/ttyS8"};
 const char* CONFIG_FILE_PATH = "config.json";
 
+/**
+ * State of a station interrogation. The response is sent in steps whenever the connection
+ * is ready for more ASDUs, so large process images do not overflow the connection queues.
+ */
+typedef struct interrogation
+{
+    IMasterConnection connection;
+    uint8_t port;
+    uint8_t slave_idx;
+    uint8_t step;
+    uint16_t point;
+    sCS101_StaticASDU request;
+    CS101_ASDU request_asdu;
+    sCS101_ASDUBuilder builder;
+} interrogation_t;
+
 /**
  * Structure used to hold variables needed for modbus communication.
  * Created in order to enable sending the parameter to IEC104 function handlers.
@@ -39,62 +53,258 @@ typedef struct modbus_communication_param
     uint8_t num_of_slaves[SERIAL_PORTS_NUM];
     simple_slave_t** slaves;
     modbus_t* ctx[SERIAL_PORTS_NUM];
+    acquisition_port_t acq[SERIAL_PORTS_NUM];
+    routing_table_t routing;
+    SinglePointInformation singlePoint[SERIAL_PORTS_NUM];
+    MeasuredValueScaled scaledValue[SERIAL_PORTS_NUM];
+    interrogation_t interrogations[MAX_INTERROGATIONS];
+    Semaphore interrogations_lock;
+    struct pending_command* commands;
+    Semaphore commands_lock;
 } modbus_communication_param_t;
 
 static bool running = true;
 
-void sendAllSinglePoints(IMasterConnection connection, interrogation_response_t* resp, simple_slave_t* slave)
+/**
+ * Command waiting in the command queue of a serial port. The confirmation is sent from
+ * the acquisition worker once the write, possibly merged with other writes, was executed.
+ * All pending commands are linked in one list, the commands of a closed connection are
+ * detached by clearing their connection so that no confirmation is sent. The confirmation
+ * is sent without holding commands_lock, sending_to marks the connection during the send.
+ */
+typedef struct pending_command
 {
-    CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
-    CS101_ASDU newAsdu = CS101_ASDU_create(alParams, false, CS101_COT_INTERROGATED_BY_STATION, 0, slave->id, false, false);
+    IMasterConnection connection;
+    IMasterConnection sending_to;
+    CS101_ASDU asdu;
+    int ioa;
+    modbus_communication_param_t* mb_param;
+    struct pending_command* prev;
+    struct pending_command* next;
+} pending_command_t;
 
-    for(uint8_t i = 0; i < resp->num_of_coils; i++)
+/**
+ * Information object of a received single command or set point command
+ */
+typedef struct command_element
+{
+    bool valid;
+    int ioa;
+    int value;
+    struct sCP56Time2a timestamp;
+} command_element_t;
+
+/* Modbus functions in the order they are reported in a station interrogation response */
+static const uint8_t INTERROGATION_FUNCTIONS[] = { MODBUS_FC_READ_COILS, MODBUS_FC_READ_DISCRETE_INPUTS,
+                                                   MODBUS_FC_READ_INPUT_REGISTERS, MODBUS_FC_READ_HOLDING_REGISTERS };
+
+#define NUM_OF_INTERROGATION_FUNCTIONS (sizeof(INTERROGATION_FUNCTIONS) / sizeof(INTERROGATION_FUNCTIONS[0]))
+
+static uint16_t* get_slave_addresses(simple_slave_t* slave, uint8_t function, uint16_t* count)
+{
+    switch(function)
     {
-        InformationObject io = (InformationObject) SinglePointInformation_create(NULL, COIL_ADDRESS_START + slave->coils_addr[i], 
-            resp->coils[i], IEC60870_QUALITY_GOOD);
-        CS101_ASDU_addInformationObject(newAsdu, io);
-        InformationObject_destroy(io);
+        case MODBUS_FC_READ_COILS:
+            *count = slave->num_of_coils;
+            return slave->coils_addr;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            *count = slave->num_of_discrete_inputs;
+            return slave->discrete_inputs_addr;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            *count = slave->num_of_input_registers;
+            return slave->input_registers_addr;
+        default:
+            *count = slave->num_of_holding_registers;
+            return slave->holding_registers_addr;
     }
+}
 
-    for(uint8_t i = 0; i < resp->num_of_discrete_inputs; i++)
+/**
+ * Sends the next points of a station interrogation from the process image. Points with subsequent IOAs
+ * are encoded as sequence ASDUs (SQ=1), the values are written directly into the ASDU payload.
+ * Returns true when the response including ACT_TERM was sent, false when the connection is not
+ * ready for more ASDUs. The interrogation is then continued by the plugin task of the connection.
+ */
+static bool continueInterrogation(modbus_communication_param_t* mb_param, interrogation_t* gi)
+{
+    simple_slave_t* slave = &mb_param->slaves[gi->port][gi->slave_idx];
+    acquisition_port_t* acq = &mb_param->acq[gi->port];
+    bool sp_values[MAX_SEQUENCE_POINTS];
+    int16_t me_values[MAX_SEQUENCE_POINTS];
+    QualityDescriptor qualities[MAX_SEQUENCE_POINTS];
+    bool ready = true;
+
+    acquisition_lock_image(acq);
+
+    while(ready && gi->step < NUM_OF_INTERROGATION_FUNCTIONS)
     {
-        InformationObject io = (InformationObject) SinglePointInformation_create(NULL, DISCRETE_INPUT_ADDRESS_START + slave->discrete_inputs_addr[i], 
-            resp->discrete_inputs[i], IEC60870_QUALITY_GOOD);
-        CS101_ASDU_addInformationObject(newAsdu, io);
-        InformationObject_destroy(io);
+        uint8_t function = INTERROGATION_FUNCTIONS[gi->step];
+        bool is_single_point = (function == MODBUS_FC_READ_COILS || function == MODBUS_FC_READ_DISCRETE_INPUTS);
+        point_value_t* points = get_image_points(&acq->image[gi->slave_idx], function);
+        uint16_t num_of_points;
+        uint16_t* addresses = get_slave_addresses(slave, function, &num_of_points);
+
+        while(ready && gi->point < num_of_points)
+        {
+            uint32_t start_ioa = routing_get_ioa(function, addresses[gi->point]);
+            int count = 0;
+            int added;
+
+            /* Collect the points with subsequent IOAs */
+            while((gi->point + count < num_of_points) && (count < MAX_SEQUENCE_POINTS) &&
+                  (routing_get_ioa(function, addresses[gi->point + count]) == start_ioa + count))
+            {
+                sp_values[count] = (points[gi->point + count].value != 0);
+                me_values[count] = (int16_t) points[gi->point + count].value;
+                qualities[count] = points[gi->point + count].quality;
+                count++;
+            }
+
+            if(is_single_point)
+                added = CS101_ASDUBuilder_addSinglePointSequence(&gi->builder, start_ioa, sp_values, qualities, count);
+            else
+                added = CS101_ASDUBuilder_addScaledValueSequence(&gi->builder, start_ioa, me_values, qualities, count);
+
+            gi->point += added;
+
+            if(added < count)
+                ready = false;
+        }
+
+        if(ready)
+        {
+            gi->step++;
+            gi->point = 0;
+        }
     }
 
-    IMasterConnection_sendASDU(connection, newAsdu);
-    CS101_ASDU_destroy(newAsdu);
-}
+    acquisition_unlock_image(acq);
 
-void sendAllScaledValues(IMasterConnection connection, interrogation_response_t* resp, simple_slave_t* slave)
-{
-    CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
-    CS101_ASDU newAsdu = CS101_ASDU_create(alParams, false, CS101_COT_INTERROGATED_BY_STATION, 0, slave->id, false, false);
+    if(ready == false || CS101_ASDUBuilder_flush(&gi->builder) == false)
+        return false;
+
+    if(IMasterConnection_isReady(gi->connection) == false)
+        return false;
 
-    // Create and send input and holding registers for testing
+    IMasterConnection_sendACT_TERM(gi->connection, gi->request_asdu);
 
-    for(int i = 0; i < resp->num_of_input_registers; i++)
+    return true;
+}
+
+/* Returns the running interrogation of the connection, caller has to hold the interrogations lock */
+static interrogation_t* findInterrogation(modbus_communication_param_t* mb_param, IMasterConnection connection)
+{
+    for(uint8_t i = 0; i < MAX_INTERROGATIONS; i++)
     {
-        InformationObject io = (InformationObject) MeasuredValueScaled_create(NULL, INPUT_REGISTER_ADDRESS_START + slave->input_registers_addr[i], 
-            resp->input_regs[i], IEC60870_QUALITY_GOOD);
-        CS101_ASDU_addInformationObject(newAsdu, io);
-        InformationObject_destroy(io);
+        if(mb_param->interrogations[i].connection == connection)
+            return &mb_param->interrogations[i];
     }
+    return NULL;
+}
+
+static void cancelInterrogation(modbus_communication_param_t* mb_param, IMasterConnection connection)
+{
+    Semaphore_wait(mb_param->interrogations_lock);
+
+    interrogation_t* gi = findInterrogation(mb_param, connection);
 
-    for(int i = 0; i < resp->num_of_holding_registers; i++)
+    if(gi != NULL)
+        gi->connection = NULL;
+
+    Semaphore_post(mb_param->interrogations_lock);
+}
+
+/* Plugin task, called periodically for every connection, continues running interrogations */
+static void interrogationPluginRunTask(void* parameter, IMasterConnection connection)
+{
+    modbus_communication_param_t* mb_param = (modbus_communication_param_t*) (parameter);
+
+    Semaphore_wait(mb_param->interrogations_lock);
+
+    interrogation_t* gi = findInterrogation(mb_param, connection);
+
+    if(gi != NULL && continueInterrogation(mb_param, gi))
+        gi->connection = NULL;
+
+    Semaphore_post(mb_param->interrogations_lock);
+}
+
+static CS101_SlavePlugin_Result interrogationPluginHandleAsdu(void* parameter, IMasterConnection connection, CS101_ASDU asdu)
+{
+    return CS101_PLUGIN_RESULT_NOT_HANDLED;
+}
+
+/* Callback handler that forwards changes detected by the acquisition worker as spontaneous events */
+static void
+acquisitionEventHandler(void* parameter, simple_slave_t* slave, uint8_t function, acquisition_event_t* events, uint16_t num_of_events)
+{
+    CS104_Slave cs104Slave = (CS104_Slave) parameter;
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(cs104Slave);
+    CS101_ASDU newAsdu = CS101_ASDU_create(alParams, false, CS101_COT_SPONTANEOUS, 0, slave->id, false, false);
+    struct sCP56Time2a timestamp;
+    InformationObject io = NULL;
+    uint16_t* addresses = (function == MODBUS_FC_READ_COILS) ? slave->coils_addr : 
+                         (function == MODBUS_FC_READ_DISCRETE_INPUTS) ? slave->discrete_inputs_addr :
+                         (function == MODBUS_FC_READ_INPUT_REGISTERS) ? slave->input_registers_addr : slave->holding_registers_addr;
+
+    for(uint16_t i = 0; i < num_of_events; i++)
     {
-        InformationObject io = (InformationObject) MeasuredValueScaled_create(NULL, HOLDING_REGISTER_ADDRESS_START + slave->holding_registers_addr[i], 
-            resp->holding_regs[i], IEC60870_QUALITY_GOOD);
-        CS101_ASDU_addInformationObject(newAsdu, io);
+        CP56Time2a_createFromMsTimestamp(&timestamp, events[i].value.timestamp);
+
+        if(function == MODBUS_FC_READ_COILS || function == MODBUS_FC_READ_DISCRETE_INPUTS)
+        {
+            io = (InformationObject) SinglePointWithCP56Time2a_create(NULL, routing_get_ioa(function, addresses[events[i].point]), 
+                events[i].value.value, events[i].value.quality, &timestamp);
+        }
+        else
+        {
+            io = (InformationObject) MeasuredValueScaledWithCP56Time2a_create(NULL, routing_get_ioa(function, addresses[events[i].point]), 
+                events[i].value.value, events[i].value.quality, &timestamp);
+        }
+
+        /* Start a new ASDU when the current one is full */
+        if(CS101_ASDU_addInformationObject(newAsdu, io) == false)
+        {
+            CS104_Slave_enqueueASDU(cs104Slave, newAsdu);
+            CS101_ASDU_removeAllElements(newAsdu);
+            CS101_ASDU_addInformationObject(newAsdu, io);
+        }
         InformationObject_destroy(io);
     }
 
-    IMasterConnection_sendASDU(connection, newAsdu);
+    CS104_Slave_enqueueASDU(cs104Slave, newAsdu);
     CS101_ASDU_destroy(newAsdu);
 }
 
+static void
+printBusStats(modbus_communication_param_t* mb_param)
+{
+    static const char* slaveStateNames[] = { "online", "suspect", "offline" };
+    acquisition_stats_t stats;
+    rtt_stats_t rtt;
+
+    for(uint8_t i = 0; i < SERIAL_PORTS_NUM; i++)
+    {
+        if(mb_param->ctx[i] != NULL)
+        {
+            acquisition_get_stats(&mb_param->acq[i], &stats);
+            printf("Serial port %u: utilisation %.1f %%, demand %.1f %%, requests %u, failed %u, deadline misses %u\n", i + 1, 
+                stats.utilisation, stats.demand, stats.requests, stats.failed_requests, stats.deadline_misses);
+            printf("Serial port %u: commands %u, command to ACT_CON latency avg %.1f ms, max %.1f ms\n", i + 1, 
+                stats.commands, stats.command_latency_avg, stats.command_latency_max);
+            printf("Serial port %u: spontaneous events %u\n", i + 1, stats.events);
+
+            for(uint8_t j = 0; j < mb_param->num_of_slaves[i]; j++)
+            {
+                get_rtt_stats(&mb_param->slaves[i][j], &rtt);
+                printf("  Slave %u (%s): rtt avg %.1f ms, p99 %.1f ms, response timeout %.1f ms, requests %u, timeouts %u\n", 
+                    mb_param->slaves[i][j].id, slaveStateNames[mb_param->slaves[i][j].health.state], rtt.ewma / 1000.0, 
+                    get_rtt_percentile(&rtt, RTT_TIMEOUT_PERCENTILE) / 1000.0, rtt.response_timeout / 1000.0, rtt.requests, rtt.timeouts);
+            }
+        }
+    }
+}
+
 void
 sigint_handler(int signalId)
 {
@@ -149,7 +359,7 @@ static bool
 interrogationHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu, uint8_t qoi)
 {
     modbus_communication_param_t* mb_param = (modbus_communication_param_t*) (parameter);
-    interrogation_response_t* resp = NULL;
+    point_route_t* station = NULL;
     uint8_t idx = 0;
     uint8_t slave_idx = 0;
     uint16_t slave_id = 0;
@@ -162,31 +372,48 @@ interrogationHandler(void* parameter, IMasterConnection connection, CS101_ASDU a
         CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
 
         slave_id = (uint16_t) CS101_ASDU_getCA(asdu);
-        idx = slave_id / OFFSET_BY_PORT - 1;
-        if(idx < 0 || idx >= SERIAL_PORTS_NUM)
+        station = routing_find_station(&mb_param->routing, slave_id);
+        if(station == NULL || mb_param->ctx[station->port] == NULL)
         {
-            fprintf(stderr, "Invalid slave ID: %u, index out of bounds.\n", slave_id);
+            fprintf(stderr, "Failed to get interrogation response for slave: %u.\n", slave_id);
             IMasterConnection_sendACT_CON(connection, asdu, true);
-            return true;    
-        }
+            return true;
+        } 
+
+        idx = station->port;
+        slave_idx = station->slave_idx;
+
+        Semaphore_wait(mb_param->interrogations_lock);
+
+        /* A new interrogation replaces the running interrogation of the connection */
+        interrogation_t* gi = findInterrogation(mb_param, connection);
+        if(gi == NULL)
+            gi = findInterrogation(mb_param, NULL);
 
-        resp = interrogate_slave(slave_id, mb_param->slaves[idx], mb_param->num_of_slaves[idx], mb_param->ctx[idx]);
-        if(resp == NULL)
+        if(gi == NULL)
         {
-            fprintf(stderr, "Failed to get interrogation response for slave: %u.\n", slave_id);
+            Semaphore_post(mb_param->interrogations_lock);
+            fprintf(stderr, "Too many running interrogations, rejected interrogation for slave: %u.\n", slave_id);
             IMasterConnection_sendACT_CON(connection, asdu, true);
             return true;
-        } 
+        }
 
         IMasterConnection_sendACT_CON(connection, asdu, false);
 
-        slave_idx = get_slave_idx(slave_id, mb_param->slaves[idx], mb_param->num_of_slaves[idx]);
+        /* Answer from the process image, the modbus line is polled by the acquisition worker.
+           The CS101 specification only allows information objects without timestamp in GI responses */
+        gi->connection = connection;
+        gi->port = idx;
+        gi->slave_idx = slave_idx;
+        gi->step = 0;
+        gi->point = 0;
+        gi->request_asdu = CS101_ASDU_clone(asdu, &gi->request);
+        CS101_ASDUBuilder_initialize(&gi->builder, connection, true, CS101_COT_INTERROGATED_BY_STATION, 0, slave_id);
+
+        if(continueInterrogation(mb_param, gi))
+            gi->connection = NULL;
 
-        /* The CS101 specification only allows information objects without timestamp in GI responses */
-        sendAllSinglePoints(connection, resp, &mb_param->slaves[idx][slave_idx]);
-        sendAllScaledValues(connection, resp, &mb_param->slaves[idx][slave_idx]);
-        
-        IMasterConnection_sendACT_TERM(connection, asdu);
+        Semaphore_post(mb_param->interrogations_lock);
     }
     else 
     {
@@ -202,97 +429,47 @@ readHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu, int
     {
         CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
         int ca = CS101_ASDU_getCA(asdu);
-		CS101_ASDU newAsdu = CS101_ASDU_create(alParams, false, CS101_COT_REQUEST, 0, ca, false, false);
+        sCS101_StaticASDU staticAsdu;
+        CS101_ASDU newAsdu = CS101_ASDU_initializeStatic(&staticAsdu, alParams, false, CS101_COT_REQUEST, 0, ca, false, false);
         InformationObject io = NULL;
-        uint8_t* state_value = NULL;
-        uint16_t* reg_value = NULL;
+        point_value_t value;
         modbus_communication_param_t* mb_param = (modbus_communication_param_t*) (parameter);
-        uint8_t idx = ca / OFFSET_BY_PORT - 1;
-        if(idx < 0 || idx >= SERIAL_PORTS_NUM)
-        {
-            fprintf(stderr, "Invalid slave ID, index out of bounds.\n");
-            ioa = -1; 
-        }
-        /* 
-            IMPORTANT: Might need to further divide address space of MODBUS to fit all of the
-            IEC104 information elements ! 
-        */
-        if(ioa >= COIL_ADDRESS_START && ioa <= COIL_ADDRESS_END)
-        {
-            state_value = read_coil((uint16_t) ca, (uint8_t) (ioa - COIL_ADDRESS_START), mb_param->slaves[idx], mb_param->num_of_slaves[idx], mb_param->ctx[idx]);
-            if(state_value == NULL)
-            {
-                io = NULL;
-                fprintf(stderr, "Failed to read coil status, address: %i.\n", ioa);
-            }
-            else
-            {
-                io = (InformationObject) SinglePointInformation_create(NULL, ioa, *state_value, IEC60870_QUALITY_GOOD);
-                printf("Reading state of the coil, address: %i\n", ioa);
-            }
-        }
-        else if(ioa >= DISCRETE_INPUT_ADDRESS_START && ioa <= DISCRETE_INPUT_ADDRESS_END)
-        {
-            state_value = read_discrete_input((uint16_t) ca, (uint8_t) (ioa- DISCRETE_INPUT_ADDRESS_START), mb_param->slaves[idx], 
-                mb_param->num_of_slaves[idx], mb_param->ctx[idx]);
-            if(state_value == NULL)
-            {
-                io = NULL;
-                fprintf(stderr, "Failed to read discrete input status, address: %i.\n", ioa);
-            }
-            else
-            {
-                io = (InformationObject) SinglePointInformation_create(NULL, ioa, *state_value, IEC60870_QUALITY_GOOD);
-                printf("Reading state of the discrete input, address: %i\n", ioa);
-            }
-        }
-        else if(ioa >= INPUT_REGISTER_ADDRESS_START && ioa <= INPUT_REGISTER_ADDRESS_END)
+        point_route_t* route = routing_find_point(&mb_param->routing, (uint16_t) ca, (uint32_t) ioa);
+
+        if(route != NULL && mb_param->ctx[route->port] == NULL)
         {
-            reg_value = read_input_register((uint16_t) ca, (uint8_t) (ioa - INPUT_REGISTER_ADDRESS_START), mb_param->slaves[idx], 
-                mb_param->num_of_slaves[idx], mb_param->ctx[idx]);
-            if(reg_value == NULL)
-            {
-                io = NULL;
-                fprintf(stderr, "Failed to read input register value, address: %i.\n", ioa);
-            }
-            else
-            {
-                io = (InformationObject) MeasuredValueScaled_create(NULL, ioa, *reg_value, IEC60870_QUALITY_GOOD);
-                printf("Reading value of the input register, address: %i", ioa);
-            }
+            route = NULL;
         }
-        else if(ioa >= HOLDING_REGISTER_ADDRESS_START && ioa <= HOLDING_REGISTER_ADDRESS_END)
+
+        if(route != NULL)
         {
-            reg_value = read_holding_register((uint16_t) ca, (uint8_t) (ioa - HOLDING_REGISTER_ADDRESS_START), mb_param->slaves[idx], 
-                mb_param->num_of_slaves[idx], mb_param->ctx[idx]);
-            if(reg_value == NULL)
+            /* Answer from the process image, the modbus line is polled by the acquisition worker.
+               Information objects of the port are reused while its image lock is held. */
+            acquisition_lock_image(&mb_param->acq[route->port]);
+            value = get_image_points(&mb_param->acq[route->port].image[route->slave_idx], route->function)[route->point];
+
+            if(route->type == M_SP_NA_1)
             {
-                io = NULL;
-                fprintf(stderr, "Failed to read holding register value, address: %i.\n", ioa);
+                io = (InformationObject) SinglePointInformation_create(mb_param->singlePoint[route->port], ioa, value.value, value.quality);
+                printf("Reading state of the coil/discrete input, address: %i\n", ioa);
             }
             else
             {
-                io = (InformationObject) MeasuredValueScaled_create(NULL, ioa, *reg_value, IEC60870_QUALITY_GOOD);
-                printf("Reading value of the holding register, address: %i", ioa);
+                io = (InformationObject) MeasuredValueScaled_create(mb_param->scaledValue[route->port], ioa, value.value, value.quality);
+                printf("Reading value of the input/holding register, address: %i\n", ioa);
             }
-        }
-        else
-        {
-            io = NULL;
-        }
-        if(io != NULL)
-        {
             CS101_ASDU_addInformationObject(newAsdu, io);
-            InformationObject_destroy(io);
+            acquisition_unlock_image(&mb_param->acq[route->port]);
+
             IMasterConnection_sendASDU(connection, newAsdu);
         }
         else
         {
+            fprintf(stderr, "Failed to read value, address: %i.\n", ioa);
             CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
             CS101_ASDU_setNegative(asdu, true);
             IMasterConnection_sendASDU(connection, asdu);
         }
-        CS101_ASDU_destroy(newAsdu);
     }
     else
     {
@@ -303,18 +480,186 @@ readHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu, int
     return true;
 }
 
+/* Must be called with commands_lock held */
+static void unlinkCommand(modbus_communication_param_t* mb_param, pending_command_t* cmd)
+{
+    if(cmd->prev != NULL)
+        cmd->prev->next = cmd->next;
+    else
+        mb_param->commands = cmd->next;
+    if(cmd->next != NULL)
+        cmd->next->prev = cmd->prev;
+}
+
+static void
+commandHandler(void* parameter, uint8_t result)
+{
+    pending_command_t* cmd = (pending_command_t*) parameter;
+    modbus_communication_param_t* mb_param = cmd->mb_param;
+
+    if(result)
+    {
+        printf("IOA: %i command confirmed\n", cmd->ioa);
+        CS101_ASDU_setCOT(cmd->asdu, CS101_COT_ACTIVATION_CON);
+    }
+    else
+    {
+        fprintf(stderr, "Failed to execute command, address: %i.\n", cmd->ioa);
+        CS101_ASDU_setCOT(cmd->asdu, CS101_COT_UNKNOWN_IOA);
+        CS101_ASDU_setNegative(cmd->asdu, true);
+    }
+
+    /* A closing connection waits in cancelCommands() until the send is finished */
+    Semaphore_wait(mb_param->commands_lock);
+    IMasterConnection connection = cmd->connection;
+    cmd->sending_to = connection;
+    Semaphore_post(mb_param->commands_lock);
+
+    if(connection != NULL)
+        IMasterConnection_sendASDU(connection, cmd->asdu);
+
+    Semaphore_wait(mb_param->commands_lock);
+    unlinkCommand(mb_param, cmd);
+    Semaphore_post(mb_param->commands_lock);
+
+    CS101_ASDU_destroy(cmd->asdu);
+    free(cmd);
+}
+
+/* Detach the pending commands of a closed connection, they are still executed but not confirmed */
+static void cancelCommands(modbus_communication_param_t* mb_param, IMasterConnection connection)
+{
+    bool sending = true;
+
+    Semaphore_wait(mb_param->commands_lock);
+
+    for(pending_command_t* cmd = mb_param->commands; cmd != NULL; cmd = cmd->next)
+    {
+        if(cmd->connection == connection)
+            cmd->connection = NULL;
+    }
+
+    /* Wait for confirmations that are being sent, the connection is released after this */
+    while(sending)
+    {
+        sending = false;
+        for(pending_command_t* cmd = mb_param->commands; cmd != NULL; cmd = cmd->next)
+        {
+            if(cmd->sending_to == connection)
+                sending = true;
+        }
+
+        if(sending)
+        {
+            Semaphore_post(mb_param->commands_lock);
+            Thread_sleep(1);
+            Semaphore_wait(mb_param->commands_lock);
+        }
+    }
+
+    Semaphore_post(mb_param->commands_lock);
+}
+
+/* Element handler, copies the single information object of a command ASDU. The object is decoded
+   into a stack instance by CS101_ASDU_forEachElement, so no memory is allocated per command. */
+static bool
+decodeCommandElement(void* parameter, CS101_ASDU asdu, int index, InformationObject io)
+{
+    command_element_t* element = (command_element_t*) parameter;
+
+    element->ioa = InformationObject_getObjectAddress(io);
+
+    switch(CS101_ASDU_getTypeID(asdu))
+    {
+        case C_SC_TA_1:
+            element->timestamp = *SingleCommandWithCP56Time2a_getTimestamp((SingleCommandWithCP56Time2a) io);
+            /* fall through */
+        case C_SC_NA_1:
+            element->value = SingleCommand_getState((SingleCommand) io);
+            break;
+        case C_SE_TB_1:
+            element->timestamp = *SetpointCommandScaledWithCP56Time2a_getTimestamp((SetpointCommandScaledWithCP56Time2a) io);
+            /* fall through */
+        case C_SE_NB_1:
+            element->value = SetpointCommandScaled_getValue((SetpointCommandScaled) io);
+            break;
+        default:
+            return false;
+    }
+    element->valid = true;
+
+    /* Commands carry exactly one information object */
+    return false;
+}
+
+static bool
+getCommandElement(CS101_ASDU asdu, command_element_t* element)
+{
+    element->valid = false;
+    CS101_ASDU_forEachElement(asdu, decodeCommandElement, element);
+
+    return element->valid;
+}
+
+/* Queue the write and return immediately, so that a burst of commands from one connection can be merged */
+static bool
+submitCommand(modbus_communication_param_t* mb_param, IMasterConnection connection, CS101_ASDU asdu, uint8_t type, 
+              point_route_t* route, uint16_t value)
+{
+    pending_command_t* cmd = (pending_command_t*) malloc(sizeof(pending_command_t));
+
+    if(cmd == NULL)
+    {
+        return false;
+    }
+
+    cmd->connection = connection;
+    cmd->sending_to = NULL;
+    cmd->asdu = CS101_ASDU_clone(asdu, NULL);
+    cmd->ioa = (int) route->ioa;
+    cmd->mb_param = mb_param;
+
+    if(cmd->asdu == NULL)
+    {
+        free(cmd);
+        return false;
+    }
+
+    /* Linked before it is queued, the handler may run before this function returns */
+    Semaphore_wait(mb_param->commands_lock);
+    cmd->prev = NULL;
+    cmd->next = mb_param->commands;
+    if(cmd->next != NULL)
+        cmd->next->prev = cmd;
+    mb_param->commands = cmd;
+    Semaphore_post(mb_param->commands_lock);
+
+    if(acquisition_submit_write(&mb_param->acq[route->port], type, route->slave_idx, route->point, value, commandHandler, cmd) == 0)
+    {
+        Semaphore_wait(mb_param->commands_lock);
+        unlinkCommand(mb_param, cmd);
+        Semaphore_post(mb_param->commands_lock);
+
+        CS101_ASDU_destroy(cmd->asdu);
+        free(cmd);
+        return false;
+    }
+    return true;
+}
+
 static bool
 asduHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu)
 {
     modbus_communication_param_t* mb_param = (modbus_communication_param_t*) (parameter);
     uint16_t slave_id = (uint16_t) CS101_ASDU_getCA(asdu);
-    uint8_t idx = slave_id / OFFSET_BY_PORT - 1;
-    uint8_t target_address = 0;
+    point_route_t* station = routing_find_station(&mb_param->routing, slave_id);
+    point_route_t* route = NULL;
+    command_element_t element;
     uint16_t target_value = 0;
 
-    if(idx < 0 || idx >= SERIAL_PORTS_NUM)
+    if(station == NULL || mb_param->ctx[station->port] == NULL)
     {
-        fprintf(stderr, "Invalid slave ID, index out of bounds.\n");
+        fprintf(stderr, "Invalid slave ID: %u.\n", slave_id);
         CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_CA);
         CS101_ASDU_setNegative(asdu, true);
         IMasterConnection_sendASDU(connection, asdu);
@@ -328,32 +673,27 @@ asduHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu)
 
         if(CS101_ASDU_getCOT(asdu) == CS101_COT_ACTIVATION) 
         {
-            InformationObject io = CS101_ASDU_getElement(asdu, 0);
-            if(io) 
+            if(getCommandElement(asdu, &element)) 
             {
-                if(InformationObject_getObjectAddress(io) >= COIL_ADDRESS_START && InformationObject_getObjectAddress(io) <= COIL_ADDRESS_END) 
+                route = routing_find_point(&mb_param->routing, slave_id, (uint32_t) element.ioa);
+                if(route != NULL && route->function == MODBUS_FC_READ_COILS)
                 {
-                    SingleCommand sc = (SingleCommand) io;
-                    target_address = InformationObject_getObjectAddress(io) - COIL_ADDRESS_START;
-                    target_value = SingleCommand_getState(sc) == 0 ? COIL_OFF_VALUE : COIL_ON_VALUE;
-                    if(write_coil(slave_id, target_address, target_value, mb_param->slaves[idx], mb_param->num_of_slaves[idx], mb_param->ctx[idx]))
+                    target_value = element.value == 0 ? COIL_OFF_VALUE : COIL_ON_VALUE;
+                    if(submitCommand(mb_param, connection, asdu, ACQUISITION_CMD_WRITE_COIL, route, target_value))
                     {
-                        printf("IOA: %i switch to %i\n", InformationObject_getObjectAddress(io), SingleCommand_getState(sc));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION_CON);
-                    }
-                    else
-                    {
-                        fprintf(stderr, "Failed to set coil status, address: %i.\n", InformationObject_getObjectAddress(io));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA); 
-                        CS101_ASDU_setNegative(asdu, true);
+                        printf("IOA: %i switch to %i\n", element.ioa, element.value);
+                        /* Confirmation is sent once the command was executed */
+                        return true;
                     }
+                    fprintf(stderr, "Failed to set coil status, address: %i.\n", element.ioa);
+                    CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
+                    CS101_ASDU_setNegative(asdu, true);
                 }
                 else
                 {
                     CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
                     CS101_ASDU_setNegative(asdu, true);
                 }
-                InformationObject_destroy(io);
             }
             else 
             {
@@ -376,34 +716,29 @@ asduHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu)
 
         if(CS101_ASDU_getCOT(asdu) == CS101_COT_ACTIVATION)
         {
-            InformationObject io = CS101_ASDU_getElement(asdu, 0);
-            if(io)
+            if(getCommandElement(asdu, &element))
             {
-                if(InformationObject_getObjectAddress(io) >= COIL_ADDRESS_START && InformationObject_getObjectAddress(io) <= COIL_ADDRESS_END) 
+                route = routing_find_point(&mb_param->routing, slave_id, (uint32_t) element.ioa);
+                if(route != NULL && route->function == MODBUS_FC_READ_COILS)
                 {
-                    SingleCommandWithCP56Time2a sc = (SingleCommandWithCP56Time2a) io;
-                    target_address = InformationObject_getObjectAddress(io) - COIL_ADDRESS_START;
-                    target_value = SingleCommand_getState((SingleCommand) sc) == 0 ? COIL_OFF_VALUE : COIL_ON_VALUE;
-                    if(write_coil(slave_id, target_address, target_value, mb_param->slaves[idx], mb_param->num_of_slaves[idx], mb_param->ctx[idx]))
+                    target_value = element.value == 0 ? COIL_OFF_VALUE : COIL_ON_VALUE;
+                    if(submitCommand(mb_param, connection, asdu, ACQUISITION_CMD_WRITE_COIL, route, target_value))
                     {
-                        printf("IOA: %i switch to %i\n", InformationObject_getObjectAddress(io), SingleCommand_getState((SingleCommand)sc));
+                        printf("IOA: %i switch to %i\n", element.ioa, element.value);
                         printf("Timestamp info: ");
-                        printCP56Time2a(SingleCommandWithCP56Time2a_getTimestamp(sc));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION_CON);
-                    }
-                    else
-                    {
-                        fprintf(stderr, "Failed to set coil status, address: %i.\n", InformationObject_getObjectAddress(io));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA); 
-                        CS101_ASDU_setNegative(asdu, true);
+                        printCP56Time2a(&element.timestamp);
+                        /* Confirmation is sent once the command was executed */
+                        return true;
                     }
+                    fprintf(stderr, "Failed to set coil status, address: %i.\n", element.ioa);
+                    CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
+                    CS101_ASDU_setNegative(asdu, true);
                 }
                 else
                 {
                     CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
                     CS101_ASDU_setNegative(asdu, true);
                 }
-                InformationObject_destroy(io);
             }
             else
             {
@@ -427,33 +762,27 @@ asduHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu)
 
         if(CS101_ASDU_getCOT(asdu) == CS101_COT_ACTIVATION) 
         {
-            InformationObject io = CS101_ASDU_getElement(asdu, 0);
-            if(io) 
+            if(getCommandElement(asdu, &element)) 
             {
-                if(InformationObject_getObjectAddress(io) >= HOLDING_REGISTER_ADDRESS_START && 
-                   InformationObject_getObjectAddress(io) <= HOLDING_REGISTER_ADDRESS_END) 
+                route = routing_find_point(&mb_param->routing, slave_id, (uint32_t) element.ioa);
+                if(route != NULL && route->function == MODBUS_FC_READ_HOLDING_REGISTERS)
                 {
-                    SetpointCommandScaled spsc = (SetpointCommandScaled) io;
-                    target_address = InformationObject_getObjectAddress(io) - HOLDING_REGISTER_ADDRESS_START;
-                    target_value = SetpointCommandScaled_getValue(spsc);
-                    if(write_holding_register(slave_id, target_address, target_value, mb_param->slaves[idx], mb_param->num_of_slaves[idx], mb_param->ctx[idx]))
-                    {
-                        printf("IOA: %i set to %i\n", InformationObject_getObjectAddress(io), SetpointCommandScaled_getValue(spsc));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION_CON);
-                    }
-                    else
+                    target_value = (uint16_t) element.value;
+                    if(submitCommand(mb_param, connection, asdu, ACQUISITION_CMD_WRITE_HOLDING_REGISTER, route, target_value))
                     {
-                        fprintf(stderr, "Failed to set holding register value, address: %i.\n", InformationObject_getObjectAddress(io));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);  
-                        CS101_ASDU_setNegative(asdu, true);
+                        printf("IOA: %i set to %i\n", element.ioa, element.value);
+                        /* Confirmation is sent once the command was executed */
+                        return true;
                     }
+                    fprintf(stderr, "Failed to set holding register value, address: %i.\n", element.ioa);
+                    CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
+                    CS101_ASDU_setNegative(asdu, true);
                 }
                 else
                 {
                     CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
                     CS101_ASDU_setNegative(asdu, true);
                 }
-                InformationObject_destroy(io);
             }
             else 
             {
@@ -476,35 +805,29 @@ asduHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu)
 
         if(CS101_ASDU_getCOT(asdu) == CS101_COT_ACTIVATION) 
         {
-            InformationObject io = CS101_ASDU_getElement(asdu, 0);
-            if(io) 
+            if(getCommandElement(asdu, &element)) 
             {
-                if(InformationObject_getObjectAddress(io) >= HOLDING_REGISTER_ADDRESS_START && 
-                   InformationObject_getObjectAddress(io) <= HOLDING_REGISTER_ADDRESS_END) 
+                route = routing_find_point(&mb_param->routing, slave_id, (uint32_t) element.ioa);
+                if(route != NULL && route->function == MODBUS_FC_READ_HOLDING_REGISTERS)
                 {
-                    SetpointCommandScaledWithCP56Time2a spsc = (SetpointCommandScaledWithCP56Time2a) io;
-                    target_address = InformationObject_getObjectAddress(io) - HOLDING_REGISTER_ADDRESS_START;
-                    target_value = SetpointCommandScaled_getValue((SetpointCommandScaled) spsc);
-                    if(write_holding_register(slave_id, target_address, target_value, mb_param->slaves[idx], mb_param->num_of_slaves[idx], mb_param->ctx[idx]))
+                    target_value = (uint16_t) element.value;
+                    if(submitCommand(mb_param, connection, asdu, ACQUISITION_CMD_WRITE_HOLDING_REGISTER, route, target_value))
                     {
-                        printf("IOA: %i set to %i\n", InformationObject_getObjectAddress(io), SetpointCommandScaled_getValue((SetpointCommandScaled) spsc));
+                        printf("IOA: %i set to %i\n", element.ioa, element.value);
                         printf("Timestamp info: ");
-                        printCP56Time2a(SetpointCommandScaledWithCP56Time2a_getTimestamp(spsc));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION_CON);
-                    }
-                    else
-                    {
-                        fprintf(stderr, "Failed to set holding register value, address: %i.\n", InformationObject_getObjectAddress(io));
-                        CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);  
-                        CS101_ASDU_setNegative(asdu, true);
+                        printCP56Time2a(&element.timestamp);
+                        /* Confirmation is sent once the command was executed */
+                        return true;
                     }
+                    fprintf(stderr, "Failed to set holding register value, address: %i.\n", element.ioa);
+                    CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
+                    CS101_ASDU_setNegative(asdu, true);
                 }
                 else
                 {
                     CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
                     CS101_ASDU_setNegative(asdu, true);
                 }
-                InformationObject_destroy(io);
             }
             else 
             {
@@ -546,17 +869,26 @@ connectionRequestHandler(void* parameter, const char* ipAddress)
 static void
 connectionEventHandler(void* parameter, IMasterConnection con, CS104_PeerConnectionEvent event)
 {
+    modbus_communication_param_t* mb_param = (modbus_communication_param_t*) (parameter);
+
     if (event == CS104_CON_EVENT_CONNECTION_OPENED) {
         printf("Connection opened (%p)\n", con);
     }
     else if (event == CS104_CON_EVENT_CONNECTION_CLOSED) {
         printf("Connection closed (%p)\n", con);
+
+        cancelInterrogation(mb_param, con);
+
+        /* Pending confirmations refer to the connection, which is released after this event */
+        cancelCommands(mb_param, con);
     }
     else if (event == CS104_CON_EVENT_ACTIVATED) {
         printf("Connection activated (%p)\n", con);
     }
     else if (event == CS104_CON_EVENT_DEACTIVATED) {
         printf("Connection deactivated (%p)\n", con);
+
+        cancelInterrogation(mb_param, con);
     }
 }
 
@@ -569,6 +901,9 @@ main(int argc, char** argv)
     int rc = 0;
     serial_configuration_t cfg[SERIAL_PORTS_NUM];
     modbus_communication_param_t mb_comm_param;
+    CS104_Slave slave = NULL;
+    /* Ports below this index have an acquisition worker that has to be destroyed on exit */
+    uint8_t num_of_acq_ports = 0;
 
     /* Add Ctrl-C handler */
     signal(SIGINT, sigint_handler);
@@ -581,6 +916,13 @@ main(int argc, char** argv)
         return 0;
     }
 
+    if(routing_init(&mb_comm_param.routing, mb_comm_param.slaves, mb_comm_param.num_of_slaves) == 0)
+    {
+        fprintf(stderr, "Unable to build routing table from slave configuration.\n");
+        free_slaves(mb_comm_param.slaves, mb_comm_param.num_of_slaves);
+        return 0;
+    }
+
     for(uint8_t i = 0; i < SERIAL_PORTS_NUM; i++)
     {
         if(mb_comm_param.slaves[i] != NULL)
@@ -595,9 +937,37 @@ main(int argc, char** argv)
 
     print_slaves(mb_comm_param.slaves, mb_comm_param.num_of_slaves);
 
+    for(uint8_t i = 0; i < MAX_INTERROGATIONS; i++)
+    {
+        mb_comm_param.interrogations[i].connection = NULL;
+    }
+    mb_comm_param.interrogations_lock = Semaphore_create(1);
+    mb_comm_param.commands = NULL;
+    mb_comm_param.commands_lock = Semaphore_create(1);
+
+    /* Prepare one acquisition worker per active serial port */
+    for(uint8_t i = 0; i < SERIAL_PORTS_NUM; i++)
+    {
+        if(mb_comm_param.ctx[i] != NULL)
+        {
+            /* Allocated once, GI and read responses of the port reuse them */
+            mb_comm_param.singlePoint[i] = SinglePointInformation_create(NULL, 0, false, IEC60870_QUALITY_GOOD);
+            mb_comm_param.scaledValue[i] = MeasuredValueScaled_create(NULL, 0, 0, IEC60870_QUALITY_GOOD);
+
+            /* A partially initialized worker is released by acquisition_destroy() as well */
+            num_of_acq_ports = i + 1;
+            if(acquisition_init(&mb_comm_param.acq[i], i, mb_comm_param.slaves[i], mb_comm_param.num_of_slaves[i], mb_comm_param.ctx[i]) == 0)
+            {
+                fprintf(stderr, "Unable to initialize acquisition on serial port %u.\n", i + 1);
+                goto exit_program;
+            }
+            acquisition_set_write_window(&mb_comm_param.acq[i], cfg[i].write_window);
+        }
+    }
+
     /* create a new slave/server instance with default connection parameters and
      * default message queue size */
-    CS104_Slave slave = CS104_Slave_create(10, 10);
+    slave = CS104_Slave_create(10, 10);
 
     CS104_Slave_setLocalAddress(slave, "0.0.0.0");
 
@@ -634,11 +1004,15 @@ main(int argc, char** argv)
     CS104_Slave_setConnectionRequestHandler(slave, connectionRequestHandler, NULL);
 
     /* set handler to track connection events (optional) */
-    CS104_Slave_setConnectionEventHandler(slave, connectionEventHandler, NULL);
+    CS104_Slave_setConnectionEventHandler(slave, connectionEventHandler, (void*) (&mb_comm_param));
 
     /* set handler for read command */
     CS104_Slave_setReadHandler(slave, readHandler, (void*) (&mb_comm_param));
 
+    /* Plugin task continues station interrogations when the connection is ready for more ASDUs */
+    struct sCS101_SlavePlugin interrogationPlugin = { interrogationPluginHandleAsdu, interrogationPluginRunTask, (void*) (&mb_comm_param) };
+    CS104_Slave_addPlugin(slave, &interrogationPlugin);
+
     /* uncomment to log messages */
     //CS104_Slave_setRawMessageHandler(slave, rawMessageHandler, NULL);
 
@@ -649,35 +1023,58 @@ main(int argc, char** argv)
         goto exit_program;
     }
 
-    int16_t scaledValue = 0;
-
-    while (running) {
-        /*
-        Thread_sleep(10000);
-
-        CS101_ASDU newAsdu = CS101_ASDU_create(alParams, false, CS101_COT_PERIODIC, 0, 1, false, false);
+    /* Start acquisition, changed points are enqueued as spontaneous events */
+    for(uint8_t i = 0; i < SERIAL_PORTS_NUM; i++)
+    {
+        if(mb_comm_param.ctx[i] != NULL)
+        {
+            acquisition_set_event_handler(&mb_comm_param.acq[i], acquisitionEventHandler, (void*) slave);
+            acquisition_start(&mb_comm_param.acq[i]);
+        }
+    }
 
-        InformationObject io = (InformationObject) MeasuredValueScaled_create(NULL, INPUT_REGISTER_ADDRESS_START, scaledValue, IEC60870_QUALITY_GOOD);
+    uint64_t lastStatsPrint = Hal_getMonotonicTimeInMs();
 
-        scaledValue++;
+    while (running) {
+        Thread_sleep(100);
 
-        CS101_ASDU_addInformationObject(newAsdu, io);
+        if(Hal_getMonotonicTimeInMs() - lastStatsPrint >= BUS_STATS_PRINT_INTERVAL)
+        {
+            printBusStats(&mb_comm_param);
+            lastStatsPrint = Hal_getMonotonicTimeInMs();
+        }
+    }
 
-        InformationObject_destroy(io);
+exit_program:
+    /* Stop acquisition before the server since workers enqueue events to it */
+    for(uint8_t i = 0; i < num_of_acq_ports; i++)
+    {
+        if(mb_comm_param.ctx[i] != NULL)
+        {
+            acquisition_stop(&mb_comm_param.acq[i]);
+            acquisition_destroy(&mb_comm_param.acq[i]);
+        }
+    }
 
-        /* Add ASDU to slave event queue */
-        /*
-        CS104_Slave_enqueueASDU(slave, newAsdu);
+    if(slave != NULL)
+    {
+        CS104_Slave_stop(slave);
 
-        CS101_ASDU_destroy(newAsdu);
-        */
+        CS104_Slave_destroy(slave);
     }
 
-    CS104_Slave_stop(slave);
-
-exit_program:
-    CS104_Slave_destroy(slave);
+    for(uint8_t i = 0; i < num_of_acq_ports; i++)
+    {
+        if(mb_comm_param.ctx[i] != NULL)
+        {
+            SinglePointInformation_destroy(mb_comm_param.singlePoint[i]);
+            MeasuredValueScaled_destroy(mb_comm_param.scaledValue[i]);
+        }
+    }
+    Semaphore_destroy(mb_comm_param.interrogations_lock);
+    Semaphore_destroy(mb_comm_param.commands_lock);
     free_modbus(mb_comm_param.ctx);
+    routing_destroy(&mb_comm_param.routing);
     free_slaves(mb_comm_param.slaves, mb_comm_param.num_of_slaves);
 
     Thread_sleep(500);
@@ -0,0 +1,255 @@
+/*
+ * Checks that a CS 104 slave does not lose or reorder I messages when the socket accepts only a
+ * part of the buffered messages. The send buffer of the slave sockets and the receive buffer of
+ * the client are reduced, the k-window is large and the client reads slowly, so that the socket
+ * writes of the slave return early. The client checks the IOAs of the received ASDUs and the send sequence numbers
+ * (a sequence number mismatch closes the connection).
+ *
+ * Linux only: the sockets are found by their local and peer ports.
+ *
+ * Usage: cs104_small_sndbuf_check [number of ASDUs] [tcp port]
+ *
+ * Returns 0 when all ASDUs were received in order.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "cs104_slave.h"
+#include "cs104_connection.h"
+
+#include "hal_thread.h"
+#include "hal_time.h"
+
+#define DEFAULT_NUMBER_OF_ASDUS 5000
+#define DEFAULT_PORT 2417
+
+/* send buffer size of the slave sockets and receive buffer size of the client socket */
+#define SLAVE_SNDBUF_SIZE 4096
+#define CLIENT_RCVBUF_SIZE 4096
+
+/* k-window of the slave and w of the client */
+#define SLAVE_K 2000
+#define CLIENT_W 500
+
+/* the client sleeps CLIENT_SLOWDOWN_TIME ms after every CLIENT_SLOWDOWN ASDUs */
+#define CLIENT_SLOWDOWN 200
+#define CLIENT_SLOWDOWN_TIME 10
+
+/* Longest time to wait for all ASDUs */
+#define RECEIVE_TIMEOUT 60000
+
+static Semaphore receivedLock;
+static int received = 0;
+static int outOfOrder = 0;
+static bool connectionClosed = false;
+
+static bool
+asduReceivedHandler(void* parameter, int address, CS101_ASDU asdu)
+{
+    InformationObject io = CS101_ASDU_getElement(asdu, 0);
+
+    if (io) {
+        Semaphore_wait(receivedLock);
+
+        /* the IOAs are enqueued in ascending order starting with 1 */
+        if (InformationObject_getObjectAddress(io) != received + 1)
+            outOfOrder++;
+
+        received++;
+
+        bool slowDown = ((received % CLIENT_SLOWDOWN) == 0);
+
+        Semaphore_post(receivedLock);
+
+        InformationObject_destroy(io);
+
+        /* let the receive buffer of the client and the send buffer of the slave run full */
+        if (slowDown)
+            Thread_sleep(CLIENT_SLOWDOWN_TIME);
+    }
+
+    return true;
+}
+
+static void
+connectionHandler(void* parameter, CS104_Connection connection, CS104_ConnectionEvent event)
+{
+    if (event == CS104_CONNECTION_CLOSED) {
+        Semaphore_wait(receivedLock);
+        connectionClosed = true;
+        Semaphore_post(receivedLock);
+    }
+}
+
+static bool
+isDone(int numberOfAsdus)
+{
+    bool done;
+
+    Semaphore_wait(receivedLock);
+    done = connectionClosed || (received >= numberOfAsdus);
+    Semaphore_post(receivedLock);
+
+    return done;
+}
+
+static int
+getPort(int fd, bool peer)
+{
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+
+    int result;
+
+    if (peer)
+        result = getpeername(fd, (struct sockaddr*) &addr, &addrLen);
+    else
+        result = getsockname(fd, (struct sockaddr*) &addr, &addrLen);
+
+    if ((result != 0) || (addr.sin_family != AF_INET))
+        return -1;
+
+    return ntohs(addr.sin_port);
+}
+
+/*
+ * Reduce the send buffer of the slave sockets (local port is the server port) and the receive
+ * buffer of the client socket (peer port is the server port).
+ *
+ * \return the number of changed sockets
+ */
+static int
+reduceSocketBuffers(int port)
+{
+    int sndBufSize = SLAVE_SNDBUF_SIZE;
+    int rcvBufSize = CLIENT_RCVBUF_SIZE;
+    int count = 0;
+    int fd;
+
+    for (fd = 0; fd < 1024; fd++) {
+        if (getPort(fd, false) == port) {
+            if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndBufSize, sizeof(sndBufSize)) == 0)
+                count++;
+        }
+        else if (getPort(fd, true) == port) {
+            if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvBufSize, sizeof(rcvBufSize)) == 0)
+                count++;
+        }
+    }
+
+    return count;
+}
+
+static void
+enqueueAsdus(CS104_Slave slave, int numberOfAsdus)
+{
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(slave);
+    int i;
+
+    for (i = 0; i < numberOfAsdus; i++) {
+        CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_SPONTANEOUS, 0, 1, false, false);
+
+        MeasuredValueScaled io = MeasuredValueScaled_create(NULL, i + 1, i, IEC60870_QUALITY_GOOD);
+
+        CS101_ASDU_addInformationObject(asdu, (InformationObject) io);
+        MeasuredValueScaled_destroy(io);
+
+        CS104_Slave_enqueueASDU(slave, asdu);
+
+        CS101_ASDU_destroy(asdu);
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    int numberOfAsdus = DEFAULT_NUMBER_OF_ASDUS;
+    int port = DEFAULT_PORT;
+    bool success = false;
+
+    if (argc > 1)
+        numberOfAsdus = atoi(argv[1]);
+
+    if (argc > 2)
+        port = atoi(argv[2]);
+
+    if (numberOfAsdus < 1) {
+        printf("Usage: %s [number of ASDUs] [tcp port]\n", argv[0]);
+        return 1;
+    }
+
+    receivedLock = Semaphore_create(1);
+
+    CS104_Slave slave = CS104_Slave_create(numberOfAsdus, 100);
+
+    CS104_Slave_setLocalAddress(slave, "127.0.0.1");
+    CS104_Slave_setLocalPort(slave, port);
+    CS104_Slave_setServerMode(slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
+
+    CS104_APCIParameters apciParams = CS104_Slave_getConnectionParameters(slave);
+    apciParams->k = SLAVE_K;
+
+    CS104_Slave_start(slave);
+
+    if (CS104_Slave_isRunning(slave) == false) {
+        printf("Starting server failed!\n");
+        goto exit_program;
+    }
+
+    enqueueAsdus(slave, numberOfAsdus);
+
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", port);
+
+    struct sCS104_APCIParameters clientParams = *CS104_Connection_getAPCIParameters(con);
+    clientParams.k = SLAVE_K;
+    clientParams.w = CLIENT_W;
+    CS104_Connection_setAPCIParameters(con, &clientParams);
+
+    CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
+    CS104_Connection_setConnectionHandler(con, connectionHandler, NULL);
+
+    if (CS104_Connection_connect(con)) {
+
+        while (CS104_Slave_getOpenConnections(slave) < 1)
+            Thread_sleep(1);
+
+        /* listening socket, slave connection socket and client socket */
+        if (reduceSocketBuffers(port) < 3)
+            printf("Failed to reduce the socket buffers!\n");
+
+        uint64_t start = Hal_getMonotonicTimeInMs();
+
+        CS104_Connection_sendStartDT(con);
+
+        while ((isDone(numberOfAsdus) == false) && (Hal_getMonotonicTimeInMs() - start < RECEIVE_TIMEOUT))
+            Thread_sleep(1);
+    }
+    else
+        printf("Connecting to server failed!\n");
+
+    Semaphore_wait(receivedLock);
+
+    printf("%i of %i ASDUs received, %i out of order%s\n", received, numberOfAsdus, outOfOrder,
+            connectionClosed ? ", connection closed" : "");
+
+    success = (received == numberOfAsdus) && (outOfOrder == 0);
+
+    Semaphore_post(receivedLock);
+
+    CS104_Connection_destroy(con);
+
+exit_program:
+    CS104_Slave_stop(slave);
+    CS104_Slave_destroy(slave);
+
+    Semaphore_destroy(receivedLock);
+
+    printf("%s\n", success ? "PASSED" : "FAILED");
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/*
+ * Measures how many ASDUs per second a CS 104 slave sends to a client over the loopback interface.
+ * For every round the ASDUs are added to the low-priority queue of the slave before the client
+ * sends STARTDT, then the time until the client received the last ASDU is measured. The result
+ * depends on how many waiting ASDUs the slave connection sends with one socket write.
+ *
+ * Usage: cs104_throughput_benchmark [ASDUs per round] [rounds] [tcp port]
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cs104_slave.h"
+#include "cs104_connection.h"
+
+#include "hal_thread.h"
+#include "hal_time.h"
+
+#define DEFAULT_NUMBER_OF_ASDUS 20000
+#define DEFAULT_ROUNDS 5
+#define DEFAULT_PORT 2415
+
+/* Longest time to wait for all ASDUs of a round */
+#define ROUND_TIMEOUT 30000
+
+static Semaphore receivedLock;
+static int received = 0;
+static uint64_t lastReceivedTime = 0;
+
+static bool
+asduReceivedHandler(void* parameter, int address, CS101_ASDU asdu)
+{
+    Semaphore_wait(receivedLock);
+    received++;
+    lastReceivedTime = Hal_getMonotonicTimeInNs();
+    Semaphore_post(receivedLock);
+
+    return true;
+}
+
+static int
+getReceived(uint64_t* lastTime)
+{
+    int value;
+
+    Semaphore_wait(receivedLock);
+    value = received;
+
+    if (lastTime)
+        *lastTime = lastReceivedTime;
+
+    Semaphore_post(receivedLock);
+
+    return value;
+}
+
+static void
+enqueueAsdus(CS104_Slave slave, int numberOfAsdus)
+{
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(slave);
+    int i;
+
+    for (i = 0; i < numberOfAsdus; i++) {
+        CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_SPONTANEOUS, 0, 1, false, false);
+
+        MeasuredValueScaled io = MeasuredValueScaled_create(NULL, 100 + (i % 1000), i, IEC60870_QUALITY_GOOD);
+
+        CS101_ASDU_addInformationObject(asdu, (InformationObject) io);
+        MeasuredValueScaled_destroy(io);
+
+        CS104_Slave_enqueueASDU(slave, asdu);
+
+        CS101_ASDU_destroy(asdu);
+    }
+}
+
+/* returns the ASDU rate or -1 when not all ASDUs were received */
+static double
+runRound(CS104_Slave slave, int port, int numberOfAsdus)
+{
+    double rate = -1;
+    uint64_t start;
+    uint64_t lastTime;
+
+    enqueueAsdus(slave, numberOfAsdus);
+
+    Semaphore_wait(receivedLock);
+    received = 0;
+    Semaphore_post(receivedLock);
+
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", port);
+
+    CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
+
+    if (CS104_Connection_connect(con)) {
+
+        start = Hal_getMonotonicTimeInNs();
+
+        CS104_Connection_sendStartDT(con);
+
+        while ((getReceived(NULL) < numberOfAsdus) && (Hal_getMonotonicTimeInNs() - start < ROUND_TIMEOUT * 1000000ULL))
+            Thread_sleep(1);
+
+        if (getReceived(&lastTime) >= numberOfAsdus)
+            rate = (double) numberOfAsdus * 1e9 / (double) (lastTime - start);
+    }
+    else
+        printf("Connecting to server failed!\n");
+
+    CS104_Connection_destroy(con);
+
+    /* wait until the slave released the connection */
+    while (CS104_Slave_getOpenConnections(slave) > 0)
+        Thread_sleep(1);
+
+    return rate;
+}
+
+int
+main(int argc, char** argv)
+{
+    int numberOfAsdus = DEFAULT_NUMBER_OF_ASDUS;
+    int rounds = DEFAULT_ROUNDS;
+    int port = DEFAULT_PORT;
+    double sum = 0;
+    int completed = 0;
+    int i;
+
+    if (argc > 1)
+        numberOfAsdus = atoi(argv[1]);
+
+    if (argc > 2)
+        rounds = atoi(argv[2]);
+
+    if (argc > 3)
+        port = atoi(argv[3]);
+
+    if ((numberOfAsdus < 1) || (rounds < 1)) {
+        printf("Usage: %s [ASDUs per round] [rounds] [tcp port]\n", argv[0]);
+        return 1;
+    }
+
+    receivedLock = Semaphore_create(1);
+
+    CS104_Slave slave = CS104_Slave_create(numberOfAsdus, 100);
+
+    CS104_Slave_setLocalAddress(slave, "127.0.0.1");
+    CS104_Slave_setLocalPort(slave, port);
+    CS104_Slave_setServerMode(slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
+
+    CS104_Slave_start(slave);
+
+    if (CS104_Slave_isRunning(slave) == false) {
+        printf("Starting server failed!\n");
+        CS104_Slave_destroy(slave);
+        Semaphore_destroy(receivedLock);
+        return 1;
+    }
+
+    for (i = 0; i < rounds; i++) {
+        double rate = runRound(slave, port, numberOfAsdus);
+
+        if (rate < 0) {
+            printf("round %i: not all ASDUs received\n", i + 1);
+        }
+        else {
+            printf("round %i: %i ASDUs, %.0f ASDUs/s\n", i + 1, numberOfAsdus, rate);
+            sum += rate;
+            completed++;
+        }
+    }
+
+    if (completed > 0)
+        printf("average: %.0f ASDUs/s\n", sum / completed);
+
+    CS104_Slave_stop(slave);
+    CS104_Slave_destroy(slave);
+
+    Semaphore_destroy(receivedLock);
+
+    return 0;
+}
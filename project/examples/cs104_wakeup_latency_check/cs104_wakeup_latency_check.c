@@ -0,0 +1,195 @@
+/*
+ * Checks that an enqueued ASDU wakes up an idle connection of a CS 104 slave. The client confirms
+ * every I message (w = 1) so that the low-priority queue runs empty and the connection waits for
+ * new ASDUs. Then single ASDUs are enqueued and the time until the client receives them is
+ * measured. Without the wakeup the ASDUs are only sent after the socket timeout of the connection
+ * (100 ms).
+ *
+ * Usage: cs104_wakeup_latency_check [number of ASDUs] [tcp port]
+ *
+ * Returns 0 when all ASDUs were received in order and within MAX_LATENCY.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cs104_slave.h"
+#include "cs104_connection.h"
+
+#include "hal_thread.h"
+#include "hal_time.h"
+
+#define DEFAULT_NUMBER_OF_ASDUS 100
+#define DEFAULT_PORT 2418
+
+/* time to let the connection become idle before the next ASDU is enqueued (ms) */
+#define IDLE_TIME 20
+
+/* longest accepted time from enqueue until reception (ms) */
+#define MAX_LATENCY 20.0
+
+/* Longest time to wait for a single ASDU */
+#define RECEIVE_TIMEOUT 1000
+
+static Semaphore receivedLock;
+static int received = 0;
+static int outOfOrder = 0;
+static nsSinceEpoch receivedTime = 0;
+
+static bool
+asduReceivedHandler(void* parameter, int address, CS101_ASDU asdu)
+{
+    InformationObject io = CS101_ASDU_getElement(asdu, 0);
+
+    if (io) {
+        Semaphore_wait(receivedLock);
+
+        /* the IOAs are enqueued in ascending order starting with 1 */
+        if (InformationObject_getObjectAddress(io) != received + 1)
+            outOfOrder++;
+
+        received++;
+        receivedTime = Hal_getMonotonicTimeInNs();
+
+        Semaphore_post(receivedLock);
+
+        InformationObject_destroy(io);
+    }
+
+    return true;
+}
+
+static int
+getReceived(nsSinceEpoch* time)
+{
+    int value;
+
+    Semaphore_wait(receivedLock);
+    value = received;
+
+    if (time)
+        *time = receivedTime;
+
+    Semaphore_post(receivedLock);
+
+    return value;
+}
+
+static void
+enqueueAsdu(CS104_Slave slave, int ioa)
+{
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(slave);
+
+    CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_SPONTANEOUS, 0, 1, false, false);
+
+    MeasuredValueScaled io = MeasuredValueScaled_create(NULL, ioa, ioa, IEC60870_QUALITY_GOOD);
+
+    CS101_ASDU_addInformationObject(asdu, (InformationObject) io);
+    MeasuredValueScaled_destroy(io);
+
+    CS104_Slave_enqueueASDU(slave, asdu);
+
+    CS101_ASDU_destroy(asdu);
+}
+
+int
+main(int argc, char** argv)
+{
+    int numberOfAsdus = DEFAULT_NUMBER_OF_ASDUS;
+    int port = DEFAULT_PORT;
+    bool success = false;
+
+    if (argc > 1)
+        numberOfAsdus = atoi(argv[1]);
+
+    if (argc > 2)
+        port = atoi(argv[2]);
+
+    if (numberOfAsdus < 1) {
+        printf("Usage: %s [number of ASDUs] [tcp port]\n", argv[0]);
+        return 1;
+    }
+
+    receivedLock = Semaphore_create(1);
+
+    CS104_Slave slave = CS104_Slave_create(100, 100);
+
+    CS104_Slave_setLocalAddress(slave, "127.0.0.1");
+    CS104_Slave_setLocalPort(slave, port);
+    CS104_Slave_setServerMode(slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
+
+    CS104_Slave_start(slave);
+
+    if (CS104_Slave_isRunning(slave) == false) {
+        printf("Starting server failed!\n");
+        goto exit_program;
+    }
+
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", port);
+
+    /* confirm every I message so that the queue of the slave runs empty */
+    struct sCS104_APCIParameters clientParams = *CS104_Connection_getAPCIParameters(con);
+    clientParams.w = 1;
+    CS104_Connection_setAPCIParameters(con, &clientParams);
+
+    CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
+
+    double maxLatency = 0.0;
+    double sumLatency = 0.0;
+    int i = 0;
+
+    if (CS104_Connection_connect(con)) {
+
+        CS104_Connection_sendStartDT(con);
+
+        for (i = 0; i < numberOfAsdus; i++) {
+            Thread_sleep(IDLE_TIME);
+
+            nsSinceEpoch enqueueTime = Hal_getMonotonicTimeInNs();
+            nsSinceEpoch time = 0;
+
+            enqueueAsdu(slave, i + 1);
+
+            while ((getReceived(&time) <= i) && (Hal_getMonotonicTimeInNs() - enqueueTime < (nsSinceEpoch) RECEIVE_TIMEOUT * 1000000))
+                Thread_sleep(1);
+
+            if (getReceived(NULL) <= i) {
+                printf("ASDU %i not received!\n", i + 1);
+                break;
+            }
+
+            double latency = (time - enqueueTime) / 1000000.0;
+
+            sumLatency += latency;
+
+            if (latency > maxLatency)
+                maxLatency = latency;
+        }
+    }
+    else
+        printf("Connecting to server failed!\n");
+
+    CS104_Connection_destroy(con);
+
+    Semaphore_wait(receivedLock);
+
+    printf("%i of %i ASDUs received, %i out of order\n", received, numberOfAsdus, outOfOrder);
+
+    if (i > 0)
+        printf("enqueue to reception latency avg %.2f ms, max %.2f ms (limit %.0f ms)\n", sumLatency / i, maxLatency, MAX_LATENCY);
+
+    success = (received == numberOfAsdus) && (outOfOrder == 0) && (maxLatency <= MAX_LATENCY);
+
+    Semaphore_post(receivedLock);
+
+exit_program:
+    CS104_Slave_stop(slave);
+    CS104_Slave_destroy(slave);
+
+    Semaphore_destroy(receivedLock);
+
+    printf("%s\n", success ? "PASSED" : "FAILED");
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+/*
+ *  file_provider_linux.c
+ *
+ *  Copyright 2013-2021 Michael Zillgith
+ *
+ *  This file is part of Platform Abstraction Layer (libpal)
+ *  for libiec61850, libmms, and lib60870.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hal_filesystem.h"
+#include "lib_memory.h"
+
+struct sMemoryMappedFile {
+    int fd;
+    int size;
+    uint8_t* buffer;
+};
+
+MemoryMappedFile
+MemoryMappedFile_open(const char* filename, int size)
+{
+    int fd = open(filename, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+
+    if (fd == -1)
+        return NULL;
+
+    /* extending the file fills it with zeros */
+    if (ftruncate(fd, size) == -1) {
+        close(fd);
+        return NULL;
+    }
+
+    void* buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (buffer == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    MemoryMappedFile self = (MemoryMappedFile) GLOBAL_MALLOC(sizeof(struct sMemoryMappedFile));
+
+    if (self) {
+        self->fd = fd;
+        self->size = size;
+        self->buffer = (uint8_t*) buffer;
+    }
+    else {
+        munmap(buffer, size);
+        close(fd);
+    }
+
+    return self;
+}
+
+uint8_t*
+MemoryMappedFile_getBuffer(MemoryMappedFile self)
+{
+    return self->buffer;
+}
+
+bool
+MemoryMappedFile_sync(MemoryMappedFile self)
+{
+    return (msync(self->buffer, self->size, MS_SYNC) == 0);
+}
+
+void
+MemoryMappedFile_close(MemoryMappedFile self)
+{
+    if (self) {
+        munmap(self->buffer, self->size);
+        close(self->fd);
+
+        GLOBAL_FREEMEM(self);
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ *  file_provider_win32.c
+ *
+ *  Copyright 2013-2021 Michael Zillgith
+ *
+ *  This file is part of Platform Abstraction Layer (libpal)
+ *  for libiec61850, libmms, and lib60870.
+ */
+
+#include <windows.h>
+
+#include "hal_filesystem.h"
+#include "lib_memory.h"
+
+struct sMemoryMappedFile {
+    HANDLE file;
+    HANDLE mapping;
+    int size;
+    uint8_t* buffer;
+};
+
+MemoryMappedFile
+MemoryMappedFile_open(const char* filename, int size)
+{
+    HANDLE file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    /* mapping resizes the file - extended parts are filled with zeros */
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, (DWORD) size, NULL);
+
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    void* buffer = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T) size);
+
+    if (buffer == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return NULL;
+    }
+
+    MemoryMappedFile self = (MemoryMappedFile) GLOBAL_MALLOC(sizeof(struct sMemoryMappedFile));
+
+    if (self) {
+        self->file = file;
+        self->mapping = mapping;
+        self->size = size;
+        self->buffer = (uint8_t*) buffer;
+    }
+    else {
+        UnmapViewOfFile(buffer);
+        CloseHandle(mapping);
+        CloseHandle(file);
+    }
+
+    return self;
+}
+
+uint8_t*
+MemoryMappedFile_getBuffer(MemoryMappedFile self)
+{
+    return self->buffer;
+}
+
+bool
+MemoryMappedFile_sync(MemoryMappedFile self)
+{
+    if (FlushViewOfFile(self->buffer, (SIZE_T) self->size) == 0)
+        return false;
+
+    return (FlushFileBuffers(self->file) != 0);
+}
+
+void
+MemoryMappedFile_close(MemoryMappedFile self)
+{
+    if (self) {
+        UnmapViewOfFile(self->buffer);
+        CloseHandle(self->mapping);
+        CloseHandle(self->file);
+
+        GLOBAL_FREEMEM(self);
+    }
+}
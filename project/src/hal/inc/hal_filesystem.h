@@ -0,0 +1,86 @@
+/*
+ *  hal_filesystem.h
+ *
+ *  File system abstraction layer
+ *
+ *  Copyright 2013-2021 Michael Zillgith
+ *
+ *  This file is part of Platform Abstraction Layer (libpal)
+ *  for libiec61850, libmms, and lib60870.
+ */
+
+#ifndef FILESYSTEM_HAL_H_
+#define FILESYSTEM_HAL_H_
+
+#include "hal_base.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \file hal_filesystem.h
+ * \brief Abstraction layer for file system access
+ */
+
+/*! \addtogroup hal
+   *
+   *  @{
+   */
+
+/**
+ * @defgroup HAL_FILESYSTEM File system API
+ *
+ * @{
+ */
+
+/** Opaque reference of a memory mapped file */
+typedef struct sMemoryMappedFile* MemoryMappedFile;
+
+/**
+ * \brief Open a file and map it into memory
+ *
+ * The file is created when it does not exist and resized to the given size. Content of an
+ * existing file is preserved up to the given size, new files are filled with zeros.
+ * Changes of the mapped memory are written to the file by the operating system and
+ * at the latest when \ref MemoryMappedFile_sync is called.
+ *
+ * \param filename name of the file
+ * \param size size of the file and the mapped memory in bytes
+ *
+ * \return the new MemoryMappedFile instance or NULL when the file cannot be opened or mapped
+ */
+PAL_API MemoryMappedFile
+MemoryMappedFile_open(const char* filename, int size);
+
+/**
+ * \brief Get the mapped memory of the file
+ */
+PAL_API uint8_t*
+MemoryMappedFile_getBuffer(MemoryMappedFile self);
+
+/**
+ * \brief Write all changes of the mapped memory to the storage device
+ *
+ * The function blocks until the data is written.
+ *
+ * \return true on success, false otherwise
+ */
+PAL_API bool
+MemoryMappedFile_sync(MemoryMappedFile self);
+
+/**
+ * \brief Unmap and close the file
+ */
+PAL_API void
+MemoryMappedFile_close(MemoryMappedFile self);
+
+/*! @} */
+
+/*! @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILESYSTEM_HAL_H_ */
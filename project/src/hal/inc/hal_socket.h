@@ -83,6 +83,15 @@ Handleset_reset(HandleSet self);
 PAL_API void
 Handleset_addSocket(HandleSet self, const Socket sock);
 
+/**
+ * \brief add a socket to an existing handle set that is ready when data can be written to it
+ *
+ * \param self the HandleSet instance
+ * \param sock the socket to add
+ */
+PAL_API void
+Handleset_addSocketForWriting(HandleSet self, const Socket sock);
+
 /**
  * \brief remove a socket from an existing handle set
  */
@@ -115,6 +124,114 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs);
 PAL_API void
 Handleset_destroy(HandleSet self);
 
+/** Opaque reference for a socket poller (persistent set of sockets waited for by an event loop) */
+typedef struct sSocketPoller* SocketPoller;
+
+/**
+ * \brief Create a new socket poller
+ *
+ * In contrast to the HandleSet the sockets stay registered until they are removed, so the
+ * cost of a wait does not depend on the number of idle sockets (epoll on Linux).
+ *
+ * \param maxSockets maximum number of sockets that can be added to the poller
+ *
+ * \return new SocketPoller instance or NULL on failure
+ */
+PAL_API SocketPoller
+SocketPoller_create(int maxSockets);
+
+/**
+ * \brief Add a socket to the poller
+ *
+ * A server socket or a \ref WakeupEvent can be added by casting it to Socket.
+ *
+ * \param self the SocketPoller instance
+ * \param sock the socket to add
+ * \param data user data returned by \ref SocketPoller_getReady when the socket is ready
+ *
+ * \return true on success, false when the socket cannot be added
+ */
+PAL_API bool
+SocketPoller_addSocket(SocketPoller self, const Socket sock, void* data);
+
+/**
+ * \brief Remove a socket from the poller. Has to be called before the socket is destroyed.
+ *
+ * \param self the SocketPoller instance
+ * \param sock the socket to remove
+ */
+PAL_API void
+SocketPoller_removeSocket(SocketPoller self, const Socket sock);
+
+/**
+ * \brief Wait until at least one of the sockets is ready for reading
+ *
+ * \param self the SocketPoller instance
+ * \param timeoutMs maximum time to wait in milliseconds (ms)
+ *
+ * \return number of ready sockets, 0 on timeout or -1 on error
+ */
+PAL_API int
+SocketPoller_wait(SocketPoller self, unsigned int timeoutMs);
+
+/**
+ * \brief Get the user data of a ready socket after \ref SocketPoller_wait
+ *
+ * \param self the SocketPoller instance
+ * \param index index of the ready socket (0 .. return value of SocketPoller_wait - 1)
+ *
+ * \return the user data given when the socket was added
+ */
+PAL_API void*
+SocketPoller_getReady(SocketPoller self, int index);
+
+/**
+ * \brief destroy the SocketPoller instance. The sockets are not closed.
+ *
+ * \param self the SocketPoller instance to destroy
+ */
+PAL_API void
+SocketPoller_destroy(SocketPoller self);
+
+/** Opaque reference for a wakeup event that can be waited for together with sockets */
+typedef struct sWakeupEvent* WakeupEvent;
+
+/**
+ * \brief Create a new wakeup event
+ *
+ * A wakeup event is used to interrupt a thread that waits for sockets with a HandleSet or a
+ * SocketPoller (eventfd on Linux, pipe on BSD). It is added to the HandleSet or SocketPoller
+ * by casting it to Socket and becomes ready when it is signaled.
+ *
+ * \return new WakeupEvent instance or NULL when not supported by the platform
+ */
+PAL_API WakeupEvent
+WakeupEvent_create(void);
+
+/**
+ * \brief Signal the wakeup event. The event stays ready until it is reset.
+ *
+ * \param self the WakeupEvent instance
+ */
+PAL_API void
+WakeupEvent_signal(WakeupEvent self);
+
+/**
+ * \brief Reset the wakeup event after it was signaled
+ *
+ * \param self the WakeupEvent instance
+ */
+PAL_API void
+WakeupEvent_reset(WakeupEvent self);
+
+/**
+ * \brief destroy the WakeupEvent instance
+ *
+ * \param self the WakeupEvent instance to destroy
+ */
+PAL_API void
+WakeupEvent_destroy(WakeupEvent self);
+
 /**
  * \brief Create a new TcpServerSocket instance
  *
@@ -128,6 +245,21 @@ Handleset_destroy(HandleSet self);
 PAL_API ServerSocket
 TcpServerSocket_create(const char* address, int port);
 
+/**
+ * \brief Create a new TcpServerSocket instance that can be bound to the same address and port
+ * as other server sockets (SO_REUSEPORT). The incoming connections are distributed between
+ * the server sockets by the operating system.
+ *
+ * Implementation of this function is OPTIONAL.
+ *
+ * \param address ip address or hostname to listen on
+ * \param port the TCP port to listen on
+ *
+ * \return the newly create TcpServerSocket instance or NULL when not supported
+ */
+PAL_API ServerSocket
+TcpServerSocket_createReusePort(const char* address, int port);
+
 /**
  * \brief Create an IPv4 UDP socket instance
  *
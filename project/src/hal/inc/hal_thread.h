@@ -80,6 +80,18 @@ Thread_destroy(Thread thread);
 PAL_API void
 Thread_sleep(int millies);
 
+/**
+ * \brief Bind the calling thread to a CPU core
+ *
+ * Implementation of this function is OPTIONAL.
+ *
+ * \param cpu index of the CPU core
+ *
+ * \return true on success, false when not supported or the CPU core is not available
+ */
+PAL_API bool
+Thread_setCpuAffinity(int cpu);
+
 PAL_API Semaphore
 Semaphore_create(int initialValue);
 
@@ -87,6 +99,10 @@ Semaphore_create(int initialValue);
 PAL_API void
 Semaphore_wait(Semaphore self);
 
+/* Wait until semaphore value is greater than zero or timeoutInMs elapsed. Decrease the semaphore value and return true on success, return false on timeout. */
+PAL_API bool
+Semaphore_waitTimeout(Semaphore self, int timeoutInMs);
+
 PAL_API void
 Semaphore_post(Semaphore self);
 
@@ -46,6 +46,59 @@ Memory_realloc(void *ptr, size_t size);
 PAL_API void
 Memory_free(void* memb);
 
+/**
+ * \brief Interface of an allocator used by Memory_malloc, Memory_calloc, Memory_realloc and Memory_free
+ */
+typedef struct sMemoryAllocator* MemoryAllocator;
+
+struct sMemoryAllocator {
+    void* (*allocate) (void* parameter, size_t size);
+    void* (*reallocate) (void* parameter, void* ptr, size_t size);
+    void (*release) (void* parameter, void* ptr);
+    void* parameter;
+};
+
+/**
+ * \brief Install the allocator used by all memory functions (default: malloc/realloc/free of the C library)
+ *
+ * NOTE: Has to be called before any other function of the library is used. Memory has to be released
+ * by the allocator that allocated it.
+ *
+ * \param allocator the allocator or NULL to use the C library functions
+ */
+PAL_API void
+Memory_installAllocator(MemoryAllocator allocator);
+
+typedef struct {
+    uint64_t poolAllocations;   /* allocations served by a size class pool */
+    uint64_t systemAllocations; /* allocations too large for the pools (passed to malloc) */
+    uint64_t slabAllocations;   /* slabs allocated to extend the pools */
+    uint64_t liveObjects;       /* allocated and not yet released objects */
+    uint64_t peakLiveObjects;
+    uint64_t liveBytes;         /* size of the live objects (rounded to the size class) */
+    uint64_t peakLiveBytes;
+    uint64_t reservedBytes;     /* memory of all slabs */
+} MemoryPoolStatistics;
+
+/**
+ * \brief Get the pool allocator (to be installed with \ref Memory_installAllocator)
+ *
+ * Small objects (up to 512 bytes, e.g. information objects and ASDUs) are taken from size class pools.
+ * The pools are filled with slabs of 16 KiB that are never returned to the system, so memory is reused
+ * for objects of the same size class and the heap does not fragment. Each thread keeps a small cache of
+ * free objects per size class to avoid locking. Larger objects are passed to malloc.
+ *
+ * \return the pool allocator or NULL when not supported on the platform (requires POSIX threads and GCC/clang builtins)
+ */
+PAL_API MemoryAllocator
+MemoryPool_getAllocator(void);
+
+/**
+ * \brief Get the usage counters of the pool allocator
+ */
+PAL_API void
+MemoryPool_getStatistics(MemoryPoolStatistics* statistics);
+
 #ifdef __cplusplus
 }
 #endif
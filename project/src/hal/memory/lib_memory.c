@@ -8,11 +8,19 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "lib_memory.h"
 
+#if ((defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32))
+#define MEMORY_POOL_SUPPORTED 1
+#include <pthread.h>
+#endif
+
 static MemoryExceptionHandler exceptionHandler = NULL;
 static void* exceptionHandlerParameter = NULL;
 
+static MemoryAllocator allocator = NULL;
+
 static void
 noMemoryAvailableHandler(void)
 {
@@ -27,10 +35,21 @@ Memory_installExceptionHandler(MemoryExceptionHandler handler, void* parameter)
     exceptionHandlerParameter = parameter;
 }
 
+void
+Memory_installAllocator(MemoryAllocator newAllocator)
+{
+    allocator = newAllocator;
+}
+
 void*
 Memory_malloc(size_t size)
 {
-    void* memory = malloc(size);
+    void* memory;
+
+    if (allocator)
+        memory = allocator->allocate(allocator->parameter, size);
+    else
+        memory = malloc(size);
 
     if (memory == NULL)
         noMemoryAvailableHandler();
@@ -41,7 +60,19 @@ Memory_malloc(size_t size)
 void*
 Memory_calloc(size_t nmemb, size_t size)
 {
-    void* memory = calloc(nmemb, size);
+    void* memory;
+
+    if (allocator) {
+        if ((size != 0) && (nmemb > ((size_t) -1) / size))
+            memory = NULL;
+        else
+            memory = allocator->allocate(allocator->parameter, nmemb * size);
+
+        if (memory)
+            memset(memory, 0, nmemb * size);
+    }
+    else
+        memory = calloc(nmemb, size);
 
     if (memory == NULL)
         noMemoryAvailableHandler();
@@ -52,7 +83,12 @@ Memory_calloc(size_t nmemb, size_t size)
 void *
 Memory_realloc(void *ptr, size_t size)
 {
-    void* memory = realloc(ptr, size);
+    void* memory;
+
+    if (allocator)
+        memory = allocator->reallocate(allocator->parameter, ptr, size);
+    else
+        memory = realloc(ptr, size);
 
     if (memory == NULL)
         noMemoryAvailableHandler();
@@ -63,6 +99,460 @@ Memory_realloc(void *ptr, size_t size)
 void
 Memory_free(void* memb)
 {
-    free(memb);
+    if (allocator)
+        allocator->release(allocator->parameter, memb);
+    else
+        free(memb);
+}
+
+/********************************************************************************
+ * Pool allocator
+ *
+ * Each object is preceded by a header with its size class. Free objects of a
+ * size class are linked by a pointer stored in the object itself.
+ *******************************************************************************/
+
+#if (MEMORY_POOL_SUPPORTED == 1)
+
+#define POOL_NUMBER_OF_CLASSES 10
+#define POOL_LARGE_OBJECT 0xff
+
+/* keeps the alignment of malloc */
+#define POOL_HEADER_SIZE 16
+
+#define POOL_SLAB_SIZE 16384
+
+/* maximum number of free objects per size class in the cache of a thread */
+#define POOL_THREAD_CACHE_SIZE 32
+
+/* number of allocations and releases of a thread before its counters are added to the statistics */
+#define POOL_STATISTICS_INTERVAL 64
+
+static const size_t poolClassSizes[POOL_NUMBER_OF_CLASSES] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+
+/* size class for each multiple of 16 bytes (index = (size + 15) / 16) */
+static const uint8_t poolSizeClassTable[] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+    8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9
+};
+
+typedef struct {
+    uint32_t sizeClass;
+    size_t size; /* only for large objects */
+} PoolObjectHeader;
+
+typedef struct sPoolFreeObject* PoolFreeObject;
+
+struct sPoolFreeObject {
+    PoolFreeObject next;
+};
+
+typedef struct {
+    char lock;
+    PoolFreeObject freeList;
+} PoolClass;
+
+typedef struct {
+    uint64_t poolAllocations;
+    uint64_t systemAllocations;
+    int64_t liveObjects;
+    int64_t liveBytes;
+    int operations;
+} PoolThreadStatistics;
+
+typedef struct {
+    PoolFreeObject freeList[POOL_NUMBER_OF_CLASSES];
+    int count[POOL_NUMBER_OF_CLASSES];
+    PoolThreadStatistics statistics; /* not yet added to the global statistics */
+    bool isRegistered;
+    bool isReleased; /* the thread is terminating -> the cache is no longer used */
+} PoolThreadCache;
+
+static PoolClass poolClasses[POOL_NUMBER_OF_CLASSES];
+
+static __thread PoolThreadCache threadCache;
+
+static pthread_key_t threadCacheKey;
+static pthread_once_t threadCacheKeyOnce = PTHREAD_ONCE_INIT;
+
+static MemoryPoolStatistics poolStatistics;
+
+static void
+PoolClass_lock(PoolClass* self)
+{
+    while (__atomic_test_and_set(&(self->lock), __ATOMIC_ACQUIRE))
+        ;
+}
+
+static void
+PoolClass_unlock(PoolClass* self)
+{
+    __atomic_clear(&(self->lock), __ATOMIC_RELEASE);
+}
+
+static void
+updatePeak(uint64_t* peak, uint64_t value)
+{
+    uint64_t currentPeak = __atomic_load_n(peak, __ATOMIC_RELAXED);
+
+    while ((value > currentPeak) &&
+            (__atomic_compare_exchange_n(peak, &currentPeak, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false))
+        ;
+}
+
+static void
+PoolThreadStatistics_publish(PoolThreadStatistics* self)
+{
+    __atomic_fetch_add(&(poolStatistics.poolAllocations), self->poolAllocations, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&(poolStatistics.systemAllocations), self->systemAllocations, __ATOMIC_RELAXED);
+
+    updatePeak(&(poolStatistics.peakLiveObjects),
+            __atomic_add_fetch(&(poolStatistics.liveObjects), (uint64_t) self->liveObjects, __ATOMIC_RELAXED));
+    updatePeak(&(poolStatistics.peakLiveBytes),
+            __atomic_add_fetch(&(poolStatistics.liveBytes), (uint64_t) self->liveBytes, __ATOMIC_RELAXED));
+
+    memset(self, 0, sizeof(PoolThreadStatistics));
+}
+
+static int
+getSizeClass(size_t size)
+{
+    if (size > poolClassSizes[POOL_NUMBER_OF_CLASSES - 1])
+        return POOL_LARGE_OBJECT;
+
+    return poolSizeClassTable[(size + 15) / 16];
+}
+
+static PoolObjectHeader*
+getHeader(void* ptr)
+{
+    return (PoolObjectHeader*) ((uint8_t*) ptr - POOL_HEADER_SIZE);
+}
+
+/* split a new slab into objects of the size class (caller has to hold the class lock) */
+static bool
+PoolClass_addSlab(PoolClass* self, int sizeClass)
+{
+    size_t objectSize = POOL_HEADER_SIZE + poolClassSizes[sizeClass];
+
+    uint8_t* slab = (uint8_t*) malloc(POOL_SLAB_SIZE);
+
+    if (slab == NULL)
+        return false;
+
+    size_t offset;
+
+    for (offset = 0; offset + objectSize <= POOL_SLAB_SIZE; offset += objectSize) {
+        PoolObjectHeader* header = (PoolObjectHeader*) (slab + offset);
+
+        header->sizeClass = (uint32_t) sizeClass;
+
+        PoolFreeObject object = (PoolFreeObject) (slab + offset + POOL_HEADER_SIZE);
+
+        object->next = self->freeList;
+        self->freeList = object;
+    }
+
+    __atomic_fetch_add(&(poolStatistics.slabAllocations), 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&(poolStatistics.reservedBytes), POOL_SLAB_SIZE, __ATOMIC_RELAXED);
+
+    return true;
+}
+
+/* move up to maxCount free objects of the size class to the list and return the number of objects */
+static int
+PoolClass_take(PoolClass* self, int sizeClass, PoolFreeObject* list, int maxCount)
+{
+    int count = 0;
+
+    PoolClass_lock(self);
+
+    if (self->freeList == NULL)
+        PoolClass_addSlab(self, sizeClass);
+
+    while ((count < maxCount) && self->freeList) {
+        PoolFreeObject object = self->freeList;
+
+        self->freeList = object->next;
+
+        object->next = *list;
+        *list = object;
+
+        count++;
+    }
+
+    PoolClass_unlock(self);
+
+    return count;
+}
+
+/* move up to count objects from the list back to the size class */
+static void
+PoolClass_give(PoolClass* self, PoolFreeObject* list, int count)
+{
+    PoolClass_lock(self);
+
+    while ((count > 0) && *list) {
+        PoolFreeObject object = *list;
+
+        *list = object->next;
+
+        object->next = self->freeList;
+        self->freeList = object;
+
+        count--;
+    }
+
+    PoolClass_unlock(self);
+}
+
+static void
+releaseThreadCache(void* parameter)
+{
+    int sizeClass;
+
+    (void)parameter;
+
+    for (sizeClass = 0; sizeClass < POOL_NUMBER_OF_CLASSES; sizeClass++) {
+        PoolClass_give(&(poolClasses[sizeClass]), &(threadCache.freeList[sizeClass]), threadCache.count[sizeClass]);
+        threadCache.count[sizeClass] = 0;
+    }
+
+    PoolThreadStatistics_publish(&(threadCache.statistics));
+
+    threadCache.isReleased = true;
+}
+
+static void
+createThreadCacheKey(void)
+{
+    pthread_key_create(&threadCacheKey, releaseThreadCache);
+}
+
+/* return the cache of the calling thread or NULL when the thread is terminating */
+static PoolThreadCache*
+getThreadCache(void)
+{
+    PoolThreadCache* cache = &threadCache;
+
+    if (cache->isReleased)
+        return NULL;
+
+    if (cache->isRegistered == false) {
+        /* the key is only used to release the cache when the thread terminates */
+        pthread_once(&threadCacheKeyOnce, createThreadCacheKey);
+        pthread_setspecific(threadCacheKey, cache);
+
+        cache->isRegistered = true;
+    }
+
+    return cache;
+}
+
+/* the counters are collected per thread to avoid contention on the global counters */
+static void
+countOperation(PoolThreadCache* cache, bool isSystemAllocation, int objects, size_t size)
+{
+    PoolThreadStatistics directStatistics;
+    PoolThreadStatistics* statistics = &directStatistics;
+
+    if (cache)
+        statistics = &(cache->statistics);
+    else
+        memset(&directStatistics, 0, sizeof(PoolThreadStatistics));
+
+    if (objects > 0) {
+        if (isSystemAllocation)
+            statistics->systemAllocations++;
+        else
+            statistics->poolAllocations++;
+
+        statistics->liveBytes += (int64_t) size;
+    }
+    else
+        statistics->liveBytes -= (int64_t) size;
+
+    statistics->liveObjects += objects;
+
+    statistics->operations++;
+
+    if ((cache == NULL) || (statistics->operations >= POOL_STATISTICS_INTERVAL))
+        PoolThreadStatistics_publish(statistics);
+}
+
+static void*
+MemoryPool_allocate(void* parameter, size_t size)
+{
+    int sizeClass = getSizeClass(size);
+
+    (void)parameter;
+
+    PoolThreadCache* cache = getThreadCache();
+
+    if (sizeClass == POOL_LARGE_OBJECT) {
+        PoolObjectHeader* header = (PoolObjectHeader*) malloc(POOL_HEADER_SIZE + size);
+
+        if (header == NULL)
+            return NULL;
+
+        header->sizeClass = POOL_LARGE_OBJECT;
+        header->size = size;
+
+        countOperation(cache, true, 1, size);
+
+        return (uint8_t*) header + POOL_HEADER_SIZE;
+    }
+
+    PoolFreeObject object = NULL;
+
+    if (cache) {
+        if (cache->count[sizeClass] == 0)
+            cache->count[sizeClass] = PoolClass_take(&(poolClasses[sizeClass]), sizeClass, &(cache->freeList[sizeClass]), POOL_THREAD_CACHE_SIZE / 2);
+
+        if (cache->count[sizeClass] > 0) {
+            object = cache->freeList[sizeClass];
+            cache->freeList[sizeClass] = object->next;
+            cache->count[sizeClass]--;
+        }
+    }
+    else
+        PoolClass_take(&(poolClasses[sizeClass]), sizeClass, &object, 1);
+
+    if (object)
+        countOperation(cache, false, 1, poolClassSizes[sizeClass]);
+
+    return object;
+}
+
+static void
+MemoryPool_release(void* parameter, void* ptr)
+{
+    (void)parameter;
+
+    if (ptr == NULL)
+        return;
+
+    PoolObjectHeader* header = getHeader(ptr);
+
+    PoolThreadCache* cache = getThreadCache();
+
+    if (header->sizeClass == POOL_LARGE_OBJECT) {
+        countOperation(cache, true, -1, header->size);
+
+        free(header);
+
+        return;
+    }
+
+    int sizeClass = (int) header->sizeClass;
+
+    countOperation(cache, false, -1, poolClassSizes[sizeClass]);
+
+    PoolFreeObject object = (PoolFreeObject) ptr;
+
+    if (cache) {
+        object->next = cache->freeList[sizeClass];
+        cache->freeList[sizeClass] = object;
+        cache->count[sizeClass]++;
+
+        /* keep half of the cache for the next allocations */
+        if (cache->count[sizeClass] > POOL_THREAD_CACHE_SIZE) {
+            PoolClass_give(&(poolClasses[sizeClass]), &(cache->freeList[sizeClass]), POOL_THREAD_CACHE_SIZE / 2);
+            cache->count[sizeClass] -= POOL_THREAD_CACHE_SIZE / 2;
+        }
+    }
+    else {
+        object->next = NULL;
+        PoolClass_give(&(poolClasses[sizeClass]), &object, 1);
+    }
+}
+
+static void*
+MemoryPool_reallocate(void* parameter, void* ptr, size_t size)
+{
+    if (ptr == NULL)
+        return MemoryPool_allocate(parameter, size);
+
+    PoolObjectHeader* header = getHeader(ptr);
+
+    if (header->sizeClass == POOL_LARGE_OBJECT) {
+
+        if (getSizeClass(size) == POOL_LARGE_OBJECT) {
+            size_t oldSize = header->size;
+
+            PoolObjectHeader* newHeader = (PoolObjectHeader*) realloc(header, POOL_HEADER_SIZE + size);
+
+            if (newHeader == NULL)
+                return NULL;
+
+            newHeader->size = size;
+
+            countOperation(getThreadCache(), true, -1, oldSize);
+            countOperation(getThreadCache(), true, 1, size);
+
+            return (uint8_t*) newHeader + POOL_HEADER_SIZE;
+        }
+    }
+    else if (size <= poolClassSizes[header->sizeClass]) {
+        return ptr;
+    }
+
+    size_t oldSize = (header->sizeClass == POOL_LARGE_OBJECT) ? header->size : poolClassSizes[header->sizeClass];
+
+    void* newPtr = MemoryPool_allocate(parameter, size);
+
+    if (newPtr) {
+        memcpy(newPtr, ptr, (oldSize < size) ? oldSize : size);
+
+        MemoryPool_release(parameter, ptr);
+    }
+
+    return newPtr;
+}
+
+static struct sMemoryAllocator poolAllocator = {
+    MemoryPool_allocate,
+    MemoryPool_reallocate,
+    MemoryPool_release,
+    NULL
+};
+
+MemoryAllocator
+MemoryPool_getAllocator(void)
+{
+    return &poolAllocator;
+}
+
+void
+MemoryPool_getStatistics(MemoryPoolStatistics* statistics)
+{
+    PoolThreadCache* cache = getThreadCache();
+
+    if (cache)
+        PoolThreadStatistics_publish(&(cache->statistics));
+
+    statistics->poolAllocations = __atomic_load_n(&(poolStatistics.poolAllocations), __ATOMIC_RELAXED);
+    statistics->systemAllocations = __atomic_load_n(&(poolStatistics.systemAllocations), __ATOMIC_RELAXED);
+    statistics->slabAllocations = __atomic_load_n(&(poolStatistics.slabAllocations), __ATOMIC_RELAXED);
+    statistics->liveObjects = __atomic_load_n(&(poolStatistics.liveObjects), __ATOMIC_RELAXED);
+    statistics->peakLiveObjects = __atomic_load_n(&(poolStatistics.peakLiveObjects), __ATOMIC_RELAXED);
+    statistics->liveBytes = __atomic_load_n(&(poolStatistics.liveBytes), __ATOMIC_RELAXED);
+    statistics->peakLiveBytes = __atomic_load_n(&(poolStatistics.peakLiveBytes), __ATOMIC_RELAXED);
+    statistics->reservedBytes = __atomic_load_n(&(poolStatistics.reservedBytes), __ATOMIC_RELAXED);
+}
+
+#else /* (MEMORY_POOL_SUPPORTED == 1) */
+
+MemoryAllocator
+MemoryPool_getAllocator(void)
+{
+    return NULL;
+}
+
+void
+MemoryPool_getStatistics(MemoryPoolStatistics* statistics)
+{
+    memset(statistics, 0, sizeof(MemoryPoolStatistics));
 }
 
+#endif /* (MEMORY_POOL_SUPPORTED == 1) */
@@ -62,6 +62,7 @@ struct sUdpSocket
 struct sHandleSet
 {
     LinkedList sockets;
+    LinkedList writeSockets; /* sockets that are ready when data can be written */
     bool pollfdIsUpdated;
     struct pollfd* fds;
     int nfds;
@@ -75,6 +76,7 @@ Handleset_new(void)
     if (self)
     {
         self->sockets = LinkedList_create();
+        self->writeSockets = LinkedList_create();
         self->pollfdIsUpdated = false;
         self->fds = NULL;
         self->nfds = 0;
@@ -94,6 +96,13 @@ Handleset_reset(HandleSet self)
             self->sockets = LinkedList_create();
             self->pollfdIsUpdated = false;
         }
+
+        if (self->writeSockets)
+        {
+            LinkedList_destroyStatic(self->writeSockets);
+            self->writeSockets = LinkedList_create();
+            self->pollfdIsUpdated = false;
+        }
     }
 }
 
@@ -107,12 +116,23 @@ Handleset_addSocket(HandleSet self, const Socket sock)
     }
 }
 
+void
+Handleset_addSocketForWriting(HandleSet self, const Socket sock)
+{
+    if (self != NULL && sock != NULL && sock->fd != -1)
+    {
+        LinkedList_add(self->writeSockets, sock);
+        self->pollfdIsUpdated = false;
+    }
+}
+
 void
 Handleset_removeSocket(HandleSet self, const Socket sock)
 {
     if (self && self->sockets && sock)
     {
         LinkedList_remove(self->sockets, sock);
+        LinkedList_remove(self->writeSockets, sock);
         self->pollfdIsUpdated = false;
     }
 }
@@ -129,7 +149,9 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs)
             self->fds = NULL;
         }
 
-        self->nfds = LinkedList_size(self->sockets);
+        int readSockets = LinkedList_size(self->sockets);
+
+        self->nfds = readSockets + LinkedList_size(self->writeSockets);
 
         self->fds = GLOBAL_CALLOC(self->nfds, sizeof(struct pollfd));
 
@@ -137,7 +159,12 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs)
 
         for (i = 0; i < self->nfds; i++)
         {
-            LinkedList sockElem = LinkedList_get(self->sockets, i);
+            LinkedList sockElem;
+
+            if (i < readSockets)
+                sockElem = LinkedList_get(self->sockets, i);
+            else
+                sockElem = LinkedList_get(self->writeSockets, i - readSockets);
 
             if (sockElem)
             {
@@ -146,7 +173,11 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs)
                 if (sock)
                 {
                     self->fds[i].fd = sock->fd;
-                    self->fds[i].events = POLL_IN;
+
+                    if (i < readSockets)
+                        self->fds[i].events = POLL_IN;
+                    else
+                        self->fds[i].events = POLLOUT;
                 }
             }
         }
@@ -181,6 +212,9 @@ Handleset_destroy(HandleSet self)
         if (self->sockets)
             LinkedList_destroyStatic(self->sockets);
 
+        if (self->writeSockets)
+            LinkedList_destroyStatic(self->writeSockets);
+
         if (self->fds)
             GLOBAL_FREEMEM(self->fds);
 
@@ -188,6 +222,190 @@ Handleset_destroy(HandleSet self)
     }
 }
 
+struct sSocketPoller
+{
+    struct pollfd* fds;
+    void** data;
+    int nfds;
+    int maxSockets;
+    int* ready;
+};
+
+SocketPoller
+SocketPoller_create(int maxSockets)
+{
+    SocketPoller self = (SocketPoller)GLOBAL_CALLOC(1, sizeof(struct sSocketPoller));
+
+    if (self)
+    {
+        self->maxSockets = maxSockets;
+        self->fds = (struct pollfd*)GLOBAL_CALLOC(maxSockets, sizeof(struct pollfd));
+        self->data = (void**)GLOBAL_CALLOC(maxSockets, sizeof(void*));
+        self->ready = (int*)GLOBAL_CALLOC(maxSockets, sizeof(int));
+
+        if ((self->fds == NULL) || (self->data == NULL) || (self->ready == NULL))
+        {
+            SocketPoller_destroy(self);
+            self = NULL;
+        }
+    }
+
+    return self;
+}
+
+bool
+SocketPoller_addSocket(SocketPoller self, const Socket sock, void* data)
+{
+    if (sock == NULL || sock->fd == -1 || self->nfds >= self->maxSockets)
+        return false;
+
+    self->fds[self->nfds].fd = sock->fd;
+    self->fds[self->nfds].events = POLLIN;
+    self->data[self->nfds] = data;
+    self->nfds++;
+
+    return true;
+}
+
+void
+SocketPoller_removeSocket(SocketPoller self, const Socket sock)
+{
+    int i;
+
+    for (i = 0; i < self->nfds; i++)
+    {
+        if (self->fds[i].fd == sock->fd)
+        {
+            self->nfds--;
+
+            self->fds[i] = self->fds[self->nfds];
+            self->data[i] = self->data[self->nfds];
+
+            break;
+        }
+    }
+}
+
+int
+SocketPoller_wait(SocketPoller self, unsigned int timeoutMs)
+{
+    int result = poll(self->fds, self->nfds, timeoutMs);
+
+    if (result == -1 && errno == EINTR)
+        result = 0;
+
+    if (result > 0)
+    {
+        int i;
+        int readyCount = 0;
+
+        for (i = 0; i < self->nfds; i++)
+        {
+            if (self->fds[i].revents)
+                self->ready[readyCount++] = i;
+        }
+
+        result = readyCount;
+    }
+    else if (result == -1)
+    {
+        if (DEBUG_SOCKET)
+            printf("SOCKET: poll error (errno: %i)\n", errno);
+    }
+
+    return result;
+}
+
+void*
+SocketPoller_getReady(SocketPoller self, int index)
+{
+    return self->data[self->ready[index]];
+}
+
+void
+SocketPoller_destroy(SocketPoller self)
+{
+    if (self)
+    {
+        if (self->fds)
+            GLOBAL_FREEMEM(self->fds);
+
+        if (self->data)
+            GLOBAL_FREEMEM(self->data);
+
+        if (self->ready)
+            GLOBAL_FREEMEM(self->ready);
+
+        GLOBAL_FREEMEM(self);
+    }
+}
+
+struct sWakeupEvent
+{
+    int fd; /* read end of the pipe */
+    int writeFd;
+};
+
+WakeupEvent
+WakeupEvent_create(void)
+{
+    WakeupEvent self = (WakeupEvent)GLOBAL_MALLOC(sizeof(struct sWakeupEvent));
+
+    if (self)
+    {
+        int fds[2];
+
+        if (pipe(fds) == -1)
+        {
+            if (DEBUG_SOCKET)
+                printf("SOCKET: failed to create pipe (errno: %i)\n", errno);
+
+            GLOBAL_FREEMEM(self);
+            return NULL;
+        }
+
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+        self->fd = fds[0];
+        self->writeFd = fds[1];
+    }
+
+    return self;
+}
+
+void
+WakeupEvent_signal(WakeupEvent self)
+{
+    uint8_t value = 1;
+
+    /* a full pipe is already ready for reading */
+    if (write(self->writeFd, &value, 1) == -1)
+    {
+        if (DEBUG_SOCKET && (errno != EAGAIN))
+            printf("SOCKET: failed to signal pipe (errno: %i)\n", errno);
+    }
+}
+
+void
+WakeupEvent_reset(WakeupEvent self)
+{
+    uint8_t buffer[64];
+
+    while (read(self->fd, buffer, sizeof(buffer)) > 0);
+}
+
+void
+WakeupEvent_destroy(WakeupEvent self)
+{
+    if (self)
+    {
+        close(self->fd);
+        close(self->writeFd);
+        GLOBAL_FREEMEM(self);
+    }
+}
+
 void
 Socket_activateTcpKeepAlive(Socket self, int idleTime, int interval, int count)
 {
@@ -251,8 +469,8 @@ activateTcpNoDelay(Socket self)
     setsockopt(self->fd, IPPROTO_TCP, TCP_NODELAY, (char*)&flag, sizeof(int));
 }
 
-ServerSocket
-TcpServerSocket_create(const char* address, int port)
+static ServerSocket
+createServerSocket(const char* address, int port, bool reusePort)
 {
     ServerSocket serverSocket = NULL;
 
@@ -271,6 +489,23 @@ TcpServerSocket_create(const char* address, int port)
         int optionReuseAddr = 1;
         setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*)&optionReuseAddr, sizeof(int));
 
+        if (reusePort)
+        {
+            /* only the load balancing variant distributes the connections between the sockets */
+#ifdef SO_REUSEPORT_LB
+            int optionReusePort = 1;
+
+            if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT_LB, (char*)&optionReusePort, sizeof(int)) < 0)
+            {
+                close(fd);
+                return NULL;
+            }
+#else
+            close(fd);
+            return NULL;
+#endif
+        }
+
         if (bind(fd, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) >= 0)
         {
             serverSocket = (ServerSocket)GLOBAL_MALLOC(sizeof(struct sServerSocket));
@@ -289,6 +524,18 @@ TcpServerSocket_create(const char* address, int port)
     return serverSocket;
 }
 
+ServerSocket
+TcpServerSocket_create(const char* address, int port)
+{
+    return createServerSocket(address, port, false);
+}
+
+ServerSocket
+TcpServerSocket_createReusePort(const char* address, int port)
+{
+    return createServerSocket(address, port, true);
+}
+
 void
 ServerSocket_listen(ServerSocket self)
 {
@@ -17,6 +17,8 @@
 #include <netinet/tcp.h> /* required for TCP keepalive */
 #include <stdio.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -55,6 +57,7 @@ struct sUdpSocket
 struct sHandleSet
 {
     LinkedList sockets;
+    LinkedList writeSockets; /* sockets that are ready when data can be written */
     bool pollfdIsUpdated;
     struct pollfd* fds;
     int nfds;
@@ -68,6 +71,7 @@ Handleset_new(void)
     if (self)
     {
         self->sockets = LinkedList_create();
+        self->writeSockets = LinkedList_create();
         self->pollfdIsUpdated = false;
         self->fds = NULL;
         self->nfds = 0;
@@ -87,6 +91,13 @@ Handleset_reset(HandleSet self)
             self->sockets = LinkedList_create();
             self->pollfdIsUpdated = false;
         }
+
+        if (self->writeSockets)
+        {
+            LinkedList_destroyStatic(self->writeSockets);
+            self->writeSockets = LinkedList_create();
+            self->pollfdIsUpdated = false;
+        }
     }
 }
 
@@ -101,12 +112,23 @@ Handleset_addSocket(HandleSet self, const Socket sock)
     }
 }
 
+void
+Handleset_addSocketForWriting(HandleSet self, const Socket sock)
+{
+    if (self != NULL && sock != NULL && sock->fd != -1)
+    {
+        LinkedList_add(self->writeSockets, sock);
+        self->pollfdIsUpdated = false;
+    }
+}
+
 void
 Handleset_removeSocket(HandleSet self, const Socket sock)
 {
     if (self && self->sockets && sock)
     {
         LinkedList_remove(self->sockets, sock);
+        LinkedList_remove(self->writeSockets, sock);
         self->pollfdIsUpdated = false;
     }
 }
@@ -123,7 +145,9 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs)
             self->fds = NULL;
         }
 
-        self->nfds = LinkedList_size(self->sockets);
+        int readSockets = LinkedList_size(self->sockets);
+
+        self->nfds = readSockets + LinkedList_size(self->writeSockets);
 
         self->fds = GLOBAL_CALLOC(self->nfds, sizeof(struct pollfd));
 
@@ -131,7 +155,12 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs)
 
         for (i = 0; i < self->nfds; i++)
         {
-            LinkedList sockElem = LinkedList_get(self->sockets, i);
+            LinkedList sockElem;
+
+            if (i < readSockets)
+                sockElem = LinkedList_get(self->sockets, i);
+            else
+                sockElem = LinkedList_get(self->writeSockets, i - readSockets);
 
             if (sockElem)
             {
@@ -140,7 +169,11 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs)
                 if (sock)
                 {
                     self->fds[i].fd = sock->fd;
-                    self->fds[i].events = POLL_IN;
+
+                    if (i < readSockets)
+                        self->fds[i].events = POLL_IN;
+                    else
+                        self->fds[i].events = POLLOUT;
                 }
             }
         }
@@ -180,6 +213,9 @@ Handleset_destroy(HandleSet self)
         if (self->sockets)
             LinkedList_destroyStatic(self->sockets);
 
+        if (self->writeSockets)
+            LinkedList_destroyStatic(self->writeSockets);
+
         if (self->fds)
             GLOBAL_FREEMEM(self->fds);
 
@@ -187,6 +223,165 @@ Handleset_destroy(HandleSet self)
     }
 }
 
+struct sSocketPoller
+{
+    int epfd;
+    struct epoll_event* events;
+    int maxSockets;
+};
+
+SocketPoller
+SocketPoller_create(int maxSockets)
+{
+    SocketPoller self = (SocketPoller)GLOBAL_MALLOC(sizeof(struct sSocketPoller));
+
+    if (self)
+    {
+        self->epfd = epoll_create1(EPOLL_CLOEXEC);
+        self->maxSockets = maxSockets;
+        self->events = (struct epoll_event*)GLOBAL_CALLOC(maxSockets, sizeof(struct epoll_event));
+
+        if ((self->epfd == -1) || (self->events == NULL))
+        {
+            if (DEBUG_SOCKET)
+                printf("SOCKET: failed to create epoll instance (errno: %i)\n", errno);
+
+            SocketPoller_destroy(self);
+            self = NULL;
+        }
+    }
+
+    return self;
+}
+
+bool
+SocketPoller_addSocket(SocketPoller self, const Socket sock, void* data)
+{
+    struct epoll_event event;
+
+    if (sock == NULL || sock->fd == -1)
+        return false;
+
+    event.events = EPOLLIN;
+    event.data.ptr = data;
+
+    if (epoll_ctl(self->epfd, EPOLL_CTL_ADD, sock->fd, &event) == -1)
+    {
+        if (DEBUG_SOCKET)
+            printf("SOCKET: epoll_ctl add failed (errno: %i)\n", errno);
+
+        return false;
+    }
+
+    return true;
+}
+
+void
+SocketPoller_removeSocket(SocketPoller self, const Socket sock)
+{
+    if (sock && sock->fd != -1)
+        epoll_ctl(self->epfd, EPOLL_CTL_DEL, sock->fd, NULL);
+}
+
+int
+SocketPoller_wait(SocketPoller self, unsigned int timeoutMs)
+{
+    int result = epoll_wait(self->epfd, self->events, self->maxSockets, timeoutMs);
+
+    if (result == -1 && errno == EINTR)
+        result = 0;
+
+    if (result == -1)
+    {
+        if (DEBUG_SOCKET)
+            printf("SOCKET: epoll_wait error (errno: %i)\n", errno);
+    }
+
+    return result;
+}
+
+void*
+SocketPoller_getReady(SocketPoller self, int index)
+{
+    return self->events[index].data.ptr;
+}
+
+void
+SocketPoller_destroy(SocketPoller self)
+{
+    if (self)
+    {
+        if (self->epfd != -1)
+            close(self->epfd);
+
+        if (self->events)
+            GLOBAL_FREEMEM(self->events);
+
+        GLOBAL_FREEMEM(self);
+    }
+}
+
+struct sWakeupEvent
+{
+    int fd;
+};
+
+WakeupEvent
+WakeupEvent_create(void)
+{
+    WakeupEvent self = (WakeupEvent)GLOBAL_MALLOC(sizeof(struct sWakeupEvent));
+
+    if (self)
+    {
+        self->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (self->fd == -1)
+        {
+            if (DEBUG_SOCKET)
+                printf("SOCKET: failed to create eventfd (errno: %i)\n", errno);
+
+            GLOBAL_FREEMEM(self);
+            self = NULL;
+        }
+    }
+
+    return self;
+}
+
+void
+WakeupEvent_signal(WakeupEvent self)
+{
+    uint64_t value = 1;
+
+    if (write(self->fd, &value, sizeof(value)) == -1)
+    {
+        if (DEBUG_SOCKET)
+            printf("SOCKET: failed to signal eventfd (errno: %i)\n", errno);
+    }
+}
+
+void
+WakeupEvent_reset(WakeupEvent self)
+{
+    uint64_t value;
+
+    if (read(self->fd, &value, sizeof(value)) == -1)
+    {
+        if (DEBUG_SOCKET && (errno != EAGAIN))
+            printf("SOCKET: failed to reset eventfd (errno: %i)\n", errno);
+    }
+}
+
+void
+WakeupEvent_destroy(WakeupEvent self)
+{
+    if (self)
+    {
+        close(self->fd);
+        GLOBAL_FREEMEM(self);
+    }
+}
+
 void
 Socket_activateTcpKeepAlive(Socket self, int idleTime, int interval, int count)
 {
@@ -287,8 +482,8 @@ activateTcpNoDelay(Socket self)
     setsockopt(self->fd, IPPROTO_TCP, TCP_NODELAY, (char*)&flag, sizeof(int));
 }
 
-ServerSocket
-TcpServerSocket_create(const char* address, int port)
+static ServerSocket
+createServerSocket(const char* address, int port, bool reusePort)
 {
     ServerSocket serverSocket = NULL;
 
@@ -307,6 +502,25 @@ TcpServerSocket_create(const char* address, int port)
         int optionReuseAddr = 1;
         setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*)&optionReuseAddr, sizeof(int));
 
+        if (reusePort)
+        {
+#ifdef SO_REUSEPORT
+            int optionReusePort = 1;
+
+            if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (char*)&optionReusePort, sizeof(int)) < 0)
+            {
+                if (DEBUG_SOCKET)
+                    printf("SOCKET: failed to set SO_REUSEPORT\n");
+
+                close(fd);
+                return NULL;
+            }
+#else
+            close(fd);
+            return NULL;
+#endif
+        }
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 37)
         int tcpUserTimeout = 10000;
         int result = setsockopt(fd, SOL_TCP, TCP_USER_TIMEOUT, &tcpUserTimeout, sizeof(tcpUserTimeout));
@@ -338,6 +552,18 @@ TcpServerSocket_create(const char* address, int port)
     return serverSocket;
 }
 
+ServerSocket
+TcpServerSocket_create(const char* address, int port)
+{
+    return createServerSocket(address, port, false);
+}
+
+ServerSocket
+TcpServerSocket_createReusePort(const char* address, int port)
+{
+    return createServerSocket(address, port, true);
+}
+
 void
 ServerSocket_listen(ServerSocket self)
 {
@@ -51,6 +51,8 @@ struct sServerSocket
 struct sHandleSet
 {
     fd_set handles;
+    fd_set writeHandles; /* sockets that are ready when data can be written */
+    bool hasWriteHandles;
     SOCKET maxHandle;
 };
 
@@ -68,6 +70,8 @@ Handleset_new(void)
     if (result != NULL)
     {
         FD_ZERO(&result->handles);
+        FD_ZERO(&result->writeHandles);
+        result->hasWriteHandles = false;
         result->maxHandle = INVALID_SOCKET;
     }
 
@@ -78,6 +82,8 @@ void
 Handleset_reset(HandleSet self)
 {
     FD_ZERO(&self->handles);
+    FD_ZERO(&self->writeHandles);
+    self->hasWriteHandles = false;
     self->maxHandle = INVALID_SOCKET;
 }
 
@@ -94,12 +100,26 @@ Handleset_addSocket(HandleSet self, const Socket sock)
     }
 }
 
+void
+Handleset_addSocketForWriting(HandleSet self, const Socket sock)
+{
+    if (self != NULL && sock != NULL && sock->fd != INVALID_SOCKET)
+    {
+        FD_SET(sock->fd, &self->writeHandles);
+        self->hasWriteHandles = true;
+
+        if ((sock->fd > self->maxHandle) || (self->maxHandle == INVALID_SOCKET))
+            self->maxHandle = sock->fd;
+    }
+}
+
 void
 Handleset_removeSocket(HandleSet self, const Socket sock)
 {
     if (self != NULL && sock != NULL && sock->fd != INVALID_SOCKET)
     {
         FD_CLR(sock->fd, &self->handles);
+        FD_CLR(sock->fd, &self->writeHandles);
     }
 }
 
@@ -116,10 +136,12 @@ Handleset_waitReady(HandleSet self, unsigned int timeoutMs)
         timeout.tv_usec = (timeoutMs % 1000) * 1000;
 
         fd_set handles;
+        fd_set writeHandles;
 
         memcpy((void*)&handles, &(self->handles), sizeof(fd_set));
+        memcpy((void*)&writeHandles, &(self->writeHandles), sizeof(fd_set));
 
-        result = select(0, &handles, NULL, NULL, &timeout);
+        result = select(0, &handles, self->hasWriteHandles ? &writeHandles : NULL, NULL, &timeout);
     }
     else
     {
@@ -135,6 +157,166 @@ Handleset_destroy(HandleSet self)
     GLOBAL_FREEMEM(self);
 }
 
+struct sSocketPoller
+{
+    SOCKET* fds;
+    void** data;
+    int nfds;
+    int maxSockets;
+    int* ready;
+};
+
+SocketPoller
+SocketPoller_create(int maxSockets)
+{
+    SocketPoller self = (SocketPoller)GLOBAL_CALLOC(1, sizeof(struct sSocketPoller));
+
+    if (self)
+    {
+        self->maxSockets = maxSockets;
+        self->fds = (SOCKET*)GLOBAL_CALLOC(maxSockets, sizeof(SOCKET));
+        self->data = (void**)GLOBAL_CALLOC(maxSockets, sizeof(void*));
+        self->ready = (int*)GLOBAL_CALLOC(maxSockets, sizeof(int));
+
+        if ((self->fds == NULL) || (self->data == NULL) || (self->ready == NULL))
+        {
+            SocketPoller_destroy(self);
+            self = NULL;
+        }
+    }
+
+    return self;
+}
+
+bool
+SocketPoller_addSocket(SocketPoller self, const Socket sock, void* data)
+{
+    /* select is limited to FD_SETSIZE sockets */
+    if (sock == NULL || sock->fd == INVALID_SOCKET || self->nfds >= self->maxSockets || self->nfds >= FD_SETSIZE)
+        return false;
+
+    self->fds[self->nfds] = sock->fd;
+    self->data[self->nfds] = data;
+    self->nfds++;
+
+    return true;
+}
+
+void
+SocketPoller_removeSocket(SocketPoller self, const Socket sock)
+{
+    int i;
+
+    for (i = 0; i < self->nfds; i++)
+    {
+        if (self->fds[i] == sock->fd)
+        {
+            self->nfds--;
+
+            self->fds[i] = self->fds[self->nfds];
+            self->data[i] = self->data[self->nfds];
+
+            break;
+        }
+    }
+}
+
+int
+SocketPoller_wait(SocketPoller self, unsigned int timeoutMs)
+{
+    int result;
+    int i;
+    fd_set handles;
+    struct timeval timeout;
+
+    if (self->nfds == 0)
+    {
+        Sleep(timeoutMs);
+        return 0;
+    }
+
+    FD_ZERO(&handles);
+
+    for (i = 0; i < self->nfds; i++)
+        FD_SET(self->fds[i], &handles);
+
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+    result = select(0, &handles, NULL, NULL, &timeout);
+
+    if (result > 0)
+    {
+        int readyCount = 0;
+
+        for (i = 0; i < self->nfds; i++)
+        {
+            if (FD_ISSET(self->fds[i], &handles))
+                self->ready[readyCount++] = i;
+        }
+
+        result = readyCount;
+    }
+    else if (result == SOCKET_ERROR)
+    {
+        if (DEBUG_SOCKET)
+            printf("SOCKET: select error (error: %i)\n", WSAGetLastError());
+
+        result = -1;
+    }
+
+    return result;
+}
+
+void*
+SocketPoller_getReady(SocketPoller self, int index)
+{
+    return self->data[self->ready[index]];
+}
+
+void
+SocketPoller_destroy(SocketPoller self)
+{
+    if (self)
+    {
+        if (self->fds)
+            GLOBAL_FREEMEM(self->fds);
+
+        if (self->data)
+            GLOBAL_FREEMEM(self->data);
+
+        if (self->ready)
+            GLOBAL_FREEMEM(self->ready);
+
+        GLOBAL_FREEMEM(self);
+    }
+}
+
+WakeupEvent
+WakeupEvent_create(void)
+{
+    /* not supported - select only waits for sockets */
+    return NULL;
+}
+
+void
+WakeupEvent_signal(WakeupEvent self)
+{
+    (void)self;
+}
+
+void
+WakeupEvent_reset(WakeupEvent self)
+{
+    (void)self;
+}
+
+void
+WakeupEvent_destroy(WakeupEvent self)
+{
+    (void)self;
+}
+
 static bool wsaStartupCalled = false;
 static int socketCount = 0;
 
@@ -299,6 +481,16 @@ TcpServerSocket_create(const char* address, int port)
     return serverSocket;
 }
 
+ServerSocket
+TcpServerSocket_createReusePort(const char* address, int port)
+{
+    /* Windows does not distribute connections between sockets bound to the same port */
+    (void)address;
+    (void)port;
+
+    return NULL;
+}
+
 void
 ServerSocket_listen(ServerSocket self)
 {
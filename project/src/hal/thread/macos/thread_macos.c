@@ -66,6 +66,25 @@ Semaphore_wait(Semaphore self)
     }
 }
 
+/* macOS has no pthread_mutex_timedlock -> poll the mutex */
+bool
+Semaphore_waitTimeout(Semaphore self, int timeoutInMs)
+{
+    mSemaphore mSelf = (mSemaphore) self;
+
+    int elapsed = 0;
+
+    while (pthread_mutex_trylock(&(mSelf->mutex)) != 0) {
+        if (elapsed >= timeoutInMs)
+            return false;
+
+        usleep(1000);
+        elapsed++;
+    }
+
+    return true;
+}
+
 /* unlock mutex */
 void
 Semaphore_post(Semaphore self)
@@ -147,3 +166,11 @@ Thread_sleep(int millies)
 {
    usleep(millies * 1000);
 }
+
+bool
+Thread_setCpuAffinity(int cpu)
+{
+   (void)cpu;
+
+   return false;
+}
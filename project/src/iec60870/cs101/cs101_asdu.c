@@ -174,6 +174,233 @@ CS101_ASDU_encode(CS101_ASDU self, Frame frame)
     Frame_appendBytes(frame, self->asdu, self->asduHeaderLength + self->payloadSize);
 }
 
+/********************************************************************************
+ * Type information
+ *******************************************************************************/
+
+/* size of the time tags in an information element */
+#define TIMESTAMP_NONE 0
+#define TIMESTAMP_CP24 3
+#define TIMESTAMP_CP56 7
+
+/* elements are parsed as sequence (one IOA followed by the elements) when SQ=1 */
+#define TYPE_SEQUENCE 0x01
+
+/* the ASDU contains a single element (only the first element is parsed) */
+#define TYPE_SINGLE 0x02
+
+/* the element size is the minimum size (e.g. file segment with variable length data) */
+#define TYPE_VARIABLE_SIZE 0x04
+
+typedef InformationObject (*ElementDecoder)(InformationObject io, CS101_AppLayerParameters parameters,
+        uint8_t* msg, int msgSize, int startIndex, bool isSequence);
+
+typedef struct {
+    uint8_t elementSize; /* size of an element without IOA */
+    uint8_t timestampSize;
+    uint8_t flags;
+    ElementDecoder decode;
+} sTypeInfo;
+
+#define TYPE_INFO(type, valueSize, timestamp, flags) { (valueSize) + (timestamp), (timestamp), (flags), type##_decode }
+
+#define DECODER_WITH_SEQUENCE(type) \
+static InformationObject \
+type##_decode(InformationObject io, CS101_AppLayerParameters parameters, uint8_t* msg, int msgSize, int startIndex, bool isSequence) \
+{ \
+    return (InformationObject) type##_getFromBuffer((type) io, parameters, msg, msgSize, startIndex, isSequence); \
+}
+
+#define DECODER(type) \
+static InformationObject \
+type##_decode(InformationObject io, CS101_AppLayerParameters parameters, uint8_t* msg, int msgSize, int startIndex, bool isSequence) \
+{ \
+    UNUSED_PARAMETER(isSequence); \
+    return (InformationObject) type##_getFromBuffer((type) io, parameters, msg, msgSize, startIndex); \
+}
+
+DECODER_WITH_SEQUENCE(SinglePointInformation)
+DECODER_WITH_SEQUENCE(SinglePointWithCP24Time2a)
+DECODER_WITH_SEQUENCE(DoublePointInformation)
+DECODER_WITH_SEQUENCE(DoublePointWithCP24Time2a)
+DECODER_WITH_SEQUENCE(StepPositionInformation)
+DECODER_WITH_SEQUENCE(StepPositionWithCP24Time2a)
+DECODER_WITH_SEQUENCE(BitString32)
+DECODER_WITH_SEQUENCE(Bitstring32WithCP24Time2a)
+DECODER_WITH_SEQUENCE(MeasuredValueNormalized)
+DECODER_WITH_SEQUENCE(MeasuredValueNormalizedWithCP24Time2a)
+DECODER_WITH_SEQUENCE(MeasuredValueScaled)
+DECODER_WITH_SEQUENCE(MeasuredValueScaledWithCP24Time2a)
+DECODER_WITH_SEQUENCE(MeasuredValueShort)
+DECODER_WITH_SEQUENCE(MeasuredValueShortWithCP24Time2a)
+DECODER_WITH_SEQUENCE(IntegratedTotals)
+DECODER_WITH_SEQUENCE(IntegratedTotalsWithCP24Time2a)
+DECODER_WITH_SEQUENCE(EventOfProtectionEquipment)
+DECODER_WITH_SEQUENCE(PackedStartEventsOfProtectionEquipment)
+DECODER_WITH_SEQUENCE(PackedOutputCircuitInfo)
+DECODER_WITH_SEQUENCE(PackedSinglePointWithSCD)
+DECODER_WITH_SEQUENCE(MeasuredValueNormalizedWithoutQuality)
+DECODER_WITH_SEQUENCE(SinglePointWithCP56Time2a)
+DECODER_WITH_SEQUENCE(DoublePointWithCP56Time2a)
+DECODER_WITH_SEQUENCE(StepPositionWithCP56Time2a)
+DECODER_WITH_SEQUENCE(Bitstring32WithCP56Time2a)
+DECODER_WITH_SEQUENCE(MeasuredValueNormalizedWithCP56Time2a)
+DECODER_WITH_SEQUENCE(MeasuredValueScaledWithCP56Time2a)
+DECODER_WITH_SEQUENCE(MeasuredValueShortWithCP56Time2a)
+DECODER_WITH_SEQUENCE(IntegratedTotalsWithCP56Time2a)
+DECODER_WITH_SEQUENCE(EventOfProtectionEquipmentWithCP56Time2a)
+DECODER_WITH_SEQUENCE(PackedStartEventsOfProtectionEquipmentWithCP56Time2a)
+DECODER_WITH_SEQUENCE(PackedOutputCircuitInfoWithCP56Time2a)
+DECODER_WITH_SEQUENCE(FileDirectory)
+
+DECODER(SingleCommand)
+DECODER(DoubleCommand)
+DECODER(StepCommand)
+DECODER(SetpointCommandNormalized)
+DECODER(SetpointCommandScaled)
+DECODER(SetpointCommandShort)
+DECODER(Bitstring32Command)
+DECODER(SingleCommandWithCP56Time2a)
+DECODER(DoubleCommandWithCP56Time2a)
+DECODER(StepCommandWithCP56Time2a)
+DECODER(SetpointCommandNormalizedWithCP56Time2a)
+DECODER(SetpointCommandScaledWithCP56Time2a)
+DECODER(SetpointCommandShortWithCP56Time2a)
+DECODER(Bitstring32CommandWithCP56Time2a)
+DECODER(EndOfInitialization)
+DECODER(InterrogationCommand)
+DECODER(CounterInterrogationCommand)
+DECODER(ReadCommand)
+DECODER(ClockSynchronizationCommand)
+DECODER(TestCommand)
+DECODER(ResetProcessCommand)
+DECODER(DelayAcquisitionCommand)
+DECODER(TestCommandWithCP56Time2a)
+DECODER(ParameterNormalizedValue)
+DECODER(ParameterScaledValue)
+DECODER(ParameterFloatValue)
+DECODER(ParameterActivation)
+DECODER(FileReady)
+DECODER(SectionReady)
+DECODER(FileCallOrSelect)
+DECODER(FileLastSegmentOrSection)
+DECODER(FileACK)
+DECODER(FileSegment)
+DECODER(QueryLog)
+
+/* indexed by type ID - entries without decoder are unknown or reserved type IDs */
+static const sTypeInfo typeInfos[] = {
+    [M_SP_NA_1] = TYPE_INFO(SinglePointInformation, 1, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_SP_TA_1] = TYPE_INFO(SinglePointWithCP24Time2a, 1, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_DP_NA_1] = TYPE_INFO(DoublePointInformation, 1, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_DP_TA_1] = TYPE_INFO(DoublePointWithCP24Time2a, 1, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_ST_NA_1] = TYPE_INFO(StepPositionInformation, 2, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_ST_TA_1] = TYPE_INFO(StepPositionWithCP24Time2a, 2, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_BO_NA_1] = TYPE_INFO(BitString32, 5, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_BO_TA_1] = TYPE_INFO(Bitstring32WithCP24Time2a, 5, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_ME_NA_1] = TYPE_INFO(MeasuredValueNormalized, 3, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_ME_TA_1] = TYPE_INFO(MeasuredValueNormalizedWithCP24Time2a, 3, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_ME_NB_1] = TYPE_INFO(MeasuredValueScaled, 3, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_ME_TB_1] = TYPE_INFO(MeasuredValueScaledWithCP24Time2a, 3, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_ME_NC_1] = TYPE_INFO(MeasuredValueShort, 5, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_ME_TC_1] = TYPE_INFO(MeasuredValueShortWithCP24Time2a, 5, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_IT_NA_1] = TYPE_INFO(IntegratedTotals, 5, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_IT_TA_1] = TYPE_INFO(IntegratedTotalsWithCP24Time2a, 5, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_EP_TA_1] = TYPE_INFO(EventOfProtectionEquipment, 3, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_EP_TB_1] = TYPE_INFO(PackedStartEventsOfProtectionEquipment, 4, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_EP_TC_1] = TYPE_INFO(PackedOutputCircuitInfo, 4, TIMESTAMP_CP24, TYPE_SEQUENCE),
+    [M_PS_NA_1] = TYPE_INFO(PackedSinglePointWithSCD, 5, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_ME_ND_1] = TYPE_INFO(MeasuredValueNormalizedWithoutQuality, 2, TIMESTAMP_NONE, TYPE_SEQUENCE),
+    [M_SP_TB_1] = TYPE_INFO(SinglePointWithCP56Time2a, 1, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_DP_TB_1] = TYPE_INFO(DoublePointWithCP56Time2a, 1, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_ST_TB_1] = TYPE_INFO(StepPositionWithCP56Time2a, 2, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_BO_TB_1] = TYPE_INFO(Bitstring32WithCP56Time2a, 5, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_ME_TD_1] = TYPE_INFO(MeasuredValueNormalizedWithCP56Time2a, 3, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_ME_TE_1] = TYPE_INFO(MeasuredValueScaledWithCP56Time2a, 3, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_ME_TF_1] = TYPE_INFO(MeasuredValueShortWithCP56Time2a, 5, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_IT_TB_1] = TYPE_INFO(IntegratedTotalsWithCP56Time2a, 5, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_EP_TD_1] = TYPE_INFO(EventOfProtectionEquipmentWithCP56Time2a, 3, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_EP_TE_1] = TYPE_INFO(PackedStartEventsOfProtectionEquipmentWithCP56Time2a, 4, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [M_EP_TF_1] = TYPE_INFO(PackedOutputCircuitInfoWithCP56Time2a, 4, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [C_SC_NA_1] = TYPE_INFO(SingleCommand, 1, TIMESTAMP_NONE, 0),
+    [C_DC_NA_1] = TYPE_INFO(DoubleCommand, 1, TIMESTAMP_NONE, 0),
+    [C_RC_NA_1] = TYPE_INFO(StepCommand, 1, TIMESTAMP_NONE, 0),
+    [C_SE_NA_1] = TYPE_INFO(SetpointCommandNormalized, 3, TIMESTAMP_NONE, 0),
+    [C_SE_NB_1] = TYPE_INFO(SetpointCommandScaled, 3, TIMESTAMP_NONE, 0),
+    [C_SE_NC_1] = TYPE_INFO(SetpointCommandShort, 5, TIMESTAMP_NONE, 0),
+    [C_BO_NA_1] = TYPE_INFO(Bitstring32Command, 4, TIMESTAMP_NONE, 0),
+    [C_SC_TA_1] = TYPE_INFO(SingleCommandWithCP56Time2a, 1, TIMESTAMP_CP56, 0),
+    [C_DC_TA_1] = TYPE_INFO(DoubleCommandWithCP56Time2a, 1, TIMESTAMP_CP56, 0),
+    [C_RC_TA_1] = TYPE_INFO(StepCommandWithCP56Time2a, 1, TIMESTAMP_CP56, 0),
+    [C_SE_TA_1] = TYPE_INFO(SetpointCommandNormalizedWithCP56Time2a, 3, TIMESTAMP_CP56, 0),
+    [C_SE_TB_1] = TYPE_INFO(SetpointCommandScaledWithCP56Time2a, 3, TIMESTAMP_CP56, 0),
+    [C_SE_TC_1] = TYPE_INFO(SetpointCommandShortWithCP56Time2a, 5, TIMESTAMP_CP56, 0),
+    [C_BO_TA_1] = TYPE_INFO(Bitstring32CommandWithCP56Time2a, 4, TIMESTAMP_CP56, 0),
+    [M_EI_NA_1] = TYPE_INFO(EndOfInitialization, 1, TIMESTAMP_NONE, TYPE_SINGLE),
+    [C_IC_NA_1] = TYPE_INFO(InterrogationCommand, 1, TIMESTAMP_NONE, TYPE_SINGLE),
+    [C_CI_NA_1] = TYPE_INFO(CounterInterrogationCommand, 1, TIMESTAMP_NONE, TYPE_SINGLE),
+    [C_RD_NA_1] = TYPE_INFO(ReadCommand, 0, TIMESTAMP_NONE, TYPE_SINGLE),
+    [C_CS_NA_1] = TYPE_INFO(ClockSynchronizationCommand, 0, TIMESTAMP_CP56, TYPE_SINGLE),
+    [C_TS_NA_1] = TYPE_INFO(TestCommand, 2, TIMESTAMP_NONE, TYPE_SINGLE),
+    [C_RP_NA_1] = TYPE_INFO(ResetProcessCommand, 1, TIMESTAMP_NONE, TYPE_SINGLE),
+    [C_CD_NA_1] = TYPE_INFO(DelayAcquisitionCommand, 2, TIMESTAMP_NONE, TYPE_SINGLE),
+    [C_TS_TA_1] = TYPE_INFO(TestCommandWithCP56Time2a, 2, TIMESTAMP_CP56, TYPE_SINGLE),
+    [P_ME_NA_1] = TYPE_INFO(ParameterNormalizedValue, 3, TIMESTAMP_NONE, 0),
+    [P_ME_NB_1] = TYPE_INFO(ParameterScaledValue, 3, TIMESTAMP_NONE, 0),
+    [P_ME_NC_1] = TYPE_INFO(ParameterFloatValue, 5, TIMESTAMP_NONE, 0),
+    [P_AC_NA_1] = TYPE_INFO(ParameterActivation, 1, TIMESTAMP_NONE, 0),
+    [F_FR_NA_1] = TYPE_INFO(FileReady, 6, TIMESTAMP_NONE, TYPE_SINGLE),
+    [F_SR_NA_1] = TYPE_INFO(SectionReady, 7, TIMESTAMP_NONE, TYPE_SINGLE),
+    [F_SC_NA_1] = TYPE_INFO(FileCallOrSelect, 4, TIMESTAMP_NONE, TYPE_SINGLE),
+    [F_LS_NA_1] = TYPE_INFO(FileLastSegmentOrSection, 5, TIMESTAMP_NONE, TYPE_SINGLE),
+    [F_AF_NA_1] = TYPE_INFO(FileACK, 4, TIMESTAMP_NONE, TYPE_SINGLE),
+    [F_SG_NA_1] = TYPE_INFO(FileSegment, 4, TIMESTAMP_NONE, TYPE_SINGLE | TYPE_VARIABLE_SIZE),
+    [F_DR_TA_1] = TYPE_INFO(FileDirectory, 6, TIMESTAMP_CP56, TYPE_SEQUENCE),
+    [F_SC_NB_1] = TYPE_INFO(QueryLog, 2 + TIMESTAMP_CP56, TIMESTAMP_CP56, TYPE_SINGLE)
+};
+
+#define TYPE_INFO_COUNT ((int) (sizeof(typeInfos) / sizeof(typeInfos[0])))
+
+/* compile time check: the table has to cover all type IDs up to the last known type ID */
+typedef char typeInfosCoverAllTypes[(TYPE_INFO_COUNT == (F_SC_NB_1 + 1)) ? 1 : -1];
+
+static const sTypeInfo*
+getTypeInfo(TypeID typeId)
+{
+    if (((int) typeId < TYPE_INFO_COUNT) && typeInfos[typeId].decode)
+        return &(typeInfos[typeId]);
+    else
+        return NULL;
+}
+
+/* check the payload size against the number of elements (unknown type IDs are not checked) */
+static bool
+isPayloadSizeValid(CS101_ASDU self)
+{
+    if (self->asduHeaderLength < 2)
+        return true;
+
+    const sTypeInfo* typeInfo = getTypeInfo((TypeID) self->asdu[0]);
+
+    if (typeInfo == NULL)
+        return true;
+
+    int numberOfElements = CS101_ASDU_getNumberOfElements(self);
+
+    if (numberOfElements == 0)
+        return (self->payloadSize == 0);
+
+    int sizeOfIOA = self->parameters->sizeOfIOA;
+
+    if (typeInfo->flags & TYPE_VARIABLE_SIZE)
+        return (self->payloadSize >= (sizeOfIOA + typeInfo->elementSize));
+
+    if ((typeInfo->flags & TYPE_SEQUENCE) && CS101_ASDU_isSequence(self))
+        return (self->payloadSize == (sizeOfIOA + (numberOfElements * typeInfo->elementSize)));
+    else
+        return (self->payloadSize == (numberOfElements * (sizeOfIOA + typeInfo->elementSize)));
+}
+
 CS101_ASDU
 CS101_ASDU_createFromBuffer(CS101_AppLayerParameters parameters, uint8_t* msg, int msgLength)
 {
@@ -192,6 +419,13 @@ CS101_ASDU_createFromBuffer(CS101_AppLayerParameters parameters, uint8_t* msg, i
 
         self->payload = msg + asduHeaderLength;
         self->payloadSize = msgLength - asduHeaderLength;
+
+        if (isPayloadSizeValid(self) == false) {
+            DEBUG_PRINT("invalid ASDU - payload size does not match type ID and number of elements\n");
+
+            GLOBAL_FREEMEM(self);
+            self = NULL;
+        }
     }
 
     return self;
@@ -283,6 +517,92 @@ CS101_ASDU_addInformationObject(CS101_ASDU self, InformationObject io)
     return encoded;
 }
 
+/* start or continue a sequence of elements and return the number of elements that can be added */
+static int
+prepareSequence(CS101_ASDU self, TypeID typeId, int startIoa, int elementSize, int count)
+{
+    if (CS101_ASDU_isSequence(self) == false)
+        return 0;
+
+    int numberOfElements = CS101_ASDU_getNumberOfElements(self);
+
+    int spaceLeft = self->parameters->maxSizeOfASDU - self->asduHeaderLength - self->payloadSize;
+
+    if (numberOfElements == 0)
+        spaceLeft -= self->parameters->sizeOfIOA;
+    else if ((self->asdu[0] != (uint8_t) typeId) || (startIoa != (getFirstIOA(self) + numberOfElements)))
+        return 0;
+
+    int maxElements = spaceLeft / elementSize;
+
+    if (maxElements > (0x7f - numberOfElements))
+        maxElements = 0x7f - numberOfElements;
+
+    if (count > maxElements)
+        count = maxElements;
+
+    if ((count > 0) && (numberOfElements == 0)) {
+        self->asdu[0] = (uint8_t) typeId;
+
+        self->payload[self->payloadSize++] = (uint8_t)(startIoa & 0xff);
+
+        if (self->parameters->sizeOfIOA > 1)
+            self->payload[self->payloadSize++] = (uint8_t)((startIoa / 0x100) & 0xff);
+
+        if (self->parameters->sizeOfIOA > 2)
+            self->payload[self->payloadSize++] = (uint8_t)((startIoa / 0x10000) & 0xff);
+    }
+
+    return count;
+}
+
+int
+CS101_ASDU_addSinglePointSequence(CS101_ASDU self, int startIoa, const bool* values, const QualityDescriptor* qualities, int count)
+{
+    count = prepareSequence(self, M_SP_NA_1, startIoa, 1, count);
+
+    uint8_t* buffer = self->payload + self->payloadSize;
+
+    int i;
+
+    for (i = 0; i < count; i++) {
+        uint8_t val = qualities ? (uint8_t) (qualities[i] & 0xf0) : 0;
+
+        if (values[i])
+            val++;
+
+        buffer[i] = val;
+    }
+
+    self->payloadSize += count;
+    self->asdu[1] += (uint8_t) count; /* increase number of elements in VSQ */
+
+    return count;
+}
+
+int
+CS101_ASDU_addScaledValueSequence(CS101_ASDU self, int startIoa, const int16_t* values, const QualityDescriptor* qualities, int count)
+{
+    count = prepareSequence(self, M_ME_NB_1, startIoa, 3, count);
+
+    uint8_t* buffer = self->payload + self->payloadSize;
+
+    int i;
+
+    for (i = 0; i < count; i++) {
+        uint16_t valueToEncode = (uint16_t) values[i];
+
+        *(buffer++) = (uint8_t) (valueToEncode % 256);
+        *(buffer++) = (uint8_t) (valueToEncode / 256);
+        *(buffer++) = qualities ? (uint8_t) qualities[i] : IEC60870_QUALITY_GOOD;
+    }
+
+    self->payloadSize += (count * 3);
+    self->asdu[1] += (uint8_t) count; /* increase number of elements in VSQ */
+
+    return count;
+}
+
 void
 CS101_ASDU_removeAllElements(CS101_ASDU self)
 {
@@ -447,793 +767,54 @@ CS101_ASDU_getElementEx(CS101_ASDU self, InformationObject io, int index)
 {
     InformationObject retVal = NULL;
 
-    int elementSize;
-
-    switch (CS101_ASDU_getTypeID(self)) {
-
-    case M_SP_NA_1: /* 1 */
-
-        elementSize = 1;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) SinglePointInformation_getFromBuffer((SinglePointInformation) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) SinglePointInformation_getFromBuffer((SinglePointInformation) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_SP_TA_1: /* 2 */
-
-        elementSize = 4;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) SinglePointWithCP24Time2a_getFromBuffer((SinglePointWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) SinglePointWithCP24Time2a_getFromBuffer((SinglePointWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_DP_NA_1: /* 3 */
-
-        elementSize = 1;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) DoublePointInformation_getFromBuffer((DoublePointInformation) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) DoublePointInformation_getFromBuffer((DoublePointInformation) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-
-        break;
-
-    case M_DP_TA_1: /* 4 */
-
-        elementSize = 4;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) DoublePointWithCP24Time2a_getFromBuffer((DoublePointWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) DoublePointWithCP24Time2a_getFromBuffer((DoublePointWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ST_NA_1: /* 5 */
+    const sTypeInfo* typeInfo = getTypeInfo(CS101_ASDU_getTypeID(self));
 
-        elementSize = 2;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) StepPositionInformation_getFromBuffer((StepPositionInformation) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) StepPositionInformation_getFromBuffer((StepPositionInformation) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ST_TA_1: /* 6 */
-
-        elementSize = 5;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) StepPositionWithCP24Time2a_getFromBuffer((StepPositionWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) StepPositionWithCP24Time2a_getFromBuffer((StepPositionWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_BO_NA_1: /* 7 */
-
-        elementSize = 5;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) BitString32_getFromBuffer((BitString32) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) BitString32_getFromBuffer((BitString32) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_BO_TA_1: /* 8 */
-
-        elementSize = 8;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) Bitstring32WithCP24Time2a_getFromBuffer((Bitstring32WithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) Bitstring32WithCP24Time2a_getFromBuffer((Bitstring32WithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_NA_1: /* 9 */
-
-        elementSize = 3;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueNormalized_getFromBuffer((MeasuredValueNormalized) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueNormalized_getFromBuffer((MeasuredValueNormalized) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_TA_1: /* 10 */
-
-        elementSize = 6;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueNormalizedWithCP24Time2a_getFromBuffer((MeasuredValueNormalizedWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueNormalizedWithCP24Time2a_getFromBuffer((MeasuredValueNormalizedWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_NB_1: /* 11 */
-
-        elementSize = 3;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueScaled_getFromBuffer((MeasuredValueScaled) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueScaled_getFromBuffer((MeasuredValueScaled) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_TB_1: /* 12 */
-
-        elementSize = 6;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueScaledWithCP24Time2a_getFromBuffer((MeasuredValueScaledWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueScaledWithCP24Time2a_getFromBuffer((MeasuredValueScaledWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-
-    case M_ME_NC_1: /* 13 */
-
-        elementSize = 5;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueShort_getFromBuffer((MeasuredValueShort) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueShort_getFromBuffer((MeasuredValueShort) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-
-        break;
-
-    case M_ME_TC_1: /* 14 */
-
-        elementSize = 8;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueShortWithCP24Time2a_getFromBuffer((MeasuredValueShortWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueShortWithCP24Time2a_getFromBuffer((MeasuredValueShortWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_IT_NA_1: /* 15 */
-
-        elementSize = 5;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) IntegratedTotals_getFromBuffer((IntegratedTotals) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) IntegratedTotals_getFromBuffer((IntegratedTotals) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_IT_TA_1: /* 16 */
-
-        elementSize = 8;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) IntegratedTotalsWithCP24Time2a_getFromBuffer((IntegratedTotalsWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) IntegratedTotalsWithCP24Time2a_getFromBuffer((IntegratedTotalsWithCP24Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_EP_TA_1: /* 17 */
-
-        elementSize = 6;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) EventOfProtectionEquipment_getFromBuffer((EventOfProtectionEquipment) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) EventOfProtectionEquipment_getFromBuffer((EventOfProtectionEquipment) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_EP_TB_1: /* 18 */
-
-        elementSize = 7;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) PackedStartEventsOfProtectionEquipment_getFromBuffer((PackedStartEventsOfProtectionEquipment) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) PackedStartEventsOfProtectionEquipment_getFromBuffer((PackedStartEventsOfProtectionEquipment) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_EP_TC_1: /* 19 */
-
-        elementSize = 7;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) PackedOutputCircuitInfo_getFromBuffer((PackedOutputCircuitInfo) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) PackedOutputCircuitInfo_getFromBuffer((PackedOutputCircuitInfo) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_PS_NA_1: /* 20 */
-
-        elementSize = 5;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) PackedSinglePointWithSCD_getFromBuffer((PackedSinglePointWithSCD) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) PackedSinglePointWithSCD_getFromBuffer((PackedSinglePointWithSCD) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_ND_1: /* 21 */
-
-        elementSize = 2;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueNormalizedWithoutQuality_getFromBuffer((MeasuredValueNormalizedWithoutQuality) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueNormalizedWithoutQuality_getFromBuffer((MeasuredValueNormalizedWithoutQuality) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_SP_TB_1: /* 30 */
-
-        elementSize = 8;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) SinglePointWithCP56Time2a_getFromBuffer((SinglePointWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) SinglePointWithCP56Time2a_getFromBuffer((SinglePointWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_DP_TB_1: /* 31 */
-
-        elementSize = 8;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) DoublePointWithCP56Time2a_getFromBuffer((DoublePointWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) DoublePointWithCP56Time2a_getFromBuffer((DoublePointWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ST_TB_1: /* 32 */
-
-        elementSize = 9;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) StepPositionWithCP56Time2a_getFromBuffer((StepPositionWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) StepPositionWithCP56Time2a_getFromBuffer((StepPositionWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_BO_TB_1: /* 33 */
-
-        elementSize = 12;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) Bitstring32WithCP56Time2a_getFromBuffer((Bitstring32WithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) Bitstring32WithCP56Time2a_getFromBuffer((Bitstring32WithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_TD_1: /* 34 */
-
-        elementSize = 10;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueNormalizedWithCP56Time2a_getFromBuffer((MeasuredValueNormalizedWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueNormalizedWithCP56Time2a_getFromBuffer((MeasuredValueNormalizedWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_TE_1: /* 35 */
-
-        elementSize = 10;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueScaledWithCP56Time2a_getFromBuffer((MeasuredValueScaledWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueScaledWithCP56Time2a_getFromBuffer((MeasuredValueScaledWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_ME_TF_1: /* 36 */
-
-        elementSize = 12;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) MeasuredValueShortWithCP56Time2a_getFromBuffer((MeasuredValueShortWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) MeasuredValueShortWithCP56Time2a_getFromBuffer((MeasuredValueShortWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_IT_TB_1: /* 37 */
-
-        elementSize = 12;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) IntegratedTotalsWithCP56Time2a_getFromBuffer((IntegratedTotalsWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) IntegratedTotalsWithCP56Time2a_getFromBuffer((IntegratedTotalsWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_EP_TD_1: /* 38 */
-
-        elementSize = 10;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) EventOfProtectionEquipmentWithCP56Time2a_getFromBuffer((EventOfProtectionEquipmentWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) EventOfProtectionEquipmentWithCP56Time2a_getFromBuffer((EventOfProtectionEquipmentWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_EP_TE_1: /* 39 */
-
-        elementSize = 11;
-
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) PackedStartEventsOfProtectionEquipmentWithCP56Time2a_getFromBuffer((PackedStartEventsOfProtectionEquipmentWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
-
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) PackedStartEventsOfProtectionEquipmentWithCP56Time2a_getFromBuffer((PackedStartEventsOfProtectionEquipmentWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    case M_EP_TF_1: /* 40 */
+    if (typeInfo == NULL) {
+        DEBUG_PRINT("type %d not supported\n", CS101_ASDU_getTypeID(self));
+        return NULL;
+    }
 
-        elementSize = 11;
+    int sizeOfIOA = self->parameters->sizeOfIOA;
 
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) PackedOutputCircuitInfoWithCP56Time2a_getFromBuffer((PackedOutputCircuitInfoWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
+    if (typeInfo->flags & TYPE_SINGLE) {
+        retVal = typeInfo->decode(io, self->parameters, self->payload, self->payloadSize, 0, false);
+    }
+    else if ((typeInfo->flags & TYPE_SEQUENCE) && CS101_ASDU_isSequence(self)) {
+        retVal = typeInfo->decode(io, self->parameters, self->payload, self->payloadSize,
+                sizeOfIOA + (index * typeInfo->elementSize), true);
 
+        if (retVal)
             InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) PackedOutputCircuitInfoWithCP56Time2a_getFromBuffer((PackedOutputCircuitInfoWithCP56Time2a) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
-
-        break;
-
-    /* 41 - 44 reserved */
-
-    case C_SC_NA_1: /* 45 */
-
-        elementSize = self->parameters->sizeOfIOA + 1;
-
-        retVal = (InformationObject) SingleCommand_getFromBuffer((SingleCommand) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-
-    case C_DC_NA_1: /* 46 */
-
-        elementSize = self->parameters->sizeOfIOA + 1;
-
-        retVal = (InformationObject) DoubleCommand_getFromBuffer((DoubleCommand) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_RC_NA_1: /* 47 */
-
-        elementSize = self->parameters->sizeOfIOA + 1;
-
-        retVal = (InformationObject) StepCommand_getFromBuffer((StepCommand) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_SE_NA_1: /* 48 - Set-point command, normalized value */
-
-        elementSize = self->parameters->sizeOfIOA + 3;
-
-        retVal = (InformationObject) SetpointCommandNormalized_getFromBuffer((SetpointCommandNormalized) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-
-    case C_SE_NB_1: /* 49 - Set-point command, scaled value */
-
-        elementSize = self->parameters->sizeOfIOA + 3;
-
-        retVal = (InformationObject) SetpointCommandScaled_getFromBuffer((SetpointCommandScaled) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_SE_NC_1: /* 50 - Set-point command, short floating point number */
-
-        elementSize = self->parameters->sizeOfIOA + 5;
-
-        retVal = (InformationObject) SetpointCommandShort_getFromBuffer((SetpointCommandShort) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_BO_NA_1: /* 51 - Bitstring command */
-
-        elementSize = self->parameters->sizeOfIOA + 4;
-
-        retVal = (InformationObject) Bitstring32Command_getFromBuffer((Bitstring32Command) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    /* 52 - 57 reserved */
-
-    case C_SC_TA_1: /* 58 - Single command with CP56Time2a */
-
-        elementSize = self->parameters->sizeOfIOA + 8;
-
-        retVal = (InformationObject) SingleCommandWithCP56Time2a_getFromBuffer((SingleCommandWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_DC_TA_1: /* 59 - Double command with CP56Time2a */
-
-        elementSize = self->parameters->sizeOfIOA + 8;
-
-        retVal = (InformationObject) DoubleCommandWithCP56Time2a_getFromBuffer((DoubleCommandWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_RC_TA_1: /* 60 - Step command with CP56Time2a */
-
-        elementSize = self->parameters->sizeOfIOA + 8;
-
-        retVal = (InformationObject) StepCommandWithCP56Time2a_getFromBuffer((StepCommandWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_SE_TA_1: /* 61 - Setpoint command, normalized value with CP56Time2a */
-
-        elementSize = self->parameters->sizeOfIOA + 10;
-
-        retVal = (InformationObject) SetpointCommandNormalizedWithCP56Time2a_getFromBuffer((SetpointCommandNormalizedWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_SE_TB_1: /* 62 - Setpoint command, scaled value with CP56Time2a */
-
-        elementSize = self->parameters->sizeOfIOA + 10;
-
-        retVal = (InformationObject) SetpointCommandScaledWithCP56Time2a_getFromBuffer((SetpointCommandScaledWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_SE_TC_1: /* 63 - Setpoint command, short value with CP56Time2a */
-
-        elementSize = self->parameters->sizeOfIOA + 12;
-
-        retVal = (InformationObject) SetpointCommandShortWithCP56Time2a_getFromBuffer((SetpointCommandShortWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case C_BO_TA_1: /* 64 - Bitstring command with CP56Time2a */
-
-        elementSize = self->parameters->sizeOfIOA + 11;
-
-        retVal = (InformationObject) Bitstring32CommandWithCP56Time2a_getFromBuffer((Bitstring32CommandWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case M_EI_NA_1: /* 70 - End of Initialization */
-
-        retVal = (InformationObject) EndOfInitialization_getFromBuffer((EndOfInitialization) io, self->parameters, self->payload, self->payloadSize,  0);
-
-        break;
-
-    case C_IC_NA_1: /* 100 - Interrogation command */
-
-        retVal = (InformationObject) InterrogationCommand_getFromBuffer((InterrogationCommand) io, self->parameters, self->payload, self->payloadSize,  0);
-
-        break;
-
-    case C_CI_NA_1: /* 101 - Counter interrogation command */
-
-        retVal = (InformationObject) CounterInterrogationCommand_getFromBuffer((CounterInterrogationCommand) io, self->parameters, self->payload, self->payloadSize,  0);
-
-        break;
-
-    case C_RD_NA_1: /* 102 - Read command */
-
-        retVal = (InformationObject) ReadCommand_getFromBuffer((ReadCommand) io, self->parameters, self->payload, self->payloadSize,  0);
-
-        break;
-
-    case C_CS_NA_1: /* 103 - Clock synchronization command */
-
-        retVal = (InformationObject) ClockSynchronizationCommand_getFromBuffer((ClockSynchronizationCommand) io, self->parameters, self->payload, self->payloadSize,  0);
-
-        break;
-
-    case C_TS_NA_1: /* 104 - Test command */
-
-        retVal = (InformationObject) TestCommand_getFromBuffer((TestCommand) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case C_RP_NA_1: /* 105 - Reset process command */
-
-        retVal = (InformationObject) ResetProcessCommand_getFromBuffer((ResetProcessCommand) io, self->parameters, self->payload, self->payloadSize,  0);
-
-        break;
-
-    case C_CD_NA_1: /* 106 - Delay acquisition command */
-
-        retVal = (InformationObject) DelayAcquisitionCommand_getFromBuffer((DelayAcquisitionCommand) io, self->parameters, self->payload, self->payloadSize,  0);
-
-        break;
-
-    case C_TS_TA_1: /* 107 - Test command with time */
-
-        retVal = (InformationObject) TestCommandWithCP56Time2a_getFromBuffer((TestCommandWithCP56Time2a) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case P_ME_NA_1: /* 110 - Parameter of measured values, normalized value */
-
-        elementSize = self->parameters->sizeOfIOA + 3;
-
-        retVal = (InformationObject) ParameterNormalizedValue_getFromBuffer((ParameterNormalizedValue) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case P_ME_NB_1: /* 111 - Parameter of measured values, scaled value */
-
-        elementSize = self->parameters->sizeOfIOA + 3;
-
-        retVal = (InformationObject) ParameterScaledValue_getFromBuffer((ParameterScaledValue) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case P_ME_NC_1: /* 112 - Parameter of measured values, short floating point number */
-
-        elementSize = self->parameters->sizeOfIOA + 5;
-
-        retVal = (InformationObject) ParameterFloatValue_getFromBuffer((ParameterFloatValue) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case P_AC_NA_1: /* 113 - Parameter for activation */
-
-        elementSize = self->parameters->sizeOfIOA + 1;
-
-        retVal = (InformationObject) ParameterActivation_getFromBuffer((ParameterActivation) io, self->parameters, self->payload, self->payloadSize,  index * elementSize);
-
-        break;
-
-    case F_FR_NA_1: /* 120 - File ready */
-
-        retVal = (InformationObject) FileReady_getFromBuffer((FileReady) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case F_SR_NA_1: /* 121 - Section ready */
-
-        retVal = (InformationObject) SectionReady_getFromBuffer((SectionReady) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case F_SC_NA_1: /* 122 - Call/Select directory/file/section */
-
-        retVal = (InformationObject) FileCallOrSelect_getFromBuffer((FileCallOrSelect) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case F_LS_NA_1: /* 123 - Last segment/section */
-
-        retVal = (InformationObject) FileLastSegmentOrSection_getFromBuffer((FileLastSegmentOrSection) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case F_AF_NA_1: /* 124 -  ACK file/section */
-
-        retVal = (InformationObject) FileACK_getFromBuffer((FileACK) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case F_SG_NA_1: /* 125 - File segment */
-
-        retVal = (InformationObject) FileSegment_getFromBuffer((FileSegment) io, self->parameters, self->payload, self->payloadSize, 0);
-
-        break;
-
-    case F_DR_TA_1: /* 126 - File directory */
+    }
+    else {
+        retVal = typeInfo->decode(io, self->parameters, self->payload, self->payloadSize,
+                index * (sizeOfIOA + typeInfo->elementSize), false);
+    }
 
-        elementSize = 13;
+    return retVal;
+}
 
-        if (CS101_ASDU_isSequence(self)) {
-            retVal  = (InformationObject) FileDirectory_getFromBuffer((FileDirectory) io, self->parameters,
-                    self->payload, self->payloadSize, self->parameters->sizeOfIOA + (index * elementSize), true);
+bool
+CS101_ASDU_forEachElement(CS101_ASDU self, CS101_ASDUElementHandler handler, void* parameter)
+{
+    union uInformationObject _io;
 
-            InformationObject_setObjectAddress(retVal, InformationObject_ParseObjectAddress(self->parameters, self->payload, 0) + index);
-        }
-        else
-            retVal  = (InformationObject) FileDirectory_getFromBuffer((FileDirectory) io, self->parameters,
-                    self->payload, self->payloadSize, index * (self->parameters->sizeOfIOA + elementSize), false);
+    int numberOfElements = CS101_ASDU_getNumberOfElements(self);
 
-        break;
+    int i;
 
-    case F_SC_NB_1: /* 127 - QueryLog */
+    for (i = 0; i < numberOfElements; i++) {
 
-        retVal = (InformationObject) QueryLog_getFromBuffer((QueryLog) io, self->parameters, self->payload, self->payloadSize, 0);
+        InformationObject io = CS101_ASDU_getElementEx(self, (InformationObject) &_io, i);
 
-        break;
+        if (io == NULL)
+            return false;
 
-    default:
-    	DEBUG_PRINT("type %d not supported\n", CS101_ASDU_getTypeID(self));
-    	break;
+        if (handler(parameter, self, i, io) == false)
+            return false;
     }
 
-    return retVal;
+    return true;
 }
 
 const char*
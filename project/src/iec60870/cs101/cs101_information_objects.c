@@ -6210,7 +6210,7 @@ TestCommand_getFromBuffer(TestCommand self, CS101_AppLayerParameters parameters,
         uint8_t* msg, int msgSize, int startIndex)
 {
     /* check message size */
-    int minSize = startIndex + 2;
+    int minSize = startIndex + parameters->sizeOfIOA + 2;
 
     if (minSize > msgSize) {
         DEBUG_PRINT("invalid ASDU - size too small\n");
@@ -7558,7 +7558,10 @@ FileDirectory_getFromBuffer(FileDirectory self, CS101_AppLayerParameters paramet
         uint8_t* msg, int msgSize, int startIndex, bool isSequence)
 {
     /* check message size */
-    int minSize = startIndex + parameters->sizeOfIOA + 13;
+    int minSize = startIndex + 13;
+
+    if (!isSequence)
+        minSize += parameters->sizeOfIOA;
 
     if (minSize > msgSize) {
         DEBUG_PRINT("invalid ASDU - size too small\n");
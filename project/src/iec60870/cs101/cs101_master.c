@@ -103,10 +103,15 @@ IBalancedApplicationLayer_HandleReceivedData (void* parameter, uint8_t* msg, boo
 
     CS101_ASDU asdu = CS101_ASDU_createFromBuffer(&(self->alParameters), msg + userDataStart, userDataLength);
 
-    if (self->asduReceivedHandler)
-        self->asduReceivedHandler(self->asduReceivedHandlerParameter, 0, asdu);
+    if (asdu) {
+        if (self->asduReceivedHandler)
+            self->asduReceivedHandler(self->asduReceivedHandlerParameter, 0, asdu);
 
-    CS101_ASDU_destroy(asdu);
+        CS101_ASDU_destroy(asdu);
+    }
+    else {
+        DEBUG_PRINT("CS101 master: Failed to parse ASDU\n");
+    }
 
     return true;
 }
@@ -141,10 +146,15 @@ IPrimaryApplicationLayer_UserData(void* parameter, int slaveAddress, uint8_t* ms
 
     CS101_ASDU asdu = CS101_ASDU_createFromBuffer(&(self->alParameters), msg + start, length);
 
-    if (self->asduReceivedHandler)
-        self->asduReceivedHandler(self->asduReceivedHandlerParameter, slaveAddress, asdu);
+    if (asdu) {
+        if (self->asduReceivedHandler)
+            self->asduReceivedHandler(self->asduReceivedHandlerParameter, slaveAddress, asdu);
 
-    CS101_ASDU_destroy(asdu);
+        CS101_ASDU_destroy(asdu);
+    }
+    else {
+        DEBUG_PRINT("CS101 master: Failed to parse ASDU\n");
+    }
 
 }
 
@@ -68,3 +68,95 @@ IMasterConnection_getPeerAddress(IMasterConnection self, char* addrBuf, int addr
     else
         return 0;
 }
+
+CS101_ASDUBuilder
+CS101_ASDUBuilder_initialize(CS101_ASDUBuilder self, IMasterConnection connection, bool isSequence, CS101_CauseOfTransmission cot, int oa, int ca)
+{
+    self->connection = connection;
+
+    self->asdu = CS101_ASDU_initializeStatic(&(self->staticAsdu), IMasterConnection_getApplicationLayerParameters(connection),
+            isSequence, cot, oa, ca, false, false);
+
+    return self;
+}
+
+bool
+CS101_ASDUBuilder_flush(CS101_ASDUBuilder self)
+{
+    if (CS101_ASDU_getNumberOfElements(self->asdu) == 0)
+        return true;
+
+    if (IMasterConnection_isReady(self->connection) == false)
+        return false;
+
+    if (IMasterConnection_sendASDU(self->connection, self->asdu) == false)
+        return false;
+
+    CS101_ASDU_removeAllElements(self->asdu);
+
+    return true;
+}
+
+bool
+CS101_ASDUBuilder_addInformationObject(CS101_ASDUBuilder self, InformationObject io)
+{
+    if (CS101_ASDU_addInformationObject(self->asdu, io))
+        return true;
+
+    /* the object doesn't fit into the current ASDU -> send it and start a new ASDU */
+    if (CS101_ASDU_getNumberOfElements(self->asdu) == 0)
+        return false;
+
+    if (CS101_ASDUBuilder_flush(self) == false)
+        return false;
+
+    return CS101_ASDU_addInformationObject(self->asdu, io);
+}
+
+int
+CS101_ASDUBuilder_addSinglePointSequence(CS101_ASDUBuilder self, int startIoa, const bool* values, const QualityDescriptor* qualities, int count)
+{
+    int added = 0;
+
+    while (added < count) {
+
+        int numberOfAdded = CS101_ASDU_addSinglePointSequence(self->asdu, startIoa + added, values + added,
+                qualities ? (qualities + added) : NULL, count - added);
+
+        if (numberOfAdded == 0) {
+            if (CS101_ASDU_getNumberOfElements(self->asdu) == 0)
+                break;
+
+            if (CS101_ASDUBuilder_flush(self) == false)
+                break;
+        }
+
+        added += numberOfAdded;
+    }
+
+    return added;
+}
+
+int
+CS101_ASDUBuilder_addScaledValueSequence(CS101_ASDUBuilder self, int startIoa, const int16_t* values, const QualityDescriptor* qualities, int count)
+{
+    int added = 0;
+
+    while (added < count) {
+
+        int numberOfAdded = CS101_ASDU_addScaledValueSequence(self->asdu, startIoa + added, values + added,
+                qualities ? (qualities + added) : NULL, count - added);
+
+        if (numberOfAdded == 0) {
+            if (CS101_ASDU_getNumberOfElements(self->asdu) == 0)
+                break;
+
+            if (CS101_ASDUBuilder_flush(self) == false)
+                break;
+        }
+
+        added += numberOfAdded;
+    }
+
+    return added;
+}
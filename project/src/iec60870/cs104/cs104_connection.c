@@ -89,8 +89,7 @@ struct sCS104_Connection {
     struct sCS104_APCIParameters parameters;
     struct sCS101_AppLayerParameters alParameters;
 
-    uint8_t recvBuffer[260];
-    int recvBufPos;
+    struct sT104RecvBuffer recvBuffer;
 
     int connectTimeoutInMs;
     uint8_t sMessage[6];
@@ -300,7 +299,7 @@ resetConnection(CS104_Connection self)
 #endif /* (CONFIG_USE_SEMAPHORES == 1) */
 
     self->connectTimeoutInMs = self->parameters.t0 * 1000;
-    self->recvBufPos = 0;
+    T104RecvBuffer_reset(&(self->recvBuffer));
 
     self->running = false;
     self->failure = false;
@@ -533,70 +532,35 @@ readFromSocket(CS104_Connection self, uint8_t* buffer, int size)
 }
 
 /**
- * \brief Read message part into receive buffer
+ * \brief Get the next received message, read from socket only when no complete message is buffered
  *
  * \return -1 in case of an error, 0 when no complete message can be read, > 0 when a complete message is in buffer
  */
 static int
-receiveMessage(CS104_Connection self)
+receiveMessage(CS104_Connection self, uint8_t** msg)
 {
-    uint8_t* buffer = self->recvBuffer;
-    int bufPos = self->recvBufPos;
+    int msgSize = T104RecvBuffer_nextMessage(&(self->recvBuffer), msg);
 
-    /* read start byte */
-    if (bufPos == 0) {
-        int readFirst = readFromSocket(self, buffer, 1);
-
-        if (readFirst < 1)
-            return readFirst;
-
-        if (buffer[0] != 0x68)
-            return -1; /* message error */
+    if (msgSize == 0)
+    {
+        int freeSpace;
 
-        bufPos++;
-    }
+        uint8_t* freeBuf = T104RecvBuffer_getFreeSpace(&(self->recvBuffer), &freeSpace);
 
-    /* read length byte */
-    if (bufPos == 1)  {
+        int readCnt = readFromSocket(self, freeBuf, freeSpace);
 
-        int readCnt = readFromSocket(self, buffer + 1, 1);
+        if (readCnt < 1)
+            return readCnt;
 
-        if (readCnt < 0) {
-            self->recvBufPos = 0;
-            return -1;
-        }
-        else if (readCnt == 0) {
-            self->recvBufPos = 1;
-            return 0;
-        }
+        T104RecvBuffer_commit(&(self->recvBuffer), readCnt);
 
-        bufPos++;
+        msgSize = T104RecvBuffer_nextMessage(&(self->recvBuffer), msg);
     }
 
-    /* read remaining frame */
-    if (bufPos > 1) {
-        int length = buffer[1];
+    if (msgSize == -1)
+        T104RecvBuffer_reset(&(self->recvBuffer));
 
-        int remainingLength = length - bufPos + 2;
-
-        int readCnt = readFromSocket(self, buffer + bufPos, remainingLength);
-
-        if (readCnt == remainingLength) {
-            self->recvBufPos = 0;
-            return length + 2;
-        }
-        else if (readCnt == -1) {
-            self->recvBufPos = 0;
-            return -1;
-        }
-        else {
-            self->recvBufPos = bufPos + readCnt;
-            return 0;
-        }
-    }
-
-    self->recvBufPos = bufPos;
-    return 0;
+    return msgSize;
 }
 
 static bool
@@ -929,26 +893,14 @@ handleConnection(void* parameter)
                     Handleset_addSocket(handleSet, self->socket);
 
                     if (Handleset_waitReady(handleSet, 100)) {
-                        int bytesRec = receiveMessage(self);
-
-                        if (bytesRec == -1) {
-                            loopRunning = false;
-
-#if (CONFIG_USE_SEMAPHORES == 1)
-                            Semaphore_wait(self->conStateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
-
-                            self->failure = true;
+                        uint8_t* msg;
+                        int bytesRec = 0;
 
-#if (CONFIG_USE_SEMAPHORES == 1)
-                            Semaphore_post(self->conStateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
-                        }
-
-                        if (bytesRec > 0) {
+                        /* handle all complete messages in the receive buffer */
+                        while (loopRunning && ((bytesRec = receiveMessage(self, &msg)) > 0)) {
 
                             if (self->rawMessageHandler)
-                                self->rawMessageHandler(self->rawMessageHandlerParameter, self->recvBuffer, bytesRec, false);
+                                self->rawMessageHandler(self->rawMessageHandlerParameter, msg, bytesRec, false);
 
 #if (CONFIG_USE_SEMAPHORES == 1)
                             Semaphore_wait(self->conStateLock);
@@ -956,7 +908,7 @@ handleConnection(void* parameter)
 
                             CS104_ConState oldState = self->conState;
 
-                            if (checkMessage(self, self->recvBuffer, bytesRec) == false)
+                            if (checkMessage(self, msg, bytesRec) == false)
                             {
                                 /* close connection on error */
                                 loopRunning = false;
@@ -978,19 +930,33 @@ handleConnection(void* parameter)
                                 else if (newState == STATE_INACTIVE)
                                     self->connectionHandler(self->connectionHandlerParameter, self, CS104_CONNECTION_STOPDT_CON_RECEIVED);
                             }
-                        }
 
 #if (CONFIG_USE_SEMAPHORES == 1)
-                        Semaphore_wait(self->conStateLock);
+                            Semaphore_wait(self->conStateLock);
 #endif /* (CONFIG_USE_SEMAPHORES == 1) */
 
-                        if ((self->unconfirmedReceivedIMessages >= self->parameters.w) || (self->conState == STATE_WAITING_FOR_STOPDT_CON)) {
-                            confirmOutstandingMessages(self);
+                            if ((self->unconfirmedReceivedIMessages >= self->parameters.w) || (self->conState == STATE_WAITING_FOR_STOPDT_CON)) {
+                                confirmOutstandingMessages(self);
+                            }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+                            Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
                         }
 
+                        if (bytesRec == -1) {
+                            loopRunning = false;
+
 #if (CONFIG_USE_SEMAPHORES == 1)
-                        Semaphore_post(self->conStateLock);
+                            Semaphore_wait(self->conStateLock);
 #endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+                            self->failure = true;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+                            Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+                        }
                     }
 
                     if (handleTimeouts(self) == false)
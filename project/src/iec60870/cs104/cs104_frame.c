@@ -22,6 +22,7 @@
 #include "cs104_frame.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 
 #include "frame.h"
@@ -208,3 +209,70 @@ T104Frame_getSpaceLeft(Frame super)
 
     return (IEC60870_5_104_MAX_ASDU_LENGTH + IEC60870_5_104_APCI_LENGTH - self->msgSize);
 }
+
+void
+T104RecvBuffer_reset(T104RecvBuffer self)
+{
+    self->startPos = 0;
+    self->endPos = 0;
+}
+
+uint8_t*
+T104RecvBuffer_getFreeSpace(T104RecvBuffer self, int* size)
+{
+    /* move the remaining data of a partial APDU to the start of the buffer */
+    if (self->startPos > 0)
+    {
+        int remaining = self->endPos - self->startPos;
+
+        if (remaining > 0)
+            memmove(self->buffer, self->buffer + self->startPos, remaining);
+
+        self->startPos = 0;
+        self->endPos = remaining;
+    }
+
+    *size = CONFIG_CS104_RECV_BUFFER_SIZE - self->endPos;
+
+    return self->buffer + self->endPos;
+}
+
+void
+T104RecvBuffer_commit(T104RecvBuffer self, int size)
+{
+    self->endPos += size;
+}
+
+int
+T104RecvBuffer_nextMessage(T104RecvBuffer self, uint8_t** msg)
+{
+    int available = self->endPos - self->startPos;
+
+    if (available < 1)
+        return 0;
+
+    uint8_t* buffer = self->buffer + self->startPos;
+
+    if (buffer[0] != 0x68)
+        return -1; /* message error */
+
+    if (available < 2)
+        return 0;
+
+    int msgSize = buffer[1] + 2;
+
+    if (available < msgSize)
+        return 0;
+
+    *msg = buffer;
+
+    self->startPos += msgSize;
+
+    if (self->startPos == self->endPos)
+    {
+        self->startPos = 0;
+        self->endPos = 0;
+    }
+
+    return msgSize;
+}
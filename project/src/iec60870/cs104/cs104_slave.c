@@ -34,6 +34,7 @@
 #include "hal_socket.h"
 #include "hal_thread.h"
 #include "hal_time.h"
+#include "hal_filesystem.h"
 #include "lib_memory.h"
 #include "linked_list.h"
 #include "buffer_frame.h"
@@ -53,6 +54,22 @@
 #error Illegal configuration: Define either CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP or CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP or CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS
 #endif
 
+#ifndef CONFIG_CS104_SEND_BUFFER_SIZE
+#define CONFIG_CS104_SEND_BUFFER_SIZE 2048
+#endif
+
+#ifndef CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE
+#define CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE 0
+#endif
+
+#ifndef CONFIG_CS104_PERSISTENT_QUEUE_SYNC_ENTRIES
+#define CONFIG_CS104_PERSISTENT_QUEUE_SYNC_ENTRIES 256
+#endif
+
+#ifndef CONFIG_CS104_PERSISTENT_QUEUE_SYNC_INTERVAL
+#define CONFIG_CS104_PERSISTENT_QUEUE_SYNC_INTERVAL 100
+#endif
+
 typedef enum {
     M_CON_STATE_STOPPED, /* only U frames allowed */
     M_CON_STATE_STARTED, /* U, I, S frames allowed */
@@ -61,6 +78,8 @@ typedef enum {
 
 typedef struct sMasterConnection* MasterConnection;
 
+typedef struct sEventLoopWorker* EventLoopWorker;
+
 static void
 MasterConnection_close(MasterConnection self);
 
@@ -76,6 +95,9 @@ MasterConnection_activate(MasterConnection self);
 static bool
 MasterConnection_isActive(MasterConnection self);
 
+static void
+MasterConnection_wakeup(MasterConnection self);
+
 
 #define CS104_DEFAULT_PORT 2404
 
@@ -109,6 +131,145 @@ typedef enum  {
     QUEUE_ENTRY_STATE_SENT_BUT_NOT_CONFIRMED
 } QueueEntryState;
 
+/***************************************************
+ * SharedASDUStore
+ ***************************************************/
+
+/* encoded ASDU that is referenced by the queues of all redundancy groups or connections */
+typedef struct sSharedASDU* SharedASDU;
+
+struct sSharedASDU {
+    int refCount; /* protected by store lock */
+    int size;
+    SharedASDU nextFree;
+    uint8_t msg[256 - IEC60870_5_104_APCI_LENGTH];
+};
+
+typedef struct sSharedASDUStore* SharedASDUStore;
+
+struct sSharedASDUStore {
+    SharedASDU freeList; /* released entries are kept for reuse until the store is destroyed */
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore storeLock;
+#endif
+};
+
+static SharedASDUStore
+SharedASDUStore_create(void)
+{
+    SharedASDUStore self = (SharedASDUStore) GLOBAL_MALLOC(sizeof(struct sSharedASDUStore));
+
+    if (self) {
+        self->freeList = NULL;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        self->storeLock = Semaphore_create(1);
+#endif
+    }
+
+    return self;
+}
+
+/* all queues referencing the store have to be destroyed before */
+static void
+SharedASDUStore_destroy(SharedASDUStore self)
+{
+    if (self) {
+        while (self->freeList) {
+            SharedASDU entry = self->freeList;
+
+            self->freeList = entry->nextFree;
+
+            GLOBAL_FREEMEM(entry);
+        }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_destroy(self->storeLock);
+#endif
+
+        GLOBAL_FREEMEM(self);
+    }
+}
+
+/**
+ * Encode an ASDU into the store. The caller owns one reference that has to be
+ * released with SharedASDUStore_release after the ASDU was added to the queues.
+ */
+static SharedASDU
+SharedASDUStore_add(SharedASDUStore self, CS101_ASDU asdu)
+{
+    int asduSize = asdu->asduHeaderLength + asdu->payloadSize;
+
+    if (asduSize > 256 - IEC60870_5_104_APCI_LENGTH)
+    {
+        DEBUG_PRINT("CS104 SLAVE: ASDU too large!\n");
+        return NULL;
+    }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->storeLock);
+#endif
+
+    SharedASDU entry = self->freeList;
+
+    if (entry)
+        self->freeList = entry->nextFree;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->storeLock);
+#endif
+
+    if (entry == NULL)
+        entry = (SharedASDU) GLOBAL_MALLOC(sizeof(struct sSharedASDU));
+
+    if (entry) {
+        struct sBufferFrame bufferFrame;
+
+        Frame frame = BufferFrame_initialize(&bufferFrame, entry->msg, 0);
+        CS101_ASDU_encode(asdu, frame);
+
+        entry->refCount = 1;
+        entry->size = asduSize;
+        entry->nextFree = NULL;
+    }
+
+    return entry;
+}
+
+static void
+SharedASDUStore_addReference(SharedASDUStore self, SharedASDU entry)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->storeLock);
+#endif
+
+    entry->refCount++;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->storeLock);
+#endif
+}
+
+static void
+SharedASDUStore_release(SharedASDUStore self, SharedASDU entry)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->storeLock);
+#endif
+
+    entry->refCount--;
+
+    if (entry->refCount == 0) {
+        entry->nextFree = self->freeList;
+        self->freeList = entry;
+    }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->storeLock);
+#endif
+}
+
 /***************************************************
  * MessageQueue
  ***************************************************/
@@ -117,6 +278,35 @@ struct sMessageQueueEntryInfo {
     uint64_t entryId;
     unsigned int entryState:2;
     unsigned int size:8;
+    unsigned int checksum:16; /* only used for persistent queues */
+};
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+
+#define PERSISTENT_QUEUE_MAGIC 0x34303149 /* "I104" */
+
+/* the queue buffer follows the header in the file */
+#define PERSISTENT_QUEUE_HEADER_SIZE 64
+
+/* queue state stored at the beginning of the file - entries are stored as offsets in the buffer or -1 */
+struct sMessageQueueFileHeader {
+    uint32_t magic;
+    int32_t bufferSize;
+    uint64_t entryId;
+    int32_t entryCounter;
+    int32_t firstEntry;
+    int32_t lastEntry;
+    int32_t lastInBufferEntry;
+};
+
+#endif /* (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1) */
+
+/* number of index slots checked for a data point before the home slot is overwritten */
+#define LATEST_VALUE_INDEX_PROBES 4
+
+struct sMessageQueueIndexEntry {
+    uint64_t entryId;
+    uint8_t* entryPtr;
 };
 
 struct sMessageQueue {
@@ -130,6 +320,24 @@ struct sMessageQueue {
     uint64_t entryId; /* ID of next entry; will be increased by one for each new entry */
     uint8_t* buffer;
 
+    SharedASDUStore store; /* when not NULL entries only hold a reference to an ASDU in the store */
+
+    /* waiting measured values by (CA, IOA, TypeID) - only used with CS104_QUEUE_POLICY_LATEST_VALUE */
+    struct sMessageQueueIndexEntry* latestValueIndex;
+    int latestValueIndexMask;
+    CS101_AppLayerParameters alParameters;
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    MemoryMappedFile file; /* when not NULL the buffer is mapped from this file */
+    int unsyncedChanges; /* number of changes since last sync of the file */
+    uint64_t lastSyncTime;
+#endif
+
+    /* started connections that found the queue empty - they are woken up by the next enqueue */
+    MasterConnection waitingConnections[CONFIG_CS104_MAX_CLIENT_CONNECTIONS];
+    int waitingConnectionsCount;
+
+
 #if (CONFIG_USE_SEMAPHORES == 1)
     Semaphore queueLock;
 #endif
@@ -137,6 +345,112 @@ struct sMessageQueue {
 
 typedef struct sMessageQueue* MessageQueue;
 
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+
+static int
+MessageQueue_getOffset(MessageQueue self, uint8_t* entryPtr)
+{
+    if (entryPtr)
+        return (int) (entryPtr - self->buffer);
+    else
+        return -1;
+}
+
+/* write the queue state to the file - caller has to hold the queue lock */
+static void
+MessageQueue_saveState(MessageQueue self)
+{
+    if (self->file) {
+        struct sMessageQueueFileHeader header;
+
+        memset(&header, 0, sizeof(struct sMessageQueueFileHeader));
+
+        header.magic = PERSISTENT_QUEUE_MAGIC;
+        header.bufferSize = self->size;
+        header.entryId = self->entryId;
+        header.entryCounter = self->entryCounter;
+        header.firstEntry = MessageQueue_getOffset(self, self->firstEntry);
+        header.lastEntry = MessageQueue_getOffset(self, self->lastEntry);
+        header.lastInBufferEntry = MessageQueue_getOffset(self, self->lastInBufferEntry);
+
+        memcpy(MemoryMappedFile_getBuffer(self->file), &header, sizeof(struct sMessageQueueFileHeader));
+
+        self->unsyncedChanges++;
+    }
+}
+
+/* Fletcher-16 checksum to detect entries that were not completely written to the file */
+static uint16_t
+calculateChecksum(uint8_t* data, int size)
+{
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    int i;
+
+    for (i = 0; i < size; i++) {
+        sum1 = (sum1 + data[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+
+    return (uint16_t) ((sum2 << 8) | sum1);
+}
+
+/* update the checksum after the ASDU was written to the entry - caller has to hold the queue lock */
+static void
+MessageQueue_setChecksum(MessageQueue self, uint8_t* entryPtr)
+{
+    if (self->file) {
+        struct sMessageQueueEntryInfo entryInfo;
+
+        memcpy(&entryInfo, entryPtr, sizeof(struct sMessageQueueEntryInfo));
+
+        entryInfo.checksum = calculateChecksum(entryPtr + sizeof(struct sMessageQueueEntryInfo), entryInfo.size);
+
+        memcpy(entryPtr, &entryInfo, sizeof(struct sMessageQueueEntryInfo));
+    }
+}
+
+/**
+ * Write the file to the storage device when enough changes are collected, when the last sync is
+ * too old, or when forced.
+ */
+static void
+MessageQueue_syncFile(MessageQueue self, bool force)
+{
+    bool syncRequired = false;
+
+    uint64_t currentTime = Hal_getMonotonicTimeInMs();
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->queueLock);
+#endif
+
+    if (self->unsyncedChanges > 0) {
+        if (force || (self->unsyncedChanges >= CONFIG_CS104_PERSISTENT_QUEUE_SYNC_ENTRIES) ||
+                (currentTime >= self->lastSyncTime + CONFIG_CS104_PERSISTENT_QUEUE_SYNC_INTERVAL))
+        {
+            syncRequired = true;
+
+            self->unsyncedChanges = 0;
+            self->lastSyncTime = currentTime;
+        }
+    }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->queueLock);
+#endif
+
+    /* the queue can be used while the file is written */
+    if (syncRequired) {
+        if (MemoryMappedFile_sync(self->file) == false)
+            DEBUG_PRINT("CS104 SLAVE: failed to sync persistent queue\n");
+    }
+}
+
+#endif /* (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1) */
+
 static void
 MessageQueue_initialize(MessageQueue self)
 {
@@ -146,16 +460,38 @@ MessageQueue_initialize(MessageQueue self)
     self->lastEntry = NULL;
     self->lastInBufferEntry = NULL;
     self->entryId = 1;
+
+    if (self->latestValueIndex)
+        memset(self->latestValueIndex, 0, (self->latestValueIndexMask + 1) * sizeof(struct sMessageQueueIndexEntry));
 }
 
+/**
+ * Create a queue for up to maxQueueSize ASDUs. When a store is given the queue
+ * only holds references to ASDUs that are shared with other queues.
+ */
 static MessageQueue
-MessageQueue_create(int maxQueueSize)
+MessageQueue_create(int maxQueueSize, SharedASDUStore store)
 {
     MessageQueue self = (MessageQueue) GLOBAL_MALLOC(sizeof(struct sMessageQueue));
 
     if (self) {
 
-        self->size = maxQueueSize * (sizeof(struct sMessageQueueEntryInfo) + 256);
+        if (store)
+            self->size = maxQueueSize * (sizeof(struct sMessageQueueEntryInfo) + sizeof(SharedASDU));
+        else
+            self->size = maxQueueSize * (sizeof(struct sMessageQueueEntryInfo) + 256);
+
+        self->store = store;
+
+        self->latestValueIndex = NULL;
+        self->latestValueIndexMask = 0;
+        self->alParameters = NULL;
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+        self->file = NULL;
+#endif
+
+        self->waitingConnectionsCount = 0;
 
         DEBUG_PRINT("CS104 SLAVE: event queue buffer size: %i bytes\n", self->size);
 
@@ -171,20 +507,67 @@ MessageQueue_create(int maxQueueSize)
     return self;
 }
 
+static void
+MessageQueue_releaseEntries(MessageQueue self);
+
 static void
 MessageQueue_destroy(MessageQueue self)
 {
     if (self != NULL) {
 
+        MessageQueue_releaseEntries(self);
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+        if (self->file)
+            MessageQueue_syncFile(self, true);
+#endif
+
 #if (CONFIG_USE_SEMAPHORES == 1)
         Semaphore_destroy(self->queueLock);
 #endif
 
-        GLOBAL_FREEMEM(self->buffer);
+        if (self->latestValueIndex)
+            GLOBAL_FREEMEM(self->latestValueIndex);
+
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+        if (self->file)
+            MemoryMappedFile_close(self->file);
+        else
+#endif
+            GLOBAL_FREEMEM(self->buffer);
+
         GLOBAL_FREEMEM(self);
     }
 }
 
+/**
+ * Use the CS104_QUEUE_POLICY_LATEST_VALUE policy for this queue. Has to be called before
+ * the first ASDU is enqueued.
+ */
+static void
+MessageQueue_enableLatestValuePolicy(MessageQueue self, CS101_AppLayerParameters alParameters)
+{
+    int maxEntries;
+    int indexSize = 1;
+
+    if (self->store)
+        maxEntries = self->size / (sizeof(struct sMessageQueueEntryInfo) + sizeof(SharedASDU));
+    else
+        maxEntries = self->size / (sizeof(struct sMessageQueueEntryInfo) + 256);
+
+    /* keep at least half of the index free so that probing is short */
+    while (indexSize < 2 * maxEntries)
+        indexSize = indexSize * 2;
+
+    self->latestValueIndex = (struct sMessageQueueIndexEntry*) GLOBAL_CALLOC(indexSize, sizeof(struct sMessageQueueIndexEntry));
+
+    if (self->latestValueIndex) {
+        self->latestValueIndexMask = indexSize - 1;
+        self->alParameters = alParameters;
+    }
+}
+
 static void
 MessageQueue_lock(MessageQueue self)
 {
@@ -219,8 +602,72 @@ MessageQueue_getEntryCount(MessageQueue self)
     return count;
 }
 
+/* drop the reference to the shared ASDU when an entry is removed from the queue */
+static void
+MessageQueue_releaseEntry(MessageQueue self, uint8_t* entryPtr)
+{
+    if (self->store) {
+        SharedASDU sharedAsdu;
+
+        memcpy(&sharedAsdu, entryPtr + sizeof(struct sMessageQueueEntryInfo), sizeof(SharedASDU));
+
+        SharedASDUStore_release(self->store, sharedAsdu);
+    }
+}
+
+static uint8_t*
+MessageQueue_getEntryData(MessageQueue self, uint8_t* entryPtr, int* size)
+{
+    if (self->store) {
+        SharedASDU sharedAsdu;
+
+        memcpy(&sharedAsdu, entryPtr + sizeof(struct sMessageQueueEntryInfo), sizeof(SharedASDU));
+
+        *size = sharedAsdu->size;
+
+        return sharedAsdu->msg;
+    }
+    else {
+        struct sMessageQueueEntryInfo entryInfo;
+
+        memcpy(&entryInfo, entryPtr, sizeof(struct sMessageQueueEntryInfo));
+
+        *size = entryInfo.size;
+
+        return entryPtr + sizeof(struct sMessageQueueEntryInfo);
+    }
+}
+
+/* release all entries of the queue - caller has to reset the queue afterwards */
+static void
+MessageQueue_releaseEntries(MessageQueue self)
+{
+    if ((self->store == NULL) || (self->entryCounter == 0))
+        return;
+
+    uint8_t* entryPtr = self->firstEntry;
+
+    struct sMessageQueueEntryInfo entryInfo;
+
+    while (entryPtr)
+    {
+        memcpy(&entryInfo, entryPtr, sizeof(struct sMessageQueueEntryInfo));
+
+        MessageQueue_releaseEntry(self, entryPtr);
+
+        if (entryPtr == self->lastEntry)
+            break;
+
+        /* move to next entry */
+        if (entryPtr == self->lastInBufferEntry)
+            entryPtr = self->buffer;
+        else
+            entryPtr = entryPtr + sizeof(struct sMessageQueueEntryInfo) + entryInfo.size;
+    }
+}
+
 static int
-MessageQueue_countEntriesUntilEndOfBuffer(MessageQueue self, uint8_t* firstEntry)
+MessageQueue_removeEntriesUntilEndOfBuffer(MessageQueue self, uint8_t* firstEntry)
 {
     int count = 0;
 
@@ -232,6 +679,8 @@ MessageQueue_countEntriesUntilEndOfBuffer(MessageQueue self, uint8_t* firstEntry
 
         memcpy(&entryInfo, entryPtr, sizeof(struct sMessageQueueEntryInfo));
 
+        MessageQueue_releaseEntry(self, entryPtr);
+
         count++;
 
         /* move to next entry */
@@ -245,24 +694,13 @@ MessageQueue_countEntriesUntilEndOfBuffer(MessageQueue self, uint8_t* firstEntry
 }
 
 /**
- * Add an ASDU to the queue. When queue is full, override oldest entry.
+ * Reserve a new entry with dataSize bytes of payload. When queue is full, override oldest entry.
+ * Caller has to hold the queue lock.
  */
-static void
-MessageQueue_enqueueASDU(MessageQueue self, CS101_ASDU asdu)
+static uint8_t*
+MessageQueue_addEntry(MessageQueue self, int dataSize)
 {
-    int asduSize = asdu->asduHeaderLength + asdu->payloadSize;
-
-    if (asduSize > 256 - IEC60870_5_104_APCI_LENGTH)
-    {
-        DEBUG_PRINT("CS104 SLAVE: ASDU too large!\n");
-        return;
-    }
-
-    int entrySize = sizeof(struct sMessageQueueEntryInfo) + asduSize;
-
-#if (CONFIG_USE_SEMAPHORES == 1)
-    Semaphore_wait(self->queueLock);
-#endif
+    int entrySize = sizeof(struct sMessageQueueEntryInfo) + dataSize;
 
     struct sMessageQueueEntryInfo entryInfo;
 
@@ -285,7 +723,7 @@ MessageQueue_enqueueASDU(MessageQueue self, CS101_ASDU asdu)
             /* remove all entries from last entry to end of buffer */
             if (nextMsgPtr <= self->firstEntry)
             {
-                self->entryCounter -=  MessageQueue_countEntriesUntilEndOfBuffer(self, self->firstEntry);
+                self->entryCounter -=  MessageQueue_removeEntriesUntilEndOfBuffer(self, self->firstEntry);
                 self->firstEntry = self->buffer;
             }
 
@@ -303,6 +741,8 @@ MessageQueue_enqueueASDU(MessageQueue self, CS101_ASDU asdu)
             {
                 self->entryCounter--;
 
+                MessageQueue_releaseEntry(self, self->firstEntry);
+
                 if (self->firstEntry == self->lastInBufferEntry)
                 {
                     self->firstEntry = self->buffer;
@@ -325,46 +765,360 @@ MessageQueue_enqueueASDU(MessageQueue self, CS101_ASDU asdu)
 
     self->entryCounter++;
 
-    struct sBufferFrame bufferFrame;
-
-    Frame frame = BufferFrame_initialize(&bufferFrame, nextMsgPtr + sizeof(struct sMessageQueueEntryInfo), 0);
-    CS101_ASDU_encode(asdu, frame);
-
-    entryInfo.size = asduSize;
+    entryInfo.size = dataSize;
     entryInfo.entryId = self->entryId++;
     entryInfo.entryState = QUEUE_ENTRY_STATE_WAITING_FOR_TRANSMISSION;
 
     memcpy(nextMsgPtr, &entryInfo, sizeof(struct sMessageQueueEntryInfo));
 
-    DEBUG_PRINT("CS104 SLAVE: ASDUs in FIFO: %i (new(size=%i/%i): %p, first: %p, last: %p lastInBuf: %p)\n", self->entryCounter, entrySize, asduSize, nextMsgPtr,
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    MessageQueue_saveState(self);
+#endif
+
+    DEBUG_PRINT("CS104 SLAVE: ASDUs in FIFO: %i (new(size=%i/%i): %p, first: %p, last: %p lastInBuf: %p)\n", self->entryCounter, entrySize, dataSize, nextMsgPtr,
              self->firstEntry, self->lastEntry, self->lastInBufferEntry);
 
-#if (CONFIG_USE_SEMAPHORES == 1)
-    Semaphore_post(self->queueLock);
-#endif
+    return nextMsgPtr;
 }
 
+/* only measured values without time tag are replaced by newer values */
 static bool
-MessageQueue_isAsduAvailable(MessageQueue self)
+isLatestValueASDU(CS101_AppLayerParameters parameters, uint8_t* msg, int msgSize)
 {
-#if (CONFIG_USE_SEMAPHORES == 1)
-    Semaphore_wait(self->queueLock);
+    switch (msg[0]) {
+    case M_ME_NA_1:
+    case M_ME_NB_1:
+    case M_ME_NC_1:
+    case M_ME_ND_1:
+        break;
+    default:
+        return false;
+    }
+
+    int numberOfElements = msg[1] & 0x7f;
+
+    if (numberOfElements == 0)
+        return false;
+
+    return (msgSize >= 2 + parameters->sizeOfCOT + parameters->sizeOfCA + parameters->sizeOfIOA);
+}
+
+/* hash of TypeID, CA and the first IOA */
+static uint32_t
+getDataPointHash(CS101_AppLayerParameters parameters, uint8_t* msg)
+{
+    int caPos = 2 + parameters->sizeOfCOT;
+    int i;
+
+    uint32_t hash = msg[0];
+
+    for (i = 0; i < parameters->sizeOfCA + parameters->sizeOfIOA; i++)
+        hash = (hash * 31) + msg[caPos + i];
+
+    hash = hash * 0x9E3779B1u;
+
+    return hash ^ (hash >> 16);
+}
+
+/* check if both ASDUs contain values of the same type for the same CA and IOAs */
+static bool
+isSameDataPoints(CS101_AppLayerParameters parameters, uint8_t* msg1, uint8_t* msg2, int msgSize)
+{
+    int caPos = 2 + parameters->sizeOfCOT;
+    int headerLength = caPos + parameters->sizeOfCA;
+
+    /* TypeID and VSQ */
+    if ((msg1[0] != msg2[0]) || (msg1[1] != msg2[1]))
+        return false;
+
+    if (memcmp(msg1 + caPos, msg2 + caPos, parameters->sizeOfCA))
+        return false;
+
+    int numberOfElements = msg1[1] & 0x7f;
+
+    /* SQ = 1 -> only the IOA of the first element is encoded */
+    if (msg1[1] & 0x80)
+        numberOfElements = 1;
+
+    int elementSize = (msgSize - headerLength) / numberOfElements;
+
+    int i;
+
+    for (i = 0; i < numberOfElements; i++) {
+        int ioaPos = headerLength + (i * elementSize);
+
+        if (memcmp(msg1 + ioaPos, msg2 + ioaPos, parameters->sizeOfIOA))
+            return false;
+    }
+
+    return true;
+}
+
+/* check if the entry is still in the queue and not yet sent */
+static bool
+MessageQueue_isWaitingEntry(MessageQueue self, uint8_t* entryPtr, uint64_t entryId)
+{
+    if ((entryPtr == NULL) || (self->entryCounter == 0))
+        return false;
+
+    struct sMessageQueueEntryInfo entryInfo;
+
+    memcpy(&entryInfo, self->firstEntry, sizeof(struct sMessageQueueEntryInfo));
+
+    /* entries in the queue have consecutive IDs starting with the first entry */
+    if ((entryId < entryInfo.entryId) || (entryId >= self->entryId))
+        return false;
+
+    memcpy(&entryInfo, entryPtr, sizeof(struct sMessageQueueEntryInfo));
+
+    return ((entryInfo.entryId == entryId) && (entryInfo.entryState == QUEUE_ENTRY_STATE_WAITING_FOR_TRANSMISSION));
+}
+
+/**
+ * Find a waiting entry with the same data points in the latest value index.
+ *
+ * \param waitingEntry returns the matching entry or NULL when there is none
+ *
+ * \return index slot of the matching entry or a slot that can be used for a new entry
+ */
+static struct sMessageQueueIndexEntry*
+MessageQueue_findLatestValue(MessageQueue self, uint8_t* msg, int msgSize, uint8_t** waitingEntry)
+{
+    struct sMessageQueueIndexEntry* freeSlot = NULL;
+
+    uint32_t hash = getDataPointHash(self->alParameters, msg);
+
+    int i;
+
+    *waitingEntry = NULL;
+
+    for (i = 0; i < LATEST_VALUE_INDEX_PROBES; i++) {
+        struct sMessageQueueIndexEntry* slot = &(self->latestValueIndex[(hash + i) & self->latestValueIndexMask]);
+
+        if (MessageQueue_isWaitingEntry(self, slot->entryPtr, slot->entryId)) {
+            int size;
+            uint8_t* data = MessageQueue_getEntryData(self, slot->entryPtr, &size);
+
+            if ((size == msgSize) && isSameDataPoints(self->alParameters, data, msg, msgSize)) {
+                *waitingEntry = slot->entryPtr;
+                return slot;
+            }
+        }
+        else if (freeSlot == NULL) {
+            freeSlot = slot;
+        }
+    }
+
+    /* all slots are in use by other data points -> lose the oldest index information */
+    if (freeSlot == NULL)
+        freeSlot = &(self->latestValueIndex[hash & self->latestValueIndexMask]);
+
+    return freeSlot;
+}
+
+/**
+ * Add an encoded ASDU to the queue. When queue is full, override oldest entry.
+ * Caller has to hold the queue lock.
+ */
+static void
+MessageQueue_insertEncodedASDU(MessageQueue self, uint8_t* msg, int msgSize)
+{
+    uint8_t* entryPtr = NULL;
+
+    if (self->latestValueIndex && isLatestValueASDU(self->alParameters, msg, msgSize))
+    {
+        struct sMessageQueueIndexEntry* slot = MessageQueue_findLatestValue(self, msg, msgSize, &entryPtr);
+
+        if (entryPtr == NULL) {
+            entryPtr = MessageQueue_addEntry(self, msgSize);
+
+            slot->entryPtr = entryPtr;
+            slot->entryId = self->entryId - 1;
+        }
+    }
+    else
+    {
+        entryPtr = MessageQueue_addEntry(self, msgSize);
+    }
+
+    memcpy(entryPtr + sizeof(struct sMessageQueueEntryInfo), msg, msgSize);
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    MessageQueue_setChecksum(self, entryPtr);
 #endif
+}
 
-    bool retVal;
+/**
+ * Add a reference to an ASDU of the store to the queue. The caller has to hold the queue lock
+ * and passes its reference to the queue.
+ */
+static void
+MessageQueue_insertSharedASDU(MessageQueue self, SharedASDU sharedAsdu)
+{
+    uint8_t* entryPtr = NULL;
 
-    if (self->entryCounter > 0)
-        retVal = true;
+    if (self->latestValueIndex && isLatestValueASDU(self->alParameters, sharedAsdu->msg, sharedAsdu->size))
+    {
+        struct sMessageQueueIndexEntry* slot = MessageQueue_findLatestValue(self, sharedAsdu->msg, sharedAsdu->size, &entryPtr);
+
+        if (entryPtr) {
+            /* replace the reference to the outdated value */
+            MessageQueue_releaseEntry(self, entryPtr);
+        }
+        else {
+            entryPtr = MessageQueue_addEntry(self, sizeof(SharedASDU));
+
+            slot->entryPtr = entryPtr;
+            slot->entryId = self->entryId - 1;
+        }
+    }
     else
-        retVal = false;
+    {
+        entryPtr = MessageQueue_addEntry(self, sizeof(SharedASDU));
+    }
 
-#if (CONFIG_USE_SEMAPHORES == 1)
-    Semaphore_post(self->queueLock);
+    memcpy(entryPtr + sizeof(struct sMessageQueueEntryInfo), &sharedAsdu, sizeof(SharedASDU));
+}
+
+/**
+ * Add an ASDU to the queue. When queue is full, override oldest entry.
+ */
+static void
+MessageQueue_enqueueASDU(MessageQueue self, CS101_ASDU asdu)
+{
+    int asduSize = asdu->asduHeaderLength + asdu->payloadSize;
+
+    if (asduSize > 256 - IEC60870_5_104_APCI_LENGTH)
+    {
+        DEBUG_PRINT("CS104 SLAVE: ASDU too large!\n");
+        return;
+    }
+
+    struct sBufferFrame bufferFrame;
+
+    MessageQueue_lock(self);
+
+    if (self->latestValueIndex)
+    {
+        uint8_t msg[256];
+
+        Frame frame = BufferFrame_initialize(&bufferFrame, msg, 0);
+        CS101_ASDU_encode(asdu, frame);
+
+        MessageQueue_insertEncodedASDU(self, msg, asduSize);
+    }
+    else
+    {
+        uint8_t* entryPtr = MessageQueue_addEntry(self, asduSize);
+
+        Frame frame = BufferFrame_initialize(&bufferFrame, entryPtr + sizeof(struct sMessageQueueEntryInfo), 0);
+        CS101_ASDU_encode(asdu, frame);
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+        MessageQueue_setChecksum(self, entryPtr);
+#endif
+    }
+
+    MessageQueue_unlock(self);
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    if (self->file)
+        MessageQueue_syncFile(self, false);
 #endif
+}
+
+/**
+ * Add a reference to an ASDU of the store to the queue. When queue is full, override oldest entry.
+ */
+static void
+MessageQueue_enqueueSharedASDU(MessageQueue self, SharedASDU sharedAsdu)
+{
+    SharedASDUStore_addReference(self->store, sharedAsdu);
+
+    MessageQueue_lock(self);
+
+    MessageQueue_insertSharedASDU(self, sharedAsdu);
+
+    MessageQueue_unlock(self);
+}
+
+/**
+ * Check if the queue holds ASDUs. When the queue is empty the connection is registered to be
+ * woken up by the next enqueue. Checking and registering under the queue lock ensures that no
+ * enqueue gets lost in between.
+ */
+static bool
+MessageQueue_isAsduAvailableOrWait(MessageQueue self, MasterConnection con)
+{
+    bool retVal = true;
+
+    MessageQueue_lock(self);
+
+    if (self->entryCounter == 0)
+    {
+        int i;
+
+        for (i = 0; i < self->waitingConnectionsCount; i++)
+        {
+            if (self->waitingConnections[i] == con)
+                break;
+        }
+
+        if ((i == self->waitingConnectionsCount) && (i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS))
+            self->waitingConnections[self->waitingConnectionsCount++] = con;
+
+        retVal = false;
+    }
+
+    MessageQueue_unlock(self);
 
     return retVal;
 }
 
+/* remove a closed connection from the waiting connections */
+static void
+MessageQueue_removeWaitingConnection(MessageQueue self, MasterConnection con)
+{
+    int i;
+
+    MessageQueue_lock(self);
+
+    for (i = 0; i < self->waitingConnectionsCount; i++)
+    {
+        if (self->waitingConnections[i] == con)
+        {
+            self->waitingConnections[i] = self->waitingConnections[--self->waitingConnectionsCount];
+            break;
+        }
+    }
+
+    MessageQueue_unlock(self);
+}
+
+/**
+ * Copy the waiting connections to connections and clear them.
+ *
+ * \return the number of waiting connections
+ */
+static int
+MessageQueue_takeWaitingConnections(MessageQueue self, MasterConnection* connections)
+{
+    int count;
+
+    MessageQueue_lock(self);
+
+    count = self->waitingConnectionsCount;
+
+    if (count > 0)
+        memcpy(connections, self->waitingConnections, count * sizeof(MasterConnection));
+
+    self->waitingConnectionsCount = 0;
+
+    MessageQueue_unlock(self);
+
+    return count;
+}
+
 static uint8_t*
 MessageQueue_getNextWaitingASDU(MessageQueue self, uint64_t* entryId, uint8_t** queueEntry, int* size)
 {
@@ -400,8 +1154,7 @@ MessageQueue_getNextWaitingASDU(MessageQueue self, uint64_t* entryId, uint8_t**
 
             memcpy(entryPtr, &entryInfo, sizeof(struct sMessageQueueEntryInfo));
 
-            buffer = entryPtr + sizeof(struct sMessageQueueEntryInfo);
-            *size = entryInfo.size;
+            buffer = MessageQueue_getEntryData(self, entryPtr, size);
         }
     }
 
@@ -489,11 +1242,17 @@ MessageQueue_releaseAllQueuedASDUs(MessageQueue self)
     Semaphore_wait(self->queueLock);
 #endif
 
+    MessageQueue_releaseEntries(self);
+
     self->firstEntry = NULL;
     self->lastEntry = NULL;
     self->lastInBufferEntry = NULL;
     self->entryCounter = 0;
 
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    MessageQueue_saveState(self);
+#endif
+
 #if (CONFIG_USE_SEMAPHORES == 1)
     Semaphore_post(self->queueLock);
 #endif
@@ -502,6 +1261,8 @@ MessageQueue_releaseAllQueuedASDUs(MessageQueue self)
 static void
 removeFirstEntry(MessageQueue self)
 {
+    MessageQueue_releaseEntry(self, self->firstEntry);
+
     if (self->firstEntry == self->lastInBufferEntry)
     {
         if (self->firstEntry == self->lastEntry)
@@ -524,6 +1285,10 @@ removeFirstEntry(MessageQueue self)
     }
 
     self->entryCounter--;
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    MessageQueue_saveState(self);
+#endif
 }
 
 static void
@@ -557,43 +1322,192 @@ MessageQueue_markAsduAsConfirmed(MessageQueue self, uint8_t* queueEntry, uint64_
     }
 }
 
-/***************************************************
- * HighPriorityASDUQueue
- ***************************************************/
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
 
-struct sHighPriorityASDUQueue {
-    int size; /* size of buffer in bytes */
-    int entryCounter; /* number of messages (ASDU) in the queue */
+/**
+ * Restore the queue state from the file. Entries are checked from the first entry on and
+ * the queue ends before the first entry that was not completely written.
+ *
+ * \return false when the file contains no valid queue
+ */
+static bool
+MessageQueue_restore(MessageQueue self)
+{
+    struct sMessageQueueFileHeader header;
 
-    uint8_t* firstEntry;
-    uint8_t* lastEntry;
-    uint8_t* lastInBufferEntry;
+    memcpy(&header, MemoryMappedFile_getBuffer(self->file), sizeof(struct sMessageQueueFileHeader));
 
-    uint8_t* buffer;
+    if ((header.magic != PERSISTENT_QUEUE_MAGIC) || (header.bufferSize != self->size) || (header.entryId == 0))
+        return false;
 
-#if (CONFIG_USE_SEMAPHORES == 1)
-    Semaphore queueLock;
-#endif
-};
+    self->entryId = header.entryId;
 
-typedef struct sHighPriorityASDUQueue* HighPriorityASDUQueue;
+    if (header.entryCounter <= 0)
+        return true;
 
-static void
-HighPriorityASDUQueue_initialize(HighPriorityASDUQueue self)
-{
-    self->entryCounter = 0;
+    int maxOffset = self->size - (int) sizeof(struct sMessageQueueEntryInfo);
 
-    self->firstEntry = NULL;
-    self->lastEntry = NULL;
-    self->lastInBufferEntry = NULL;
-}
+    if ((header.firstEntry < 0) || (header.firstEntry > maxOffset) ||
+            (header.lastEntry < 0) || (header.lastEntry > maxOffset) ||
+            (header.lastInBufferEntry < 0) || (header.lastInBufferEntry > maxOffset))
+        return true;
 
-static HighPriorityASDUQueue
-HighPriorityASDUQueue_create(int maxQueueSize)
-{
-    HighPriorityASDUQueue self = (HighPriorityASDUQueue) GLOBAL_MALLOC(sizeof(struct sHighPriorityASDUQueue));
+    uint8_t* entryPtr = self->buffer + header.firstEntry;
+    uint8_t* lastEntry = NULL;
+    uint64_t lastEntryId = 0;
+    bool wrapped = false;
+    int count = 0;
 
-    if (self) {
+    while (count < header.entryCounter)
+    {
+        struct sMessageQueueEntryInfo entryInfo;
+
+        memcpy(&entryInfo, entryPtr, sizeof(struct sMessageQueueEntryInfo));
+
+        if ((entryInfo.size == 0) || (entryPtr + sizeof(struct sMessageQueueEntryInfo) + entryInfo.size > self->buffer + self->size))
+            break;
+
+        if (entryInfo.checksum != calculateChecksum(entryPtr + sizeof(struct sMessageQueueEntryInfo), entryInfo.size))
+            break;
+
+        if (lastEntry && (entryInfo.entryId != lastEntryId + 1))
+            break;
+
+        lastEntry = entryPtr;
+        lastEntryId = entryInfo.entryId;
+        count++;
+
+        if (entryPtr == self->buffer + header.lastEntry)
+            break;
+
+        /* move to next entry */
+        if (entryPtr == self->buffer + header.lastInBufferEntry) {
+            entryPtr = self->buffer;
+            wrapped = true;
+        }
+        else
+            entryPtr = entryPtr + sizeof(struct sMessageQueueEntryInfo) + entryInfo.size;
+    }
+
+    if (count > 0) {
+        self->entryCounter = count;
+        self->firstEntry = self->buffer + header.firstEntry;
+        self->lastEntry = lastEntry;
+
+        if (wrapped)
+            self->lastInBufferEntry = self->buffer + header.lastInBufferEntry;
+        else
+            self->lastInBufferEntry = lastEntry;
+
+        /* entry IDs in the queue have to be consecutive */
+        self->entryId = lastEntryId + 1;
+    }
+
+    if (count < header.entryCounter) {
+        DEBUG_PRINT("CS104 SLAVE: persistent queue: %i of %i entries restored\n", count, header.entryCounter);
+    }
+
+    return true;
+}
+
+/**
+ * Create a queue that is stored in a memory mapped file. ASDUs that are still in the file
+ * from a previous run are sent again.
+ *
+ * \return the new queue or NULL when the file cannot be used
+ */
+static MessageQueue
+MessageQueue_createPersistent(int maxQueueSize, const char* filename)
+{
+    MessageQueue self = (MessageQueue) GLOBAL_MALLOC(sizeof(struct sMessageQueue));
+
+    if (self) {
+
+        self->size = maxQueueSize * (sizeof(struct sMessageQueueEntryInfo) + 256);
+
+        self->file = MemoryMappedFile_open(filename, PERSISTENT_QUEUE_HEADER_SIZE + self->size);
+
+        if (self->file == NULL) {
+            DEBUG_PRINT("CS104 SLAVE: cannot open persistent queue file %s\n", filename);
+
+            GLOBAL_FREEMEM(self);
+            return NULL;
+        }
+
+        self->buffer = MemoryMappedFile_getBuffer(self->file) + PERSISTENT_QUEUE_HEADER_SIZE;
+
+        self->store = NULL;
+        self->latestValueIndex = NULL;
+        self->latestValueIndexMask = 0;
+        self->alParameters = NULL;
+        self->unsyncedChanges = 0;
+        self->lastSyncTime = Hal_getMonotonicTimeInMs();
+        self->waitingConnectionsCount = 0;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        self->queueLock = Semaphore_create(1);
+#endif
+
+        MessageQueue_initialize(self);
+
+        if (MessageQueue_restore(self) == false) {
+            DEBUG_PRINT("CS104 SLAVE: no valid queue in file %s -> create new queue\n", filename);
+
+            MessageQueue_initialize(self);
+        }
+
+        DEBUG_PRINT("CS104 SLAVE: persistent queue with %i ASDUs\n", self->entryCounter);
+
+        MessageQueue_saveState(self);
+
+        /* ASDUs that were sent but not confirmed before have to be sent again */
+        MessageQueue_setWaitingForTransmissionWhenNotConfirmed(self);
+
+        MessageQueue_syncFile(self, true);
+    }
+
+    return self;
+}
+
+#endif /* (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1) */
+
+/***************************************************
+ * HighPriorityASDUQueue
+ ***************************************************/
+
+struct sHighPriorityASDUQueue {
+    int size; /* size of buffer in bytes */
+    int entryCounter; /* number of messages (ASDU) in the queue */
+
+    uint8_t* firstEntry;
+    uint8_t* lastEntry;
+    uint8_t* lastInBufferEntry;
+
+    uint8_t* buffer;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore queueLock;
+#endif
+};
+
+typedef struct sHighPriorityASDUQueue* HighPriorityASDUQueue;
+
+static void
+HighPriorityASDUQueue_initialize(HighPriorityASDUQueue self)
+{
+    self->entryCounter = 0;
+
+    self->firstEntry = NULL;
+    self->lastEntry = NULL;
+    self->lastInBufferEntry = NULL;
+}
+
+static HighPriorityASDUQueue
+HighPriorityASDUQueue_create(int maxQueueSize)
+{
+    HighPriorityASDUQueue self = (HighPriorityASDUQueue) GLOBAL_MALLOC(sizeof(struct sHighPriorityASDUQueue));
+
+    if (self) {
 
         self->size = maxQueueSize * (sizeof(uint16_t) + 256);
 
@@ -951,13 +1865,14 @@ struct sCS104_RedundancyGroup {
 
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1)
 static void
-CS104_RedundancyGroup_initializeMessageQueues(CS104_RedundancyGroup self, int lowPrioMaxQueueSize, int highPrioMaxQueueSize)
+CS104_RedundancyGroup_initializeMessageQueues(CS104_RedundancyGroup self, int lowPrioMaxQueueSize, int highPrioMaxQueueSize,
+        SharedASDUStore asduStore)
 {
     /* initialized low priority queue */
     if (lowPrioMaxQueueSize < 1)
         lowPrioMaxQueueSize = CONFIG_CS104_MESSAGE_QUEUE_SIZE;
 
-    self->asduQueue = MessageQueue_create(lowPrioMaxQueueSize);
+    self->asduQueue = MessageQueue_create(lowPrioMaxQueueSize, asduStore);
 
     /* initialize high priority queue */
     if (highPrioMaxQueueSize < 1)
@@ -1070,6 +1985,77 @@ CS104_RedundancyGroup_isCatchAll(CS104_RedundancyGroup self)
 }
 
 
+/***************************************************
+ * TimerWheel
+ ***************************************************/
+
+/* a round of the timer wheel has CS104_TIMER_WHEEL_SLOTS * CS104_TIMER_WHEEL_TICK ms */
+#define CS104_TIMER_WHEEL_SLOTS 256
+#define CS104_TIMER_WHEEL_TICK 10
+
+/*
+ * Connections handled by a single thread (event loop and threadless mode) are put into the slot
+ * of their next timeout. Only the slots of the elapsed ticks have to be checked. Timeouts of later
+ * rounds stay in their slot. When a timeout is postponed (e.g. T3 reset) the connection is not moved,
+ * it is checked at the old timeout and put into the slot of the new timeout then.
+ */
+struct sTimerWheel {
+    MasterConnection slots[CS104_TIMER_WHEEL_SLOTS];
+    uint64_t currentTick; /* last checked tick */
+    bool isStarted;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore lock;
+#endif
+};
+
+static void
+TimerWheel_init(struct sTimerWheel* self)
+{
+    memset(self->slots, 0, sizeof(self->slots));
+
+    self->currentTick = 0;
+    self->isStarted = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    self->lock = Semaphore_create(1);
+#endif
+}
+
+static void
+TimerWheel_destroy(struct sTimerWheel* self)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_destroy(self->lock);
+#endif
+}
+
+/***************************************************
+ * EventLoopWorker
+ ***************************************************/
+
+/*
+ * An event loop thread. With more than one thread each has its own listening socket bound
+ * to the same port (SO_REUSEPORT) and handles the connections accepted by this socket.
+ */
+struct sEventLoopWorker {
+    CS104_Slave slave;
+
+    int cpu; /* CPU core of the thread or -1 */
+    Thread thread; /* NULL for the first worker that runs in the listening thread */
+
+    ServerSocket serverSocket;
+    SocketPoller poller;
+
+    WakeupEvent wakeupEvent; /* wakes up the worker when ASDUs are waiting for transmission */
+    bool wakeupSignaled; /* protected by stateLock of the slave */
+
+    struct sTimerWheel timerWheel; /* timeouts of the connections of the worker */
+
+    int numberOfConnections;
+    MasterConnection connections[CONFIG_CS104_MAX_CLIENT_CONNECTIONS];
+};
+
 /***************************************************
  * Slave
  ***************************************************/
@@ -1114,18 +2100,30 @@ struct sCS104_Slave {
     HighPriorityASDUQueue connectionAsduQueue; /**< high priority ASDU queue */
 #endif
 
+    SharedASDUStore asduStore; /**< encoded ASDUs referenced by the low priority queues of all groups/connections */
+
     int maxLowPrioQueueSize;
     int maxHighPrioQueueSize;
 
     int openConnections; /**< number of connected clients */
     MasterConnection masterConnections[CONFIG_CS104_MAX_CLIENT_CONNECTIONS]; /**< references to all MasterConnection objects */
 
+    struct sTimerWheel timerWheel; /**< timeouts of the connections in threadless mode */
+
 #if (CONFIG_USE_SEMAPHORES == 1)
     Semaphore openConnectionsLock;
 #endif
 
 #if (CONFIG_USE_THREADS == 1)
     bool isThreadlessMode;
+    bool isEventLoopMode;
+
+    int eventLoopThreads; /**< number of event loop threads */
+    bool eventLoopCpuAffinity; /**< bind event loop thread i to CPU core i */
+
+    EventLoopWorker workers; /**< event loop threads, kept until the slave is destroyed */
+    int maxWorkers; /**< number of allocated workers */
+    int numberOfWorkers; /**< number of running workers */
 #endif
 
     int maxOpenConnections; /**< maximum accepted open client connections */
@@ -1150,8 +2148,14 @@ struct sCS104_Slave {
 
     CS104_ServerMode serverMode;
 
+    CS104_QueuePolicy queuePolicy;
+
     char* localAddress;
 
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    char* persistentQueueFile;
+#endif
+
 #if (CONFIG_USE_THREADS == 1)
     Thread listeningThread;
 #endif
@@ -1188,8 +2192,8 @@ struct sMasterConnection {
     unsigned int timeoutT2Triggered:1;
     unsigned int waitingForTestFRcon:1;
     uint16_t maxSentASDUs; /* k-parameter */
-    int16_t  oldestSentASDU; /* oldest sent ASDU in k-buffer */
-    int16_t  newestSentASDU; /* newest sent ASDU in k-buffer */
+    uint16_t oldestSentASDU; /* index of oldest sent ASDU in k-buffer */
+    uint16_t sentASDUsCount; /* number of unconfirmed sent ASDUs in k-buffer */
     uint16_t sendCount;     /* sent messages - sequence counter */
     uint16_t receiveCount;  /* received messages - sequence counter */
 
@@ -1201,6 +2205,16 @@ struct sMasterConnection {
     uint64_t nextT3Timeout;
     uint64_t nextTestFRConTimeout; /* timeout T1 when waiting for TEST FR con */
 
+    uint64_t nextTimeout; /* earliest timeout of T1, T2, T3 - protected by stateLock */
+
+    /* list of the timer wheel slot - protected by the timer wheel lock */
+    MasterConnection timerNext;
+    MasterConnection timerPrev;
+    uint64_t timerTimeout;
+    bool isTimerScheduled;
+
+    EventLoopWorker worker; /* event loop thread handling the connection or NULL */
+
     SentASDUSlave* sentASDUs;
 
 #if (CONFIG_USE_THREADS == 1) 
@@ -1214,11 +2228,21 @@ struct sMasterConnection {
 
     HandleSet handleSet;
 
-    uint8_t recvBuffer[260];
-    int recvBufPos;
+    WakeupEvent wakeupEvent; /* signaled when ASDUs are waiting for transmission */
+    bool wakeupSignaled; /* protected by stateLock */
+
+    struct sT104RecvBuffer recvBuffer;
 
     uint8_t sendBuffer[260];
 
+    /*
+     * I messages collected while sending waiting ASDUs, written to the socket at once. Bytes the
+     * socket did not accept stay in the buffer and are written before any other message.
+     */
+    uint8_t txBuffer[CONFIG_CS104_SEND_BUFFER_SIZE];
+    int txBufPos; /* protected by stateLock */
+    bool txBatching; /* protected by stateLock */
+
     MessageQueue lowPrioQueue;
     HighPriorityASDUQueue highPrioQueue;
 
@@ -1243,15 +2267,32 @@ static uint8_t TESTFR_ACT_MSG[] = { 0x68, 0x04, 0x43, 0x00, 0x00, 0x00 };
 
 #define TESTFR_ACT_MSG_SIZE 6
 
+/* free space of the transmit buffer required to send an I message (maximum APDU and four S or U messages) */
+#define TX_BUFFER_APDU_SPACE (255 + 4 * 6)
+
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1)
 static void
 initializeMessageQueues(CS104_Slave self, int lowPrioMaxQueueSize, int highPrioMaxQueueSize)
 {
+    /* queues are kept when the server is restarted */
+    if (self->asduQueue)
+        return;
+
     /* initialized low priority queue */
     if (lowPrioMaxQueueSize < 1)
         lowPrioMaxQueueSize = CONFIG_CS104_MESSAGE_QUEUE_SIZE;
 
-    self->asduQueue = MessageQueue_create(lowPrioMaxQueueSize);
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    if (self->persistentQueueFile)
+        self->asduQueue = MessageQueue_createPersistent(lowPrioMaxQueueSize, self->persistentQueueFile);
+
+    /* fall back to queue in memory */
+    if (self->asduQueue == NULL)
+#endif
+        self->asduQueue = MessageQueue_create(lowPrioMaxQueueSize, NULL);
+
+    if (self->asduQueue && (self->queuePolicy == CS104_QUEUE_POLICY_LATEST_VALUE))
+        MessageQueue_enableLatestValuePolicy(self->asduQueue, &(self->alParameters));
 
     /* initialize high priority queue */
     if (highPrioMaxQueueSize < 1)
@@ -1267,8 +2308,14 @@ initializeConnectionSpecificQueues(CS104_Slave self)
 {
     int i;
 
+    if (self->asduStore == NULL)
+        self->asduStore = SharedASDUStore_create();
+
     for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++) {
-        self->masterConnections[i]->lowPrioQueue = MessageQueue_create(self->maxLowPrioQueueSize);
+        self->masterConnections[i]->lowPrioQueue = MessageQueue_create(self->maxLowPrioQueueSize, self->asduStore);
+
+        if (self->masterConnections[i]->lowPrioQueue && (self->queuePolicy == CS104_QUEUE_POLICY_LATEST_VALUE))
+            MessageQueue_enableLatestValuePolicy(self->masterConnections[i]->lowPrioQueue, &(self->alParameters));
         self->masterConnections[i]->highPrioQueue = HighPriorityASDUQueue_create(self->maxHighPrioQueueSize);
     }
 }
@@ -1381,6 +2428,9 @@ createSlave(int maxLowPrioQueueSize, int maxHighPrioQueueSize)
         }
 
         self->maxOpenConnections = CONFIG_CS104_MAX_CLIENT_CONNECTIONS;
+
+        TimerWheel_init(&(self->timerWheel));
+
 #if (CONFIG_USE_SEMAPHORES == 1)
         self->openConnectionsLock = Semaphore_create(1);
         self->stateLock = Semaphore_create(1);
@@ -1388,12 +2438,23 @@ createSlave(int maxLowPrioQueueSize, int maxHighPrioQueueSize)
 
 #if (CONFIG_USE_THREADS == 1)
         self->isThreadlessMode = false;
+        self->isEventLoopMode = false;
+
+        self->eventLoopThreads = 1;
+        self->eventLoopCpuAffinity = false;
+        self->workers = NULL;
+        self->maxWorkers = 0;
+        self->numberOfWorkers = 0;
 #endif
 
         self->isRunning = false;
         self->stopRunning = false;
 
         self->localAddress = NULL;
+
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+        self->persistentQueueFile = NULL;
+#endif
         self->tcpPort = CS104_DEFAULT_PORT;
         self->openConnections = 0;
 
@@ -1405,6 +2466,10 @@ createSlave(int maxLowPrioQueueSize, int maxHighPrioQueueSize)
 
         self->plugins = NULL;
 
+        self->asduStore = NULL;
+
+        self->queuePolicy = CS104_QUEUE_POLICY_FIFO;
+
 #if (CONFIG_CS104_SUPPORT_TLS == 1)
         self->tlsConfig = NULL;
 #endif
@@ -1462,6 +2527,72 @@ CS104_Slave_setServerMode(CS104_Slave self, CS104_ServerMode serverMode)
     self->serverMode = serverMode;
 }
 
+void
+CS104_Slave_setQueuePolicy(CS104_Slave self, CS104_QueuePolicy queuePolicy)
+{
+    self->queuePolicy = queuePolicy;
+}
+
+void
+CS104_Slave_setEventLoopThreads(CS104_Slave self, int numberOfThreads)
+{
+#if (CONFIG_USE_THREADS == 1)
+    if (numberOfThreads < 1)
+        numberOfThreads = 1;
+
+    self->eventLoopThreads = numberOfThreads;
+#else
+    (void)self;
+    (void)numberOfThreads;
+#endif
+}
+
+void
+CS104_Slave_setEventLoopCpuAffinity(CS104_Slave self, bool enable)
+{
+#if (CONFIG_USE_THREADS == 1)
+    self->eventLoopCpuAffinity = enable;
+#else
+    (void)self;
+    (void)enable;
+#endif
+}
+
+void
+CS104_Slave_setPersistentQueue(CS104_Slave self, const char* filename)
+{
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+    if (self->persistentQueueFile)
+        GLOBAL_FREEMEM(self->persistentQueueFile);
+
+    if (filename)
+        self->persistentQueueFile = strdup(filename);
+    else
+        self->persistentQueueFile = NULL;
+#else
+    (void)self;
+    (void)filename;
+#endif
+}
+
+static void
+syncPersistentQueue(CS104_Slave self, bool force)
+{
+#if ((CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1) && (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1))
+    if ((self->serverMode == CS104_MODE_SINGLE_REDUNDANCY_GROUP) && self->asduQueue && self->asduQueue->file)
+        MessageQueue_syncFile(self->asduQueue, force);
+#else
+    (void)self;
+    (void)force;
+#endif
+}
+
+void
+CS104_Slave_syncPersistentQueue(CS104_Slave self)
+{
+    syncPersistentQueue(self, true);
+}
+
 void
 CS104_Slave_setLocalAddress(CS104_Slave self, const char* ipAddress)
 {
@@ -1499,7 +2630,7 @@ CS104_Slave_getOpenConnections(CS104_Slave self)
 }
 
 static MasterConnection
-getFreeConnection(CS104_Slave self)
+getFreeConnection(CS104_Slave self, EventLoopWorker worker)
 {
     MasterConnection connection = NULL;
 
@@ -1517,6 +2648,7 @@ getFreeConnection(CS104_Slave self)
             if (con->isUsed == false) {
                 connection = con;
                 connection->isUsed = true;
+                connection->worker = worker;
             }
 
 #if (CONFIG_USE_SEMAPHORES)
@@ -1680,118 +2812,260 @@ CS104_Slave_getAppLayerParameters(CS104_Slave self)
  * MasterConnection
  *********************************************************/
 
+/* caller has to hold the timer wheel lock */
 static void
-printSendBuffer(MasterConnection self)
+TimerWheel_unlink(struct sTimerWheel* self, MasterConnection con)
 {
-    if (self->oldestSentASDU != -1) {
-        int currentIndex = self->oldestSentASDU;
-
-        int nextIndex = 0;
-
-        DEBUG_PRINT ("CS104 SLAVE: ------k-buffer------\n");
-
-        do {
-            DEBUG_PRINT("CS104 SLAVE: %02i : SeqNo=%i time=%llu : queueEntry=%p\n", currentIndex,
-                    self->sentASDUs[currentIndex].seqNo,
-                    self->sentASDUs[currentIndex].sentTime,
-                    self->sentASDUs[currentIndex].queueEntry);
-
-            if (currentIndex == self->newestSentASDU)
-                nextIndex = -1;
-            else
-                currentIndex = (currentIndex + 1) % self->maxSentASDUs;
+    if (con->timerPrev)
+        con->timerPrev->timerNext = con->timerNext;
+    else
+        self->slots[(con->timerTimeout / CS104_TIMER_WHEEL_TICK) % CS104_TIMER_WHEEL_SLOTS] = con->timerNext;
 
-        } while (nextIndex != -1);
+    if (con->timerNext)
+        con->timerNext->timerPrev = con->timerPrev;
 
-        DEBUG_PRINT ("CS104 SLAVE: --------------------\n");
-    }
-    else
-        DEBUG_PRINT("CS104 SLAVE: k-buffer is empty\n");
+    con->timerNext = NULL;
+    con->timerPrev = NULL;
+    con->isTimerScheduled = false;
 }
 
 /**
- * \return number of bytes read, or -1 in case of an error
+ * Schedule a check of the connection timeouts. When the connection is already scheduled the earlier time is used.
  */
-static int
-readFromSocket(MasterConnection self, uint8_t* buffer, int size)
+static void
+TimerWheel_schedule(struct sTimerWheel* self, MasterConnection con, uint64_t timeout)
 {
-#if (CONFIG_CS104_SUPPORT_TLS == 1)
-    if (self->tlsSocket != NULL)
-        return TLSSocket_read(self->tlsSocket, buffer, size);
-    else
-        return Socket_read(self->socket, buffer, size);
-#else
-    return Socket_read(self->socket, buffer, size);
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->lock);
 #endif
-}
-
-/**
- * \brief Read message part into receive buffer
- *
- * \return -1 in case of an error, 0 when no complete message can be read, > 0 when a complete message is in buffer
- */
-static int
-receiveMessage(MasterConnection self)
-{
-    uint8_t* buffer = self->recvBuffer;
-    int bufPos = self->recvBufPos;
 
-    /* read start byte */
-    if (bufPos == 0) {
-        int readFirst = readFromSocket(self, buffer, 1);
+    if (con->isTimerScheduled)
+    {
+        if (timeout >= con->timerTimeout)
+            goto exit_function;
 
-        if (readFirst < 1)
-            return readFirst;
+        TimerWheel_unlink(self, con);
+    }
 
-        if (buffer[0] != 0x68)
-            return -1; /* message error */
+    /* timeouts that are already expired are checked with the current tick */
+    if (self->isStarted && (timeout < self->currentTick * CS104_TIMER_WHEEL_TICK))
+        timeout = self->currentTick * CS104_TIMER_WHEEL_TICK;
 
-        bufPos++;
-    }
+    int slot = (timeout / CS104_TIMER_WHEEL_TICK) % CS104_TIMER_WHEEL_SLOTS;
 
-    /* read length byte */
-    if (bufPos == 1)  {
-        if (readFromSocket(self, buffer + 1, 1) != 1) {
-            self->recvBufPos = 0;
-            return -1;
-        }
+    con->timerTimeout = timeout;
+    con->timerPrev = NULL;
+    con->timerNext = self->slots[slot];
 
-        bufPos++;
-    }
+    if (con->timerNext)
+        con->timerNext->timerPrev = con;
 
-    /* read remaining frame */
-    if (bufPos > 1) {
-        int length = buffer[1];
+    self->slots[slot] = con;
+    con->isTimerScheduled = true;
 
-        int remainingLength = length - bufPos + 2;
+exit_function:
 
-        int readCnt = readFromSocket(self, buffer + bufPos, remainingLength);
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->lock);
+#endif
+    return;
+}
 
-        if (readCnt == remainingLength) {
-            self->recvBufPos = 0;
-            return length + 2;
-        }
-        else if (readCnt == -1) {
-            self->recvBufPos = 0;
-            return -1;
+static void
+TimerWheel_cancel(struct sTimerWheel* self, MasterConnection con)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->lock);
+#endif
+
+    if (con->isTimerScheduled)
+        TimerWheel_unlink(self, con);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->lock);
+#endif
+}
+
+/**
+ * Remove the connections with expired timeouts from the wheel
+ *
+ * \param expired array for the expired connections (one entry for each connection)
+ *
+ * \return number of expired connections
+ */
+static int
+TimerWheel_getExpired(struct sTimerWheel* self, uint64_t currentTime, MasterConnection* expired)
+{
+    int expiredCount = 0;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->lock);
+#endif
+
+    uint64_t currentTick = currentTime / CS104_TIMER_WHEEL_TICK;
+
+    if ((self->isStarted == false) || (currentTick < self->currentTick) ||
+            (currentTick - self->currentTick >= CS104_TIMER_WHEEL_SLOTS))
+    {
+        /* check all slots once */
+        if (currentTick >= CS104_TIMER_WHEEL_SLOTS)
+            self->currentTick = currentTick - (CS104_TIMER_WHEEL_SLOTS - 1);
+        else
+            self->currentTick = 0;
+
+        self->isStarted = true;
+    }
+
+    uint64_t tick;
+
+    for (tick = self->currentTick; tick <= currentTick; tick++)
+    {
+        MasterConnection con = self->slots[tick % CS104_TIMER_WHEEL_SLOTS];
+
+        while (con)
+        {
+            MasterConnection next = con->timerNext;
+
+            if (con->timerTimeout <= currentTime) {
+                TimerWheel_unlink(self, con);
+                expired[expiredCount++] = con;
+            }
+
+            con = next;
         }
-        else {
-            self->recvBufPos = bufPos + readCnt;
-            return 0;
+    }
+
+    /* the current tick is checked again with the next call */
+    self->currentTick = currentTick;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->lock);
+#endif
+
+    return expiredCount;
+}
+
+/* timer wheel of the thread handling the connection, NULL when the connection has its own thread */
+static struct sTimerWheel*
+MasterConnection_getTimerWheel(MasterConnection self)
+{
+    if (self->worker)
+        return &(self->worker->timerWheel);
+
+#if (CONFIG_USE_THREADS == 1)
+    if (self->slave->isThreadlessMode == false)
+        return NULL;
+#endif
+
+    return &(self->slave->timerWheel);
+}
+
+/* unprotected version of armTimeout */
+static void
+_armTimeout(MasterConnection self, uint64_t timeout)
+{
+    if (timeout < self->nextTimeout)
+    {
+        self->nextTimeout = timeout;
+
+        struct sTimerWheel* timerWheel = MasterConnection_getTimerWheel(self);
+
+        if (timerWheel)
+            TimerWheel_schedule(timerWheel, self, timeout);
+    }
+}
+
+/* make sure that the timeouts are checked not later than the given time */
+static void
+armTimeout(MasterConnection self, uint64_t timeout)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    _armTimeout(self, timeout);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+}
+
+static void
+printSendBuffer(MasterConnection self)
+{
+    if (self->sentASDUsCount > 0) {
+        int i;
+
+        DEBUG_PRINT ("CS104 SLAVE: ------k-buffer------\n");
+
+        int currentIndex = self->oldestSentASDU;
+
+        for (i = 0; i < self->sentASDUsCount; i++) {
+            DEBUG_PRINT("CS104 SLAVE: %02i : SeqNo=%i time=%llu : queueEntry=%p\n", currentIndex,
+                    self->sentASDUs[currentIndex].seqNo,
+                    self->sentASDUs[currentIndex].sentTime,
+                    self->sentASDUs[currentIndex].queueEntry);
+
+            currentIndex = (currentIndex + 1) % self->maxSentASDUs;
         }
+
+        DEBUG_PRINT ("CS104 SLAVE: --------------------\n");
     }
+    else
+        DEBUG_PRINT("CS104 SLAVE: k-buffer is empty\n");
+}
 
-    self->recvBufPos = bufPos;
-    return 0;
+/**
+ * \return number of bytes read, or -1 in case of an error
+ */
+static int
+readFromSocket(MasterConnection self, uint8_t* buffer, int size)
+{
+#if (CONFIG_CS104_SUPPORT_TLS == 1)
+    if (self->tlsSocket != NULL)
+        return TLSSocket_read(self->tlsSocket, buffer, size);
+    else
+        return Socket_read(self->socket, buffer, size);
+#else
+    return Socket_read(self->socket, buffer, size);
+#endif
 }
 
+/**
+ * \brief Get the next received message, read from socket only when no complete message is buffered
+ *
+ * \return -1 in case of an error, 0 when no complete message can be read, > 0 when a complete message is in buffer
+ */
 static int
-writeToSocket(MasterConnection self, uint8_t* buf, int size)
+receiveMessage(MasterConnection self, uint8_t** msg)
 {
-    if (self->slave->rawMessageHandler)
-        self->slave->rawMessageHandler(self->slave->rawMessageHandlerParameter,
-                &(self->iMasterConnection), buf, size, true);
+    int msgSize = T104RecvBuffer_nextMessage(&(self->recvBuffer), msg);
 
+    if (msgSize == 0)
+    {
+        int freeSpace;
+
+        uint8_t* freeBuf = T104RecvBuffer_getFreeSpace(&(self->recvBuffer), &freeSpace);
+
+        int readCnt = readFromSocket(self, freeBuf, freeSpace);
+
+        if (readCnt < 1)
+            return readCnt;
+
+        T104RecvBuffer_commit(&(self->recvBuffer), readCnt);
+
+        msgSize = T104RecvBuffer_nextMessage(&(self->recvBuffer), msg);
+    }
+
+    if (msgSize == -1)
+        T104RecvBuffer_reset(&(self->recvBuffer));
+
+    return msgSize;
+}
+
+static int
+writeToSocketRaw(MasterConnection self, uint8_t* buf, int size)
+{
 #if (CONFIG_CS104_SUPPORT_TLS == 1)
     if (self->tlsSocket)
         return TLSSocket_write(self->tlsSocket, buf, size);
@@ -1802,6 +3076,221 @@ writeToSocket(MasterConnection self, uint8_t* buf, int size)
 #endif
 }
 
+/**
+ * \brief Write the bytes of the transmit buffer to the socket (partial writes are continued)
+ *
+ * When the socket does not accept more bytes the rest is moved to the start of the buffer
+ * and written by the next call.
+ *
+ * stateLock has to be held by the caller!
+ */
+static void
+flushTxBuffer(MasterConnection self)
+{
+    int sentBytes = 0;
+
+    while (sentBytes < self->txBufPos)
+    {
+        int result = writeToSocketRaw(self, self->txBuffer + sentBytes, self->txBufPos - sentBytes);
+
+        if (result < 0) {
+            DEBUG_PRINT("CS104 SLAVE: Failed to send %i buffered bytes\n", self->txBufPos - sentBytes);
+            self->isRunning = false;
+            sentBytes = self->txBufPos;
+            break;
+        }
+
+        if (result == 0)
+            break;
+
+        sentBytes += result;
+    }
+
+    if (sentBytes < self->txBufPos)
+        memmove(self->txBuffer, self->txBuffer + sentBytes, self->txBufPos - sentBytes);
+
+    self->txBufPos -= sentBytes;
+}
+
+/**
+ * \brief Write a message to the socket or append it to the transmit buffer
+ *
+ * The message is appended when I messages are collected or when bytes that were not accepted
+ * by the socket are waiting, so that the order of the messages is kept.
+ *
+ * stateLock has to be held by the caller!
+ *
+ * \return -1 when the message cannot be sent, the size of the message otherwise
+ */
+static int
+writeToSocket(MasterConnection self, uint8_t* buf, int size)
+{
+    if (self->slave->rawMessageHandler)
+        self->slave->rawMessageHandler(self->slave->rawMessageHandlerParameter,
+                &(self->iMasterConnection), buf, size, true);
+
+    if (self->txBatching || (self->txBufPos > 0))
+    {
+        if (self->txBufPos + size > CONFIG_CS104_SEND_BUFFER_SIZE)
+            flushTxBuffer(self);
+
+        if (self->txBufPos + size > CONFIG_CS104_SEND_BUFFER_SIZE) {
+            DEBUG_PRINT("CS104 SLAVE: Transmit buffer full - peer does not read\n");
+            return -1;
+        }
+
+        memcpy(self->txBuffer + self->txBufPos, buf, size);
+        self->txBufPos += size;
+
+        if (self->txBatching == false)
+            flushTxBuffer(self);
+
+        if (self->isRunning == false)
+            return -1;
+    }
+    else
+    {
+        int result = writeToSocketRaw(self, buf, size);
+
+        if (result < 0)
+            return -1;
+
+        /* keep the bytes the socket did not accept */
+        if (result < size) {
+            memcpy(self->txBuffer, buf + result, size - result);
+            self->txBufPos = size - result;
+        }
+    }
+
+    return size;
+}
+
+/* write a U message - has to be called without holding stateLock */
+static int
+sendUMessage(MasterConnection self, uint8_t* msg, int msgSize)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    int result = writeToSocket(self, msg, msgSize);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+    return result;
+}
+
+/**
+ * \brief Write the bytes that were not accepted by the socket before
+ *
+ * \return true when bytes are still waiting for transmission
+ */
+static bool
+flushPendingTx(MasterConnection self)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    if ((self->txBufPos > 0) && (self->txBatching == false))
+        flushTxBuffer(self);
+
+    bool isPending = (self->txBufPos > 0);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+    return isPending;
+}
+
+/* returns true when bytes that were not accepted by the socket are waiting for transmission */
+static bool
+isTxPending(MasterConnection self)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    bool isPending = (self->txBufPos > 0);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+    return isPending;
+}
+
+/**
+ * \brief Check if the transmit buffer can take another I message
+ *
+ * The buffer is full when the socket does not accept the buffered bytes. Then no more ASDUs are
+ * sent, like when the k-window is full. Some space is kept for S and U messages.
+ */
+static bool
+isTxBufferFull(MasterConnection self)
+{
+    bool isFull = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    if ((self->txBufPos > 0) && (self->txBufPos + TX_BUFFER_APDU_SPACE > CONFIG_CS104_SEND_BUFFER_SIZE)) {
+        flushTxBuffer(self);
+
+        isFull = (self->txBufPos > 0) && (self->txBufPos + TX_BUFFER_APDU_SPACE > CONFIG_CS104_SEND_BUFFER_SIZE);
+    }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+    return isFull;
+}
+
+/* collect I messages in the transmit buffer until endTxBatch is called */
+static void
+beginTxBatch(MasterConnection self)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    if (self->txBufPos > 0)
+        flushTxBuffer(self);
+
+    self->txBatching = true;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+}
+
+/* returns true when bytes are still waiting for transmission */
+static bool
+endTxBatch(MasterConnection self)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    if (self->txBufPos > 0)
+        flushTxBuffer(self);
+
+    self->txBatching = false;
+
+    bool isPending = (self->txBufPos > 0);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+    return isPending;
+}
+
 static int
 sendIMessage(MasterConnection self, uint8_t* buffer, int msgSize)
 {
@@ -1818,7 +3307,9 @@ sendIMessage(MasterConnection self, uint8_t* buffer, int msgSize)
     buffer[4] = (uint8_t) ((self->receiveCount % 128) * 2);
     buffer[5] = (uint8_t) (self->receiveCount / 128);
 
-    if (writeToSocket(self, buffer, msgSize) > 0) {
+    bool isSent = (writeToSocket(self, buffer, msgSize) > 0);
+
+    if (isSent) {
         DEBUG_PRINT("CS104 SLAVE: SEND I (size = %i) N(S) = %i N(R) = %i\n", msgSize, self->sendCount, self->receiveCount);
         self->sendCount = (self->sendCount + 1) % 32768;
         self->unconfirmedReceivedIMessages = 0;
@@ -1842,36 +3333,24 @@ static bool
 isSentBufferFull(MasterConnection self)
 {
     /* locking of k-buffer has to be done by caller! */
-    if (self->oldestSentASDU == -1)
-        return false;
-
-    int newIndex = (self->newestSentASDU + 1) % (self->maxSentASDUs);
-
-    if (newIndex == self->oldestSentASDU)
-        return true;
-    else
-        return false;
+    return (self->sentASDUsCount >= self->maxSentASDUs);
 }
 
 static void
 sendASDU(MasterConnection self, uint8_t* buffer, int msgSize, uint64_t entryId, uint8_t* queueEntry)
 {
-    int currentIndex = 0;
-
-    if (self->oldestSentASDU == -1) {
-        self->oldestSentASDU = 0;
-        self->newestSentASDU = 0;
-    }
-    else {
-        currentIndex = (self->newestSentASDU + 1) % self->maxSentASDUs;
-    }
+    int currentIndex = (self->oldestSentASDU + self->sentASDUsCount) % self->maxSentASDUs;
 
     self->sentASDUs[currentIndex].entryId = entryId;
     self->sentASDUs[currentIndex].queueEntry = queueEntry;
     self->sentASDUs[currentIndex].seqNo = sendIMessage(self, buffer, msgSize);
     self->sentASDUs[currentIndex].sentTime = Hal_getMonotonicTimeInMs();
 
-    self->newestSentASDU = currentIndex;
+    self->sentASDUsCount++;
+
+    /* start timeout T1 for the oldest sent ASDU */
+    if (self->sentASDUsCount == 1)
+        armTimeout(self, self->sentASDUs[currentIndex].sentTime + (uint64_t) (self->slave->conParameters.t1 * 1000));
 
     printSendBuffer(self);
 }
@@ -1887,7 +3366,7 @@ sendASDUInternal(MasterConnection self, CS101_ASDU asdu)
         Semaphore_wait(self->sentASDUsLock);
 #endif
 
-        if (isSentBufferFull(self) == false) {
+        if ((isSentBufferFull(self) == false) && (isTxBufferFull(self) == false)) {
 
             FrameBuffer frameBuffer;
 
@@ -1911,6 +3390,9 @@ sendASDUInternal(MasterConnection self, CS101_ASDU asdu)
             Semaphore_post(self->sentASDUsLock);
 #endif
             asduSent = HighPriorityASDUQueue_enqueue(self->highPrioQueue, asdu);
+
+            if (asduSent)
+                MasterConnection_wakeup(self);
         }
 
     }
@@ -2327,94 +3809,61 @@ checkSequenceNumber(MasterConnection self, int seqNo)
     /* check if received sequence number is valid */
 
     bool seqNoIsValid = false;
-    bool counterOverflowDetected = false;
-    int oldestValidSeqNo = -1;
 
-    if (self->oldestSentASDU == -1) { /* if k-Buffer is empty */
+    /* number of sent ASDUs confirmed by the received sequence number */
+    int confirmedCount = 0;
+
+    if (self->sentASDUsCount == 0) { /* if k-Buffer is empty */
         if (seqNo == self->sendCount)
             seqNoIsValid = true;
     }
     else {
-        /* two cases are required to reflect sequence number overflow */
+        /* the sequence numbers in the k-buffer are consecutive -> position of the confirmed ASDU */
         int oldestAsduSeqNo = self->sentASDUs[self->oldestSentASDU].seqNo;
-        int newestAsduSeqNo = self->sentASDUs[self->newestSentASDU].seqNo;
 
-        if (oldestAsduSeqNo <= newestAsduSeqNo) {
-            if ((seqNo >= oldestAsduSeqNo) && (seqNo <= newestAsduSeqNo))
-                seqNoIsValid = true;
-        }
-        else {
-            if ((seqNo >= oldestAsduSeqNo) || (seqNo <= newestAsduSeqNo))
-                seqNoIsValid = true;
+        int offset = (seqNo - oldestAsduSeqNo + 32768) % 32768;
 
-            counterOverflowDetected = true;
+        if (offset < self->sentASDUsCount) {
+            seqNoIsValid = true;
+            confirmedCount = offset + 1;
         }
-
-        /* check if confirmed message was already removed from list */
-        if (oldestAsduSeqNo == 0)
-            oldestValidSeqNo = 32767;
-        else
-            oldestValidSeqNo = (oldestAsduSeqNo - 1) % 32768;
-
-        if (oldestValidSeqNo == seqNo)
+        else if (offset == 32767) {
+            /* confirmed message was already removed from list */
             seqNoIsValid = true;
+        }
     }
 
     if (seqNoIsValid)
     {
-        if (self->oldestSentASDU != -1)
-        {
-            do
-            {
-                int oldestAsduSeqNo = self->sentASDUs[self->oldestSentASDU].seqNo;
-
-                if (counterOverflowDetected == false) {
-                    if (seqNo < oldestAsduSeqNo)
-                        break;
-                }
+        bool queueLocked = false;
 
-                if (seqNo == oldestValidSeqNo)
-                    break;
+        while (confirmedCount > 0)
+        {
+            SentASDUSlave* sentAsdu = &(self->sentASDUs[self->oldestSentASDU]);
 
-                /* remove from server (low-priority) queue if required */
-                if (self->sentASDUs[self->oldestSentASDU].queueEntry != NULL)
-                {
+            /* remove from server (low-priority) queue if required */
+            if (sentAsdu->queueEntry != NULL)
+            {
+                if (queueLocked == false) {
                     MessageQueue_lock(self->lowPrioQueue);
-
-                    MessageQueue_markAsduAsConfirmed(self->lowPrioQueue,
-                            self->sentASDUs[self->oldestSentASDU].queueEntry,
-                            self->sentASDUs[self->oldestSentASDU].entryId);
-
-                    self->sentASDUs[self->oldestSentASDU].queueEntry = NULL;
-
-                    self->sentASDUs[self->oldestSentASDU].seqNo = -1;
-
-                    MessageQueue_unlock(self->lowPrioQueue);
+                    queueLocked = true;
                 }
 
-                if (oldestAsduSeqNo == seqNo)
-                {
-                    /* we arrived at the seq# that has been confirmed */
-
-                    if (self->oldestSentASDU == self->newestSentASDU)
-                        self->oldestSentASDU = -1;
-                    else
-                        self->oldestSentASDU = (self->oldestSentASDU + 1) % self->maxSentASDUs;
-
-                    break;
-                }
+                MessageQueue_markAsduAsConfirmed(self->lowPrioQueue, sentAsdu->queueEntry, sentAsdu->entryId);
 
-                self->oldestSentASDU = (self->oldestSentASDU + 1) % self->maxSentASDUs;
+                sentAsdu->queueEntry = NULL;
+            }
 
-                int checkIndex = (self->newestSentASDU + 1) % self->maxSentASDUs;
+            sentAsdu->seqNo = -1;
 
-                if (self->oldestSentASDU == checkIndex) {
-                    self->oldestSentASDU = -1;
-                    break;
-                }
+            self->oldestSentASDU = (self->oldestSentASDU + 1) % self->maxSentASDUs;
+            self->sentASDUsCount--;
 
-            } while (true);
+            confirmedCount--;
         }
+
+        if (queueLocked)
+            MessageQueue_unlock(self->lowPrioQueue);
     }
     else
         DEBUG_PRINT("CS104 SLAVE: Received sequence number out of range");
@@ -2608,6 +4057,8 @@ handleMessage(MasterConnection self, uint8_t* buffer, int msgSize)
             if (self->timeoutT2Triggered == false) {
                 self->timeoutT2Triggered = true;
                 self->lastConfirmationTime = currentTime; /* start timeout T2 */
+
+                _armTimeout(self, currentTime + (uint64_t) (self->slave->conParameters.t2 * 1000));
             }
 #if (CONFIG_USE_SEMAPHORES == 1)
             Semaphore_post(self->stateLock);
@@ -2678,7 +4129,7 @@ handleMessage(MasterConnection self, uint8_t* buffer, int msgSize)
         else if ((buffer[2] & 0x43) == 0x43) {
             DEBUG_PRINT("CS104 SLAVE: Send TESTFR_CON\n");
 
-            if (writeToSocket(self, TESTFR_CON_MSG, TESTFR_CON_MSG_SIZE) < 0)
+            if (sendUMessage(self, TESTFR_CON_MSG, TESTFR_CON_MSG_SIZE) < 0)
                 return false;
         }
 
@@ -2690,7 +4141,7 @@ handleMessage(MasterConnection self, uint8_t* buffer, int msgSize)
 
             DEBUG_PRINT("CS104 SLAVE: Send STARTDT_CON\n");
 
-            if (writeToSocket(self, STARTDT_CON_MSG, STARTDT_CON_MSG_SIZE) < 0)
+            if (sendUMessage(self, STARTDT_CON_MSG, STARTDT_CON_MSG_SIZE) < 0)
                 return false;
         }
 
@@ -2781,7 +4232,7 @@ handleMessage(MasterConnection self, uint8_t* buffer, int msgSize)
 
                     DEBUG_PRINT("CS104 SLAVE: Send STOPDT_CON\n");
 
-                    if (writeToSocket(self, STOPDT_CON_MSG, STOPDT_CON_MSG_SIZE) < 0)
+                    if (sendUMessage(self, STOPDT_CON_MSG, STOPDT_CON_MSG_SIZE) < 0)
                         return false;
                 }
             }
@@ -2824,6 +4275,16 @@ MasterConnection_deinit(MasterConnection self)
         }
 
         self->state = M_CON_STATE_STOPPED;
+
+        if (self->lowPrioQueue)
+            MessageQueue_removeWaitingConnection(self->lowPrioQueue, self);
+
+        struct sTimerWheel* timerWheel = MasterConnection_getTimerWheel(self);
+
+        if (timerWheel)
+            TimerWheel_cancel(timerWheel, self);
+
+        self->worker = NULL;
     }
 }
 
@@ -2841,6 +4302,9 @@ MasterConnection_destroy(MasterConnection self)
 
         Handleset_destroy(self->handleSet);
 
+        if (self->wakeupEvent)
+            WakeupEvent_destroy(self->wakeupEvent);
+
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP == 1)
         if (self->slave->serverMode == CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP) {
             MessageQueue_destroy(self->lowPrioQueue);
@@ -2852,16 +4316,18 @@ MasterConnection_destroy(MasterConnection self)
     }
 }
 
-static void
+/* returns true when an ASDU was sent */
+static bool
 sendNextLowPriorityASDU(MasterConnection self)
 {
 #if (CONFIG_USE_SEMAPHORES == 1)
     Semaphore_wait(self->sentASDUsLock);
 #endif
 
+    bool retVal = false;
     uint8_t* asduBuffer;
 
-    if (isSentBufferFull(self))
+    if (isSentBufferFull(self) || isTxBufferFull(self))
         goto exit_function;
 
     MessageQueue_lock(self->lowPrioQueue);
@@ -2878,6 +4344,8 @@ sendNextLowPriorityASDU(MasterConnection self)
         msgSize += IEC60870_5_104_APCI_LENGTH;
 
         sendASDU(self, self->sendBuffer, msgSize, entryId, queueEntry);
+
+        retVal = true;
     }
 
     MessageQueue_unlock(self->lowPrioQueue);
@@ -2888,7 +4356,7 @@ exit_function:
     Semaphore_post(self->sentASDUsLock);
 #endif
 
-    return;
+    return retVal;
 }
 
 static bool
@@ -2902,7 +4370,7 @@ sendNextHighPriorityASDU(MasterConnection self)
     Semaphore_wait(self->sentASDUsLock);
 #endif
 
-    if (isSentBufferFull(self))
+    if (isSentBufferFull(self) || isTxBufferFull(self))
         goto exit_function;
 
     HighPriorityASDUQueue_lock(self->highPrioQueue);
@@ -2930,7 +4398,8 @@ exit_function:
 }
 
 /**
- * Send all high-priority ASDUs and the last waiting ASDU from the low-priority queue.
+ * Send all high-priority ASDUs and as many waiting ASDUs from the low-priority queue as the
+ * k-window allows. The I messages are collected and written to the socket at once.
  * Returns true if ASDUs are still waiting. This can happen when there are more ASDUs
  * in the event (low-priority) buffer, or the connection is unavailable to send the high-priority
  * ASDUs (congestion or connection lost).
@@ -2938,35 +4407,109 @@ exit_function:
 static bool
 sendWaitingASDUs(MasterConnection self)
 {
+    bool isAsduWaiting = false;
+
+    beginTxBatch(self);
+
     /* send all available high priority ASDUs first */
     while (HighPriorityASDUQueue_isAsduAvailable(self->highPrioQueue)) {
 
-        if (sendNextHighPriorityASDU(self) == false)
-            return true;
-
-        if (MasterConnection_isRunning(self) == false)
-            return true;
+        if ((sendNextHighPriorityASDU(self) == false) || (MasterConnection_isRunning(self) == false)) {
+            isAsduWaiting = true;
+            break;
+        }
     }
 
     /* send messages from low-priority queue */
-    sendNextLowPriorityASDU(self);
+    if (isAsduWaiting == false)
+    {
+        while (sendNextLowPriorityASDU(self)) {
+            if (MasterConnection_isRunning(self) == false)
+                break;
+        }
 
-    if (MessageQueue_isAsduAvailable(self->lowPrioQueue))
-        return true;
+        isAsduWaiting = MessageQueue_isAsduAvailableOrWait(self->lowPrioQueue, self);
+    }
+
+    /* bytes not accepted by the socket are written by the next call */
+    if (endTxBatch(self))
+        isAsduWaiting = true;
+
+    return isAsduWaiting;
+}
+
+/* calculate the earliest timeout of T1, T2 and T3 - caller has to hold sentASDUsLock and stateLock */
+static uint64_t
+getNextTimeout(MasterConnection self)
+{
+    uint64_t nextTimeout;
+
+    if (self->waitingForTestFRcon)
+        nextTimeout = self->nextTestFRConTimeout;
     else
-        return false;
+        nextTimeout = self->nextT3Timeout;
+
+    if ((self->unconfirmedReceivedIMessages > 0) && (self->lastConfirmationTime != UINT64_MAX)) {
+        uint64_t t2Timeout = self->lastConfirmationTime + (uint64_t) (self->slave->conParameters.t2 * 1000);
+
+        if (t2Timeout < nextTimeout)
+            nextTimeout = t2Timeout;
+    }
+
+    if (self->sentASDUsCount > 0) {
+        uint64_t t1Timeout = self->sentASDUs[self->oldestSentASDU].sentTime + (uint64_t) (self->slave->conParameters.t1 * 1000);
+
+        if (t1Timeout < nextTimeout)
+            nextTimeout = t1Timeout;
+    }
+
+    return nextTimeout;
 }
 
-static bool
-handleTimeouts(MasterConnection self)
+/* set the time of the next timeout check and schedule the connection in the timer wheel */
+static void
+updateNextTimeout(MasterConnection self)
 {
-    uint64_t currentTime = Hal_getMonotonicTimeInMs();
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->sentASDUsLock);
+    Semaphore_wait(self->stateLock);
+#endif
+
+    self->nextTimeout = getNextTimeout(self);
+
+    struct sTimerWheel* timerWheel = MasterConnection_getTimerWheel(self);
+
+    if (timerWheel)
+        TimerWheel_schedule(timerWheel, self, self->nextTimeout);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+    Semaphore_post(self->sentASDUsLock);
+#endif
+}
 
+static bool
+handleTimeouts(MasterConnection self, uint64_t currentTime)
+{
     bool timeoutsOk = true;
 
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    /* no timeout can be expired before the next timeout */
+    bool checkRequired = (currentTime >= self->nextTimeout);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+    if (checkRequired == false)
+        return true;
+
     /* check T3 timeout */
     if (checkT3Timeout(self, currentTime)) {
-        if (writeToSocket(self, TESTFR_ACT_MSG, TESTFR_ACT_MSG_SIZE) < 0) {
+        if (sendUMessage(self, TESTFR_ACT_MSG, TESTFR_ACT_MSG_SIZE) < 0) {
 
             DEBUG_PRINT("CS104 SLAVE: Failed to write TESTFR ACT message\n");
 #if (CONFIG_USE_SEMAPHORES == 1)
@@ -3033,7 +4576,7 @@ handleTimeouts(MasterConnection self)
 #endif
 
     /* check if counterpart confirmed I message */
-    if (self->oldestSentASDU != -1) {
+    if (self->sentASDUsCount > 0) {
 
         /* check validity of sent time */
 
@@ -3059,6 +4602,9 @@ handleTimeouts(MasterConnection self)
     Semaphore_post(self->sentASDUsLock);
 #endif
 
+    if (timeoutsOk)
+        updateNextTimeout(self);
+
     return timeoutsOk;
 }
 
@@ -3069,22 +4615,113 @@ CS104_Slave_closeAllConnections(CS104_Slave self)
     Semaphore_wait(self->openConnectionsLock);
 #endif
 
-    int i;
+    int i;
+
+    for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++) {
+        if (self->masterConnections[i]) {
+            if (self->masterConnections[i]->isUsed) {
+                self->masterConnections[i]->isUsed = false;
+                MasterConnection_deinit(self->masterConnections[i]);
+            }
+        }
+    }
+
+    self->openConnections = 0;
+
+#if (CONFIG_USE_SEMAPHORES)
+    Semaphore_post(self->openConnectionsLock);
+#endif
+}
+
+/* wake up the thread handling the connection when it is waiting for the socket */
+static void
+MasterConnection_wakeup(MasterConnection self)
+{
+    CS104_Slave slave = self->slave;
+
+#if (CONFIG_USE_THREADS == 1)
+    if (slave->isThreadlessMode)
+        return;
+
+    if (slave->isEventLoopMode)
+    {
+        EventLoopWorker worker = self->worker;
+
+        if (worker && worker->wakeupEvent)
+        {
+#if (CONFIG_USE_SEMAPHORES == 1)
+            Semaphore_wait(slave->stateLock);
+#endif
+
+            if (worker->wakeupSignaled == false)
+            {
+                worker->wakeupSignaled = true;
+                WakeupEvent_signal(worker->wakeupEvent);
+            }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+            Semaphore_post(slave->stateLock);
+#endif
+        }
+
+        return;
+    }
+
+    if (self->wakeupEvent)
+    {
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_wait(self->stateLock);
+#endif
+
+        if (self->wakeupSignaled == false)
+        {
+            self->wakeupSignaled = true;
+            WakeupEvent_signal(self->wakeupEvent);
+        }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_post(self->stateLock);
+#endif
+    }
+#else
+    (void)slave;
+#endif /* (CONFIG_USE_THREADS == 1) */
+}
+
+static void
+MasterConnection_resetWakeup(MasterConnection self)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    if (self->wakeupSignaled)
+    {
+        WakeupEvent_reset(self->wakeupEvent);
+        self->wakeupSignaled = false;
+    }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+}
+
+/*
+ * wake up the connections that found the low-priority queue empty - connections that are
+ * still sending check the queue again by themselves
+ */
+static void
+wakeupConnectionsOfQueue(MessageQueue queue)
+{
+    MasterConnection connections[CONFIG_CS104_MAX_CLIENT_CONNECTIONS];
 
-    for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++) {
-        if (self->masterConnections[i]) {
-            if (self->masterConnections[i]->isUsed) {
-                self->masterConnections[i]->isUsed = false;
-                MasterConnection_deinit(self->masterConnections[i]);
-            }
-        }
-    }
+    int count = MessageQueue_takeWaitingConnections(queue, connections);
 
-    self->openConnections = 0;
+    int i;
 
-#if (CONFIG_USE_SEMAPHORES)
-    Semaphore_post(self->openConnectionsLock);
-#endif
+    /* the wakeup of an event loop thread is only signaled once for all its connections */
+    for (i = 0; i < count; i++)
+        MasterConnection_wakeup(connections[i]);
 }
 
 static void*
@@ -3105,35 +4742,43 @@ connectionHandlingThread(void* parameter)
         Handleset_reset(self->handleSet);
         Handleset_addSocket(self->handleSet, self->socket);
 
+        if (self->wakeupEvent)
+            Handleset_addSocket(self->handleSet, (Socket) self->wakeupEvent);
+
+        /* bytes not accepted by the socket are written when the socket becomes writable again */
+        bool txPending = isTxPending(self);
+
+        if (txPending)
+            Handleset_addSocketForWriting(self->handleSet, self->socket);
+
         int socketTimeout;
 
         /*
          * When an ASDU is waiting only have a short look to see if a client request
          * was received. Otherwise wait to save CPU time.
          */
-        if (isAsduWaiting)
+        if (isAsduWaiting && (txPending == false))
             socketTimeout = 0;
         else
             socketTimeout = 100;
 
         if (Handleset_waitReady(self->handleSet, socketTimeout))
         {
-            int bytesRec = receiveMessage(self);
+            uint8_t* msg;
 
-            if (bytesRec == -1) {
-                DEBUG_PRINT("CS104 SLAVE: Error reading from socket\n");
-                break;
-            }
+            MasterConnection_resetWakeup(self);
+            int bytesRec;
 
-            if (bytesRec > 0)
+            /* handle all complete messages in the receive buffer */
+            while ((bytesRec = receiveMessage(self, &msg)) > 0)
             {
                 DEBUG_PRINT("CS104 SLAVE: Connection: rcvd msg(%i bytes)\n", bytesRec);
 
                 if (self->slave->rawMessageHandler)
                     self->slave->rawMessageHandler(self->slave->rawMessageHandlerParameter,
-                            &(self->iMasterConnection), self->recvBuffer, bytesRec, false);
+                            &(self->iMasterConnection), msg, bytesRec, false);
 
-                if (handleMessage(self, self->recvBuffer, bytesRec) == false)
+                if (handleMessage(self, msg, bytesRec) == false)
                 {
 #if (CONFIG_USE_SEMAPHORES == 1)
                     Semaphore_wait(self->stateLock);
@@ -3155,10 +4800,18 @@ connectionHandlingThread(void* parameter)
 
                     sendSMessage(self);
                 }
+
+                if (MasterConnection_isRunning(self) == false)
+                    break;
+            }
+
+            if (bytesRec == -1) {
+                DEBUG_PRINT("CS104 SLAVE: Error reading from socket\n");
+                break;
             }
         }
 
-        if (handleTimeouts(self) == false) {
+        if (handleTimeouts(self, Hal_getMonotonicTimeInMs()) == false) {
 #if (CONFIG_USE_SEMAPHORES == 1)
             Semaphore_wait(self->stateLock);
 #endif /* (CONFIG_USE_SEMAPHORES == 1) */
@@ -3176,6 +4829,8 @@ connectionHandlingThread(void* parameter)
             {
                 isAsduWaiting = sendWaitingASDUs(self);
             }
+            else
+                isAsduWaiting = flushPendingTx(self);
         }
 
         /* call plugins */
@@ -3319,6 +4974,10 @@ MasterConnection_create(CS104_Slave slave)
         self->slave = slave;
         self->maxSentASDUs = 0;
         self->sentASDUs = NULL;
+        self->timerNext = NULL;
+        self->timerPrev = NULL;
+        self->isTimerScheduled = false;
+        self->worker = NULL;
         self->iMasterConnection.object = self;
         self->iMasterConnection.getApplicationLayerParameters = _IMasterConnection_getApplicationLayerParameters;
         self->iMasterConnection.isReady = _IMasterConnection_isReady;
@@ -3337,6 +4996,8 @@ MasterConnection_create(CS104_Slave slave)
         self->stateLock = Semaphore_create(1);
 #endif
         self->handleSet = Handleset_new();
+        self->wakeupEvent = NULL;
+        self->wakeupSignaled = false;
 
         /* initialize pointers with NULL to avoid segmentation fault on destroy call */
         self->socket = NULL;
@@ -3363,7 +5024,9 @@ MasterConnection_init(MasterConnection self, Socket skt, MessageQueue lowPrioQue
         self->isRunning = false;
         self->receiveCount = 0;
         self->sendCount = 0;
-        self->recvBufPos = 0;
+        T104RecvBuffer_reset(&(self->recvBuffer));
+        self->txBufPos = 0;
+        self->txBatching = false;
 
         if (self->maxSentASDUs != self->slave->conParameters.k)
         {
@@ -3391,8 +5054,8 @@ MasterConnection_init(MasterConnection self, Socket skt, MessageQueue lowPrioQue
 
         self->timeoutT2Triggered = false;
 
-        self->oldestSentASDU = -1;
-        self->newestSentASDU = -1;
+        self->oldestSentASDU = 0;
+        self->sentASDUsCount = 0;
 
         resetT3Timeout(self, Hal_getMonotonicTimeInMs());
 
@@ -3425,6 +5088,9 @@ MasterConnection_init(MasterConnection self, Socket skt, MessageQueue lowPrioQue
 
         self->waitingForTestFRcon = false;
 
+        self->nextTimeout = UINT64_MAX;
+        updateNextTimeout(self);
+
         return true;
     }
     else {
@@ -3462,6 +5128,9 @@ MasterConnection_start(MasterConnection self)
     self->isRunning = true;
     self->state = M_CON_STATE_STOPPED;
 
+    if (self->wakeupEvent == NULL)
+        self->wakeupEvent = WakeupEvent_create();
+
     self->connectionThread =
            Thread_create((ThreadExecutionFunction) connectionHandlingThread,
                    (void*) self, false);
@@ -3550,20 +5219,17 @@ MasterConnection_activate(MasterConnection self)
 static void
 MasterConnection_handleTcpConnection(MasterConnection self)
 {
-    int bytesRec = receiveMessage(self);
-
-    if (bytesRec < 0) {
-        DEBUG_PRINT("CS104 SLAVE: Error reading from socket\n");
-        self->isRunning = false;
-    }
+    uint8_t* msg;
+    int bytesRec;
 
-    if ((bytesRec > 0) && (self->isRunning))
+    /* handle all complete messages in the receive buffer */
+    while (((bytesRec = receiveMessage(self, &msg)) > 0) && (self->isRunning))
     {
         if (self->slave->rawMessageHandler)
             self->slave->rawMessageHandler(self->slave->rawMessageHandlerParameter,
-                    &(self->iMasterConnection), self->recvBuffer, bytesRec, false);
+                    &(self->iMasterConnection), msg, bytesRec, false);
 
-        if (handleMessage(self, self->recvBuffer, bytesRec) == false)
+        if (handleMessage(self, msg, bytesRec) == false)
             self->isRunning = false;
 
         if (self->unconfirmedReceivedIMessages >= self->slave->conParameters.w)
@@ -3577,20 +5243,96 @@ MasterConnection_handleTcpConnection(MasterConnection self)
             sendSMessage(self);
         }
     }
+
+    if (bytesRec < 0) {
+        DEBUG_PRINT("CS104 SLAVE: Error reading from socket\n");
+        self->isRunning = false;
+    }
 }
 
-static void
+/* returns true when ASDUs are still waiting for transmission */
+static bool
 MasterConnection_executePeriodicTasks(MasterConnection self)
 {
+    bool isAsduWaiting = false;
+
     if (self->state == M_CON_STATE_STARTED)
     {
-        sendWaitingASDUs(self);
+        isAsduWaiting = sendWaitingASDUs(self);
     }
+    else
+        isAsduWaiting = flushPendingTx(self);
+
+    return isAsduWaiting;
+}
+
+/* check the timeouts of the connections that are due (non-threaded and event loop mode) */
+static void
+handleConnectionTimeouts(struct sTimerWheel* timerWheel)
+{
+    MasterConnection expired[CONFIG_CS104_MAX_CLIENT_CONNECTIONS];
+
+    uint64_t currentTime = Hal_getMonotonicTimeInMs();
 
-    if (handleTimeouts(self) == false)
+    int expiredCount = TimerWheel_getExpired(timerWheel, currentTime, expired);
+
+    int i;
+
+    for (i = 0; i < expiredCount; i++)
     {
-        self->isRunning = false;
+        MasterConnection con = expired[i];
+
+        if (con->isUsed && con->isRunning)
+        {
+            if (handleTimeouts(con, currentTime) == false)
+                con->isRunning = false;
+        }
+    }
+}
+
+static void
+callPluginTasks(CS104_Slave self, MasterConnection con)
+{
+    if (self->plugins)
+    {
+        LinkedList pluginElem = LinkedList_getNext(self->plugins);
+
+        while (pluginElem)
+        {
+            CS101_SlavePlugin plugin = (CS101_SlavePlugin) LinkedList_getData(pluginElem);
+
+            plugin->runTask(plugin->parameter, &(con->iMasterConnection));
+
+            pluginElem = LinkedList_getNext(pluginElem);
+        }
+    }
+}
+
+/* release a connection that is no longer running (non-threaded and event loop mode) */
+static void
+releaseConnection(CS104_Slave self, MasterConnection con)
+{
+    if (self->connectionEventHandler) {
+       self->connectionEventHandler(self->connectionEventHandlerParameter, &(con->iMasterConnection), CS104_CON_EVENT_CONNECTION_CLOSED);
     }
+
+    DEBUG_PRINT("CS104 SLAVE: Connection closed\n");
+
+#if (CONFIG_USE_SEMAPHORES)
+    Semaphore_wait(self->openConnectionsLock);
+#endif
+
+    con->isUsed = false;
+
+    MessageQueue_setWaitingForTransmissionWhenNotConfirmed(con->lowPrioQueue);
+
+    self->openConnections--;
+
+    MasterConnection_deinit(con);
+
+#if (CONFIG_USE_SEMAPHORES)
+    Semaphore_post(self->openConnectionsLock);
+#endif
 }
 
 static void
@@ -3624,19 +5366,7 @@ handleClientConnections(CS104_Slave self)
                 }
                 else
                 {
-                    if (self->connectionEventHandler) {
-                       self->connectionEventHandler(self->connectionEventHandlerParameter, &(con->iMasterConnection), CS104_CON_EVENT_CONNECTION_CLOSED);
-                    }
-
-                    DEBUG_PRINT("CS104 SLAVE: Connection closed\n");
-
-                    self->masterConnections[i]->isUsed = false;
-
-                    MessageQueue_setWaitingForTransmissionWhenNotConfirmed(self->masterConnections[i]->lowPrioQueue);
-
-                    self->openConnections--;
-
-                    MasterConnection_deinit(con);
+                    releaseConnection(self, con);
                 }
             }
         }
@@ -3656,6 +5386,8 @@ handleClientConnections(CS104_Slave self)
             }
         }
 
+        handleConnectionTimeouts(&(self->timerWheel));
+
         /* handle periodic tasks for running connections */
         for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++)
         {
@@ -3668,19 +5400,7 @@ handleClientConnections(CS104_Slave self)
                     MasterConnection_executePeriodicTasks(con);
 
                     /* call plugins */
-                    if (self->plugins)
-                    {
-                        LinkedList pluginElem = LinkedList_getNext(self->plugins);
-
-                        while (pluginElem)
-                        {
-                            CS101_SlavePlugin plugin = (CS101_SlavePlugin) LinkedList_getData(pluginElem);
-
-                            plugin->runTask(plugin->parameter, &(con->iMasterConnection));
-
-                            pluginElem = LinkedList_getNext(pluginElem);
-                        }
-                    }
+                    callPluginTasks(self, con);
                 }
             }
         }
@@ -3770,6 +5490,137 @@ getMatchingRedundancyGroup(CS104_Slave self, char* ipAddrStr)
 }
 #endif /* (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1) */
 
+/*
+ * create a connection for a new client socket, the socket is destroyed when the connection is not accepted
+ *
+ * \param worker the event loop thread handling the connection or NULL (non-threaded mode)
+ */
+static MasterConnection
+addNewConnection(CS104_Slave self, Socket newSocket, EventLoopWorker worker)
+{
+    MasterConnection connection = NULL;
+
+    bool acceptConnection = callConnectionRequestHandler(self, newSocket);
+
+    if (acceptConnection)
+    {
+        MessageQueue lowPrioQueue = NULL;
+        HighPriorityASDUQueue highPrioQueue = NULL;
+
+#if (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1)
+        if (self->serverMode == CS104_MODE_SINGLE_REDUNDANCY_GROUP) {
+            lowPrioQueue = self->asduQueue;
+            highPrioQueue = self->connectionAsduQueue;
+        }
+#endif
+
+#if (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1)
+        if (self->serverMode == CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS)
+        {
+            char ipAddress[60];
+
+            char* ipAddrStr = getPeerAddress(newSocket, ipAddress);
+
+            if (ipAddrStr)
+            {
+                CS104_RedundancyGroup matchingGroup = getMatchingRedundancyGroup(self, ipAddrStr);
+
+                if (matchingGroup != NULL)
+                {
+#if (CONFIG_USE_SEMAPHORES)
+                    Semaphore_wait(self->openConnectionsLock);
+#endif
+
+                    connection = getFreeConnection(self, worker);
+
+                    if (connection)
+                    {
+                        if (MasterConnection_initEx(connection, newSocket, matchingGroup))
+                        {
+                            self->openConnections++;
+
+                            if (matchingGroup->name) {
+                                DEBUG_PRINT("CS104 SLAVE: Add connection to group: %s\n", matchingGroup->name);
+                            }
+                        }
+                        else {
+                            connection->isUsed = false;
+                            connection = NULL;
+                        }
+                    }
+
+#if (CONFIG_USE_SEMAPHORES)
+                    Semaphore_post(self->openConnectionsLock);
+#endif
+
+                }
+                else {
+                    DEBUG_PRINT("CS104 SLAVE: Found no matching redundancy group -> close connection\n");
+                }
+            }
+            else {
+                DEBUG_PRINT("CS104 SLAVE: cannot determine peer IP address -> close connection\n");
+            }
+
+        }
+        else
+#endif /* CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS */
+        {
+#if (CONFIG_USE_SEMAPHORES)
+            Semaphore_wait(self->openConnectionsLock);
+#endif
+            connection = getFreeConnection(self, worker);
+
+#if (CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP == 1)
+            if (self->serverMode == CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP)
+            {
+                lowPrioQueue = connection->lowPrioQueue;
+                MessageQueue_releaseAllQueuedASDUs(lowPrioQueue);
+                MessageQueue_initialize(lowPrioQueue);
+
+                highPrioQueue = connection->highPrioQueue;
+                HighPriorityASDUQueue_initialize(highPrioQueue);
+            }
+#endif /* CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS */
+
+            if (connection)
+            {
+                if (MasterConnection_init(connection, newSocket, lowPrioQueue, highPrioQueue)) {
+                    self->openConnections++;
+                }
+                else {
+                    connection->isUsed = false;
+                    connection = NULL;
+                }
+            }
+
+#if (CONFIG_USE_SEMAPHORES)
+            Semaphore_post(self->openConnectionsLock);
+#endif
+
+        }
+
+        if (connection)
+        {
+            connection->isRunning = true;
+
+            if (self->connectionEventHandler) {
+                self->connectionEventHandler(self->connectionEventHandlerParameter, &(connection->iMasterConnection), CS104_CON_EVENT_CONNECTION_OPENED);
+            }
+        }
+        else {
+            Socket_destroy(newSocket);
+            DEBUG_PRINT("CS104 SLAVE: Connection attempt failed!\n");
+        }
+
+    }
+    else {
+        Socket_destroy(newSocket);
+    }
+
+    return connection;
+}
+
 /* handle TCP connections in non-threaded mode */
 static void
 handleConnectionsThreadless(CS104_Slave self)
@@ -3778,15 +5629,73 @@ handleConnectionsThreadless(CS104_Slave self)
     {
         Socket newSocket = ServerSocket_accept(self->serverSocket);
 
-        if (newSocket != NULL)
-        {
+        if (newSocket != NULL)
+            addNewConnection(self, newSocket, NULL);
+    }
+
+    handleClientConnections(self);
+
+    syncPersistentQueue(self, false);
+}
+
+#if (CONFIG_USE_THREADS == 1)
+
+static void*
+serverThread (void* parameter)
+{
+    CS104_Slave self = (CS104_Slave) parameter;
+
+    if (self->localAddress)
+        self->serverSocket = TcpServerSocket_create(self->localAddress, self->tcpPort);
+    else
+        self->serverSocket = TcpServerSocket_create("0.0.0.0", self->tcpPort);
+
+    if (self->serverSocket == NULL) {
+        DEBUG_PRINT("CS104 SLAVE: Cannot create server socket\n");
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_wait(self->stateLock);
+#endif
+        self->isStarting = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_post(self->stateLock);
+#endif
+
+        goto exit_function;
+    }
+
+    ServerSocket_listen(self->serverSocket);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    self->isRunning = true;
+    self->isStarting = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+    while (isStopRunningSet(self) == false) {
+        Socket newSocket = ServerSocket_accept(self->serverSocket);
+
+        if (newSocket != NULL) {
+
             bool acceptConnection = true;
 
+            /* check if maximum number of open connections is reached */
+            if (self->maxOpenConnections > 0) {
+                if (CS104_Slave_getOpenConnections(self) >= self->maxOpenConnections)
+                    acceptConnection = false;
+            }
+
             if (acceptConnection)
                 acceptConnection = callConnectionRequestHandler(self, newSocket);
 
-            if (acceptConnection)
-            {
+            if (acceptConnection) {
+
                 MessageQueue lowPrioQueue = NULL;
                 HighPriorityASDUQueue highPrioQueue = NULL;
 
@@ -3797,31 +5706,35 @@ handleConnectionsThreadless(CS104_Slave self)
                 }
 #endif
 
+#if (CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP == 1)
+                if (self->serverMode == CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP) {
+                    lowPrioQueue = NULL;
+                    highPrioQueue = NULL;
+                }
+#endif
+
                 MasterConnection connection = NULL;
 
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1)
-                if (self->serverMode == CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS)
-                {
+                if (self->serverMode == CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS) {
+
                     char ipAddress[60];
 
                     char* ipAddrStr = getPeerAddress(newSocket, ipAddress);
 
-                    if (ipAddrStr)
-                    {
+                    if (ipAddrStr) {
                         CS104_RedundancyGroup matchingGroup = getMatchingRedundancyGroup(self, ipAddrStr);
 
-                        if (matchingGroup != NULL)
-                        {
+                        if (matchingGroup != NULL) {
+
 #if (CONFIG_USE_SEMAPHORES)
                             Semaphore_wait(self->openConnectionsLock);
 #endif
 
-                            connection = getFreeConnection(self);
+                            connection = getFreeConnection(self, NULL);
 
-                            if (connection)
-                            {
-                                if (MasterConnection_initEx(connection, newSocket, matchingGroup))
-                                {
+                            if (connection) {
+                                if (MasterConnection_initEx(connection, newSocket, matchingGroup)) {
                                     self->openConnections++;
 
                                     if (matchingGroup->name) {
@@ -3848,27 +5761,15 @@ handleConnectionsThreadless(CS104_Slave self)
                     }
 
                 }
-                else
-#endif /* CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS */
-                {
+                else {
+
 #if (CONFIG_USE_SEMAPHORES)
                     Semaphore_wait(self->openConnectionsLock);
 #endif
-                    connection = getFreeConnection(self);
-
-#if (CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP == 1)
-                    if (self->serverMode == CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP)
-                    {
-                        lowPrioQueue = connection->lowPrioQueue;
-                        MessageQueue_initialize(lowPrioQueue);
 
-                        highPrioQueue = connection->highPrioQueue;
-                        HighPriorityASDUQueue_initialize(highPrioQueue);
-                    }
-#endif /* CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS */
+                    connection = getFreeConnection(self, NULL);
 
-                    if (connection)
-                    {
+                    if (connection) {
                         if (MasterConnection_init(connection, newSocket, lowPrioQueue, highPrioQueue)) {
                             self->openConnections++;
                         }
@@ -3883,17 +5784,36 @@ handleConnectionsThreadless(CS104_Slave self)
 #endif
 
                 }
+#else
 
-                if (connection)
-                {
-                    connection->isRunning = true;
+#if (CONFIG_USE_SEMAPHORES)
+                Semaphore_wait(self->openConnectionsLock);
+#endif
+                connection = getFreeConnection(self, NULL);
 
-                    if (self->connectionEventHandler) {
-                        self->connectionEventHandler(self->connectionEventHandlerParameter, &(connection->iMasterConnection), CS104_CON_EVENT_CONNECTION_OPENED);
+                if (connection) {
+                    if (MasterConnection_init(connection, newSocket, lowPrioQueue, highPrioQueue)) {
+                        self->openConnections++;
+                    }
+                    else {
+                        connection->isUsed = false;
+                        connection = NULL;
                     }
                 }
-                else {
+
+#if (CONFIG_USE_SEMAPHORES)
+                Semaphore_post(self->openConnectionsLock);
+#endif
+
+#endif /* (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1) */
+
+                if (connection) {
+                    /* now start the connection handling (thread) */
+                    MasterConnection_start(connection);
+                }
+                else{
                     Socket_destroy(newSocket);
+
                     DEBUG_PRINT("CS104 SLAVE: Connection attempt failed!\n");
                 }
 
@@ -3902,266 +5822,450 @@ handleConnectionsThreadless(CS104_Slave self)
                 Socket_destroy(newSocket);
             }
         }
+        else
+            Thread_sleep(10);
+
+        /* check if there are connections to close */
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_wait(self->openConnectionsLock);
+#endif
+
+        int i;
+
+        for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++) {
+
+            if (self->masterConnections[i])
+            {
+                MasterConnection connection = self->masterConnections[i];
+               
+#if (CONFIG_USE_SEMAPHORES == 1)
+                Semaphore_wait(connection->stateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+                bool isConnectionUsed = connection->isUsed;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+                Semaphore_post(connection->stateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+                if (isConnectionUsed) {
+
+                    if (MasterConnection_isRunning(connection) == false) {
+
+                        if (connection->connectionThread) {
+                            Thread_destroy(connection->connectionThread);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+                            Semaphore_wait(connection->stateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+                            connection->connectionThread = NULL;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+                            Semaphore_post(connection->stateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+                        }
+
+                        MasterConnection_deinit(connection);
+
+                        self->openConnections--;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+                        Semaphore_wait(connection->stateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+                        connection->isUsed = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+                        Semaphore_post(connection->stateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+                    }
+                }
+            }
+        }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_post(self->openConnectionsLock);
+#endif
 
+        syncPersistentQueue(self, false);
     }
 
-    handleClientConnections(self);
+    if (self->serverSocket)
+        Socket_destroy((Socket) self->serverSocket);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->stateLock);
+#endif
+
+    self->isRunning = false;
+    self->stopRunning = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->stateLock);
+#endif
+
+exit_function:
+    return NULL;
 }
 
-#if (CONFIG_USE_THREADS == 1)
+static void
+EventLoopWorker_initialize(EventLoopWorker self, CS104_Slave slave)
+{
+    self->slave = slave;
+    self->cpu = -1;
+    self->thread = NULL;
+    self->serverSocket = NULL;
+    self->poller = NULL;
+    self->wakeupEvent = WakeupEvent_create();
+    self->wakeupSignaled = false;
+    self->numberOfConnections = 0;
+
+    TimerWheel_init(&(self->timerWheel));
+}
 
-static void*
-serverThread (void* parameter)
+static void
+EventLoopWorker_destroy(EventLoopWorker self)
 {
-    CS104_Slave self = (CS104_Slave) parameter;
+    if (self->wakeupEvent)
+        WakeupEvent_destroy(self->wakeupEvent);
 
-    if (self->localAddress)
-        self->serverSocket = TcpServerSocket_create(self->localAddress, self->tcpPort);
+    TimerWheel_destroy(&(self->timerWheel));
+}
+
+/* create the listening socket and the poller of the worker */
+static bool
+EventLoopWorker_open(EventLoopWorker self, bool reusePort, int cpu)
+{
+    CS104_Slave slave = self->slave;
+
+    const char* localAddress = slave->localAddress ? slave->localAddress : "0.0.0.0";
+
+    if (reusePort)
+        self->serverSocket = TcpServerSocket_createReusePort(localAddress, slave->tcpPort);
     else
-        self->serverSocket = TcpServerSocket_create("0.0.0.0", self->tcpPort);
+        self->serverSocket = TcpServerSocket_create(localAddress, slave->tcpPort);
 
-    if (self->serverSocket == NULL) {
-        DEBUG_PRINT("CS104 SLAVE: Cannot create server socket\n");
+    if (self->serverSocket == NULL)
+        return false;
+
+    /* one entry for each client connection, the server socket and the wakeup event */
+    self->poller = SocketPoller_create(CONFIG_CS104_MAX_CLIENT_CONNECTIONS + 2);
+
+    if (self->poller == NULL) {
+        Socket_destroy((Socket) self->serverSocket);
+        self->serverSocket = NULL;
+
+        return false;
+    }
+
+    ServerSocket_listen(self->serverSocket);
+
+    /* the server socket is identified by NULL user data */
+    SocketPoller_addSocket(self->poller, (Socket) self->serverSocket, NULL);
+
+    /* the wakeup event is identified by the worker as user data */
+    if (self->wakeupEvent)
+        SocketPoller_addSocket(self->poller, (Socket) self->wakeupEvent, self);
+
+    self->cpu = cpu;
+    self->thread = NULL;
+    self->numberOfConnections = 0;
+
+    return true;
+}
+
+static void
+EventLoopWorker_close(EventLoopWorker self)
+{
+    CS104_Slave slave = self->slave;
+
+    if (self->serverSocket) {
+        Socket_destroy((Socket) self->serverSocket);
+        self->serverSocket = NULL;
+    }
+
+    if (self->poller) {
+        SocketPoller_destroy(self->poller);
+        self->poller = NULL;
+    }
 
 #if (CONFIG_USE_SEMAPHORES == 1)
-        Semaphore_wait(self->stateLock);
+    Semaphore_wait(slave->stateLock);
 #endif
-        self->isStarting = false;
+
+    if (self->wakeupSignaled) {
+        WakeupEvent_reset(self->wakeupEvent);
+        self->wakeupSignaled = false;
+    }
 
 #if (CONFIG_USE_SEMAPHORES == 1)
-        Semaphore_post(self->stateLock);
+    Semaphore_post(slave->stateLock);
 #endif
+}
 
-        goto exit_function;
+static void
+EventLoopWorker_removeConnection(EventLoopWorker self, int index)
+{
+    self->numberOfConnections--;
+
+    self->connections[index] = self->connections[self->numberOfConnections];
+    self->connections[self->numberOfConnections] = NULL;
+}
+
+/* handle the server socket and the client connections of the worker until the slave is stopped */
+static void
+EventLoopWorker_run(EventLoopWorker self)
+{
+    CS104_Slave slave = self->slave;
+
+    int i;
+
+    bool isAsduWaiting = false;
+
+    if (self->cpu != -1) {
+        if (Thread_setCpuAffinity(self->cpu) == false)
+            DEBUG_PRINT("CS104 SLAVE: Cannot bind event loop thread to CPU %i\n", self->cpu);
     }
 
-    ServerSocket_listen(self->serverSocket);
+    while (isStopRunningSet(slave) == false)
+    {
+        /*
+         * When an ASDU is waiting only have a short look to see if a client request
+         * was received. Otherwise wait to save CPU time.
+         */
+        int readyCount = SocketPoller_wait(self->poller, isAsduWaiting ? 0 : 100);
+
+        for (i = 0; i < readyCount; i++)
+        {
+            void* readyData = SocketPoller_getReady(self->poller, i);
 
+            MasterConnection con = (MasterConnection) readyData;
+
+            if (readyData == (void*) self)
+            {
 #if (CONFIG_USE_SEMAPHORES == 1)
-    Semaphore_wait(self->stateLock);
+                Semaphore_wait(slave->stateLock);
 #endif
 
-    self->isRunning = true;
-    self->isStarting = false;
+                WakeupEvent_reset(self->wakeupEvent);
+                self->wakeupSignaled = false;
 
 #if (CONFIG_USE_SEMAPHORES == 1)
-    Semaphore_post(self->stateLock);
+                Semaphore_post(slave->stateLock);
 #endif
+            }
+            else if (con == NULL)
+            {
+                Socket newSocket = ServerSocket_accept(self->serverSocket);
 
-    while (isStopRunningSet(self) == false) {
-        Socket newSocket = ServerSocket_accept(self->serverSocket);
-
-        if (newSocket != NULL) {
+                if (newSocket != NULL)
+                {
+                    /* check if maximum number of open connections is reached */
+                    if ((slave->maxOpenConnections > 0) &&
+                            (CS104_Slave_getOpenConnections(slave) >= slave->maxOpenConnections))
+                    {
+                        Socket_destroy(newSocket);
+                    }
+                    else
+                    {
+                        con = addNewConnection(slave, newSocket, self);
 
-            bool acceptConnection = true;
+                        if (con)
+                        {
+                            self->connections[self->numberOfConnections++] = con;
 
-            /* check if maximum number of open connections is reached */
-            if (self->maxOpenConnections > 0) {
-                if (CS104_Slave_getOpenConnections(self) >= self->maxOpenConnections)
-                    acceptConnection = false;
+                            if (SocketPoller_addSocket(self->poller, con->socket, con) == false)
+                                con->isRunning = false;
+                        }
+                    }
+                }
+            }
+            else if (con->isRunning)
+            {
+                MasterConnection_handleTcpConnection(con);
             }
+        }
 
-            if (acceptConnection)
-                acceptConnection = callConnectionRequestHandler(self, newSocket);
+        handleConnectionTimeouts(&(self->timerWheel));
 
-            if (acceptConnection) {
+        /* handle periodic tasks and release closed connections */
+        isAsduWaiting = false;
 
-                MessageQueue lowPrioQueue = NULL;
-                HighPriorityASDUQueue highPrioQueue = NULL;
+        i = 0;
 
-#if (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1)
-                if (self->serverMode == CS104_MODE_SINGLE_REDUNDANCY_GROUP) {
-                    lowPrioQueue = self->asduQueue;
-                    highPrioQueue = self->connectionAsduQueue;
-                }
-#endif
+        while (i < self->numberOfConnections)
+        {
+            MasterConnection con = self->connections[i];
 
-#if (CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP == 1)
-                if (self->serverMode == CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP) {
-                    lowPrioQueue = NULL;
-                    highPrioQueue = NULL;
-                }
-#endif
+            if (con->isRunning)
+            {
+                if (MasterConnection_executePeriodicTasks(con))
+                    isAsduWaiting = true;
 
-                MasterConnection connection = NULL;
+                callPluginTasks(slave, con);
+            }
 
-#if (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1)
-                if (self->serverMode == CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS) {
+            if (con->isRunning == false)
+            {
+                SocketPoller_removeSocket(self->poller, con->socket);
+                releaseConnection(slave, con);
 
-                    char ipAddress[60];
+                EventLoopWorker_removeConnection(self, i);
+            }
+            else
+                i++;
+        }
 
-                    char* ipAddrStr = getPeerAddress(newSocket, ipAddress);
+        /* the persistent queue is synchronized by the first worker */
+        if (self == slave->workers)
+            syncPersistentQueue(slave, false);
+    }
 
-                    if (ipAddrStr) {
-                        CS104_RedundancyGroup matchingGroup = getMatchingRedundancyGroup(self, ipAddrStr);
+    for (i = 0; i < self->numberOfConnections; i++)
+    {
+        MasterConnection con = self->connections[i];
 
-                        if (matchingGroup != NULL) {
+        MasterConnection_close(con);
 
-#if (CONFIG_USE_SEMAPHORES)
-                            Semaphore_wait(self->openConnectionsLock);
-#endif
+        SocketPoller_removeSocket(self->poller, con->socket);
+        releaseConnection(slave, con);
 
-                            connection = getFreeConnection(self);
+        self->connections[i] = NULL;
+    }
 
-                            if (connection) {
-                                if (MasterConnection_initEx(connection, newSocket, matchingGroup)) {
-                                    self->openConnections++;
+    self->numberOfConnections = 0;
+}
 
-                                    if (matchingGroup->name) {
-                                        DEBUG_PRINT("CS104 SLAVE: Add connection to group: %s\n", matchingGroup->name);
-                                    }
-                                }
-                                else {
-                                    connection->isUsed = false;
-                                    connection = NULL;
-                                }
-                            }
+static void*
+eventLoopWorkerThread(void* parameter)
+{
+    EventLoopWorker_run((EventLoopWorker) parameter);
 
-#if (CONFIG_USE_SEMAPHORES)
-                            Semaphore_post(self->openConnectionsLock);
-#endif
+    return NULL;
+}
 
-                        }
-                        else {
-                            DEBUG_PRINT("CS104 SLAVE: Found no matching redundancy group -> close connection\n");
-                        }
-                    }
-                    else {
-                        DEBUG_PRINT("CS104 SLAVE: cannot determine peer IP address -> close connection\n");
-                    }
+/* create the workers required for the configured number of event loop threads */
+static bool
+allocateEventLoopWorkers(CS104_Slave self)
+{
+    int i;
 
-                }
-                else {
+    if (self->maxWorkers >= self->eventLoopThreads)
+        return true;
 
-#if (CONFIG_USE_SEMAPHORES)
-                    Semaphore_wait(self->openConnectionsLock);
-#endif
+    if (self->workers) {
+        for (i = 0; i < self->maxWorkers; i++)
+            EventLoopWorker_destroy(&(self->workers[i]));
 
-                    connection = getFreeConnection(self);
+        GLOBAL_FREEMEM(self->workers);
+        self->maxWorkers = 0;
+    }
 
-                    if (connection) {
-                        if (MasterConnection_init(connection, newSocket, lowPrioQueue, highPrioQueue)) {
-                            self->openConnections++;
-                        }
-                        else {
-                            connection->isUsed = false;
-                            connection = NULL;
-                        }
-                    }
+    self->workers = (EventLoopWorker) GLOBAL_CALLOC(self->eventLoopThreads, sizeof(struct sEventLoopWorker));
 
-#if (CONFIG_USE_SEMAPHORES)
-                    Semaphore_post(self->openConnectionsLock);
-#endif
+    if (self->workers == NULL)
+        return false;
 
-                }
-#else
+    for (i = 0; i < self->eventLoopThreads; i++)
+        EventLoopWorker_initialize(&(self->workers[i]), self);
 
-#if (CONFIG_USE_SEMAPHORES)
-                Semaphore_wait(self->openConnectionsLock);
-#endif
-                connection = getFreeConnection(self);
+    self->maxWorkers = self->eventLoopThreads;
 
-                if (connection) {
-                    if (MasterConnection_init(connection, newSocket, lowPrioQueue, highPrioQueue)) {
-                        self->openConnections++;
-                    }
-                    else {
-                        connection->isUsed = false;
-                        connection = NULL;
-                    }
-                }
+    return true;
+}
 
-#if (CONFIG_USE_SEMAPHORES)
-                Semaphore_post(self->openConnectionsLock);
-#endif
+/*
+ * handle the server socket and all client connections in a single thread or, with more than one
+ * event loop thread, run the first worker and start the other workers in own threads
+ */
+static void*
+eventLoopThread(void* parameter)
+{
+    CS104_Slave self = (CS104_Slave) parameter;
 
-#endif /* (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1) */
+    int i;
 
-                if (connection) {
-                    /* now start the connection handling (thread) */
-                    MasterConnection_start(connection);
-                }
-                else{
-                    Socket_destroy(newSocket);
+    int numberOfWorkers = self->eventLoopThreads;
 
-                    DEBUG_PRINT("CS104 SLAVE: Connection attempt failed!\n");
-                }
+    self->numberOfWorkers = 0;
 
-            }
-            else {
-                Socket_destroy(newSocket);
-            }
-        }
-        else
-            Thread_sleep(10);
+    if (allocateEventLoopWorkers(self))
+    {
+        for (i = 0; i < numberOfWorkers; i++)
+        {
+            int cpu = self->eventLoopCpuAffinity ? i : -1;
 
-        /* check if there are connections to close */
-#if (CONFIG_USE_SEMAPHORES == 1)
-        Semaphore_wait(self->openConnectionsLock);
-#endif
+            if (EventLoopWorker_open(&(self->workers[i]), (numberOfWorkers > 1), cpu) == false)
+                break;
 
-        int i;
+            self->numberOfWorkers++;
+        }
 
-        for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++) {
+        if ((self->numberOfWorkers == 0) && (numberOfWorkers > 1))
+        {
+            DEBUG_PRINT("CS104 SLAVE: Cannot create shared server sockets -> use single event loop thread\n");
 
-            if (self->masterConnections[i])
-            {
-                MasterConnection connection = self->masterConnections[i];
-               
-#if (CONFIG_USE_SEMAPHORES == 1)
-                Semaphore_wait(connection->stateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+            if (EventLoopWorker_open(&(self->workers[0]), false, self->eventLoopCpuAffinity ? 0 : -1))
+                self->numberOfWorkers = 1;
+        }
+    }
 
-                bool isConnectionUsed = connection->isUsed;
+    if (self->numberOfWorkers == 0) {
+        DEBUG_PRINT("CS104 SLAVE: Cannot create server socket\n");
 
 #if (CONFIG_USE_SEMAPHORES == 1)
-                Semaphore_post(connection->stateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+        Semaphore_wait(self->stateLock);
+#endif
+        self->isStarting = false;
 
-                if (isConnectionUsed) {
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_post(self->stateLock);
+#endif
 
-                    if (MasterConnection_isRunning(connection) == false) {
+        goto exit_function;
+    }
 
-                        if (connection->connectionThread) {
-                            Thread_destroy(connection->connectionThread);
+    if (self->numberOfWorkers < numberOfWorkers)
+        DEBUG_PRINT("CS104 SLAVE: Only %i of %i event loop threads started\n", self->numberOfWorkers, numberOfWorkers);
 
 #if (CONFIG_USE_SEMAPHORES == 1)
-                            Semaphore_wait(connection->stateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+    Semaphore_wait(self->stateLock);
+#endif
 
-                            connection->connectionThread = NULL;
+    self->isRunning = true;
+    self->isStarting = false;
 
 #if (CONFIG_USE_SEMAPHORES == 1)
-                            Semaphore_post(connection->stateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
-                        }
+    Semaphore_post(self->stateLock);
+#endif
 
-                        MasterConnection_deinit(connection);
+    for (i = 1; i < self->numberOfWorkers; i++)
+    {
+        EventLoopWorker worker = &(self->workers[i]);
 
-                        self->openConnections--;
+        worker->thread = Thread_create(eventLoopWorkerThread, (void*) worker, false);
 
-#if (CONFIG_USE_SEMAPHORES == 1)
-                        Semaphore_wait(connection->stateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+        if (worker->thread)
+            Thread_start(worker->thread);
+    }
 
-                        connection->isUsed = false;
+    EventLoopWorker_run(&(self->workers[0]));
 
-#if (CONFIG_USE_SEMAPHORES == 1)
-                        Semaphore_post(connection->stateLock);
-#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+    for (i = 0; i < self->numberOfWorkers; i++)
+    {
+        EventLoopWorker worker = &(self->workers[i]);
 
-                    }
-                }
-            }
+        if (worker->thread) {
+            Thread_destroy(worker->thread);
+            worker->thread = NULL;
         }
 
-#if (CONFIG_USE_SEMAPHORES == 1)
-        Semaphore_post(self->openConnectionsLock);
-#endif
+        EventLoopWorker_close(worker);
     }
 
-    if (self->serverSocket)
-        Socket_destroy((Socket) self->serverSocket);
+    self->numberOfWorkers = 0;
 
 #if (CONFIG_USE_SEMAPHORES == 1)
     Semaphore_wait(self->stateLock);
@@ -4185,7 +6289,11 @@ CS104_Slave_enqueueASDU(CS104_Slave self, CS101_ASDU asdu)
 {
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1)
     if (self->serverMode == CS104_MODE_SINGLE_REDUNDANCY_GROUP)
+    {
         MessageQueue_enqueueASDU(self->asduQueue, asdu);
+
+        wakeupConnectionsOfQueue(self->asduQueue);
+    }
 #endif /* (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1) */
 
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1)
@@ -4196,15 +6304,24 @@ CS104_Slave_enqueueASDU(CS104_Slave self, CS101_ASDU asdu)
          * Dispatch event to all redundancy groups
          ************************************************/
 
-        LinkedList element = LinkedList_getNext(self->redundancyGroups);
+        SharedASDU sharedAsdu = SharedASDUStore_add(self->asduStore, asdu);
 
-        while (element)
+        if (sharedAsdu)
         {
-            CS104_RedundancyGroup group = (CS104_RedundancyGroup) LinkedList_getData(element);
+            LinkedList element = LinkedList_getNext(self->redundancyGroups);
+
+            while (element)
+            {
+                CS104_RedundancyGroup group = (CS104_RedundancyGroup) LinkedList_getData(element);
 
-            MessageQueue_enqueueASDU(group->asduQueue, asdu);
+                MessageQueue_enqueueSharedASDU(group->asduQueue, sharedAsdu);
 
-            element = LinkedList_getNext(element);
+                wakeupConnectionsOfQueue(group->asduQueue);
+
+                element = LinkedList_getNext(element);
+            }
+
+            SharedASDUStore_release(self->asduStore, sharedAsdu);
         }
     }
 
@@ -4221,14 +6338,26 @@ CS104_Slave_enqueueASDU(CS104_Slave self, CS101_ASDU asdu)
          * Dispatch event to all open client connections
          ************************************************/
 
-        int i;
+        SharedASDU sharedAsdu = SharedASDUStore_add(self->asduStore, asdu);
 
-        for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++)
+        if (sharedAsdu)
         {
-            MasterConnection con = self->masterConnections[i];
+            int i;
+
+            for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++)
+            {
+                MasterConnection con = self->masterConnections[i];
+
+                if (con && con->lowPrioQueue)
+                {
+                    MessageQueue_enqueueSharedASDU(con->lowPrioQueue, sharedAsdu);
+
+                    if (con->isUsed && (con->state == M_CON_STATE_STARTED))
+                        MasterConnection_wakeup(con);
+                }
+            }
 
-            if (con)
-                MessageQueue_enqueueASDU(con->lowPrioQueue, asdu);
+            SharedASDUStore_release(self->asduStore, sharedAsdu);
         }
 
 #if (CONFIG_USE_SEMAPHORES == 1)
@@ -4257,6 +6386,9 @@ CS104_Slave_addRedundancyGroup(CS104_Slave self, CS104_RedundancyGroup redundanc
 static void
 initializeRedundancyGroups(CS104_Slave self, int lowPrioMaxQueueSize, int highPrioMaxQueueSize)
 {
+    if (self->asduStore == NULL)
+        self->asduStore = SharedASDUStore_create();
+
     if (self->redundancyGroups == NULL)
     {
         CS104_RedundancyGroup redGroup = CS104_RedundancyGroup_create(NULL);
@@ -4269,18 +6401,22 @@ initializeRedundancyGroups(CS104_Slave self, int lowPrioMaxQueueSize, int highPr
     {
         CS104_RedundancyGroup redGroup = (CS104_RedundancyGroup) LinkedList_getData(element);
 
-        if (redGroup->asduQueue == NULL)
-            CS104_RedundancyGroup_initializeMessageQueues(redGroup, lowPrioMaxQueueSize, highPrioMaxQueueSize);
+        if (redGroup->asduQueue == NULL) {
+            CS104_RedundancyGroup_initializeMessageQueues(redGroup, lowPrioMaxQueueSize, highPrioMaxQueueSize, self->asduStore);
+
+            if (redGroup->asduQueue && (self->queuePolicy == CS104_QUEUE_POLICY_LATEST_VALUE))
+                MessageQueue_enableLatestValuePolicy(redGroup->asduQueue, &(self->alParameters));
+        }
 
         element = LinkedList_getNext(element);
     }
 }
 #endif /* (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1) */
 
-void
-CS104_Slave_start(CS104_Slave self)
-{
 #if ((CONFIG_USE_THREADS == 1) && (CONFIG_USE_SEMAPHORES == 1))
+static void
+startServerThread(CS104_Slave self, ThreadExecutionFunction function)
+{
     if (isRunning(self) == false)
     {
 #if (CONFIG_USE_SEMAPHORES == 1)
@@ -4309,18 +6445,42 @@ CS104_Slave_start(CS104_Slave self)
             initializeConnectionSpecificQueues(self);
 #endif
 
-        self->listeningThread = Thread_create(serverThread, (void*) self, false);
+        self->listeningThread = Thread_create(function, (void*) self, false);
 
         Thread_start(self->listeningThread);
 
         while (isStarting(self))
             Thread_sleep(1);
     }
+}
+#endif /* ((CONFIG_USE_THREADS == 1) && (CONFIG_USE_SEMAPHORES == 1)) */
+
+void
+CS104_Slave_start(CS104_Slave self)
+{
+#if ((CONFIG_USE_THREADS == 1) && (CONFIG_USE_SEMAPHORES == 1))
+    if (isRunning(self) == false)
+        self->isEventLoopMode = false;
+
+    startServerThread(self, serverThread);
 #else
     DEBUG_PRINT("CS104 SLAVE: ERROR: CS104_Slave_start not supported when CONFIG_USE_TREADS = 0 or CONFIG_USE_SEMAPHORES = 0!\n");
 #endif
 }
 
+void
+CS104_Slave_startEventLoop(CS104_Slave self)
+{
+#if ((CONFIG_USE_THREADS == 1) && (CONFIG_USE_SEMAPHORES == 1))
+    if (isRunning(self) == false)
+        self->isEventLoopMode = true;
+
+    startServerThread(self, eventLoopThread);
+#else
+    DEBUG_PRINT("CS104 SLAVE: ERROR: CS104_Slave_startEventLoop not supported when CONFIG_USE_TREADS = 0 or CONFIG_USE_SEMAPHORES = 0!\n");
+#endif
+}
+
 int
 CS104_Slave_getNumberOfQueueEntries(CS104_Slave self, CS104_RedundancyGroup redGroup)
 {
@@ -4546,13 +6706,22 @@ CS104_Slave_destroy(CS104_Slave self)
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1)
         if (self->serverMode == CS104_MODE_SINGLE_REDUNDANCY_GROUP) {
             if (self->asduQueue)
-                MessageQueue_releaseAllQueuedASDUs(self->asduQueue);
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+                /* the ASDUs of a persistent queue are kept for the next start */
+                if (self->asduQueue->file == NULL)
+#endif
+                    MessageQueue_releaseAllQueuedASDUs(self->asduQueue);
         }
 #endif
 
         if (self->localAddress != NULL)
             GLOBAL_FREEMEM(self->localAddress);
 
+#if (CONFIG_CS104_SUPPORT_PERSISTENT_QUEUE == 1)
+        if (self->persistentQueueFile != NULL)
+            GLOBAL_FREEMEM(self->persistentQueueFile);
+#endif
+
 #if (CONFIG_USE_SEMAPHORES == 1)
         Semaphore_destroy(self->openConnectionsLock);
         Semaphore_destroy(self->stateLock);
@@ -4591,6 +6760,23 @@ CS104_Slave_destroy(CS104_Slave self)
             LinkedList_destroyStatic(self->plugins);
         }
 
+#if (CONFIG_USE_THREADS == 1)
+        if (self->workers)
+        {
+            int i;
+
+            for (i = 0; i < self->maxWorkers; i++)
+                EventLoopWorker_destroy(&(self->workers[i]));
+
+            GLOBAL_FREEMEM(self->workers);
+        }
+#endif
+
+        TimerWheel_destroy(&(self->timerWheel));
+
+        /* destroyed after all queues as they release their references to the store */
+        SharedASDUStore_destroy(self->asduStore);
+
         GLOBAL_FREEMEM(self);
     }
 }
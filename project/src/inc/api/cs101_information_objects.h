@@ -43,8 +43,6 @@ extern "C" {
 const char*
 TypeID_toString(TypeID self);
 
-typedef uint8_t QualityDescriptor;
-
 /**
  * \brief QDP - Quality descriptor for events of protection equipment according to IEC 60870-5-101:2003 7.2.6.4
  */
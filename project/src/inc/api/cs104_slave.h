@@ -55,6 +55,11 @@ typedef enum {
     CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS
 } CS104_ServerMode;
 
+typedef enum {
+    CS104_QUEUE_POLICY_FIFO, /**< all ASDUs are kept in order, the oldest entries are overwritten when the queue is full */
+    CS104_QUEUE_POLICY_LATEST_VALUE /**< unsent measured values without time tag are replaced by newer values of the same data points */
+} CS104_QueuePolicy;
+
 typedef enum
 {
     IP_ADDRESS_TYPE_IPV4,
@@ -179,6 +184,53 @@ CS104_Slave_setMaxOpenConnections(CS104_Slave self, int maxOpenConnections);
 void
 CS104_Slave_setServerMode(CS104_Slave self, CS104_ServerMode serverMode);
 
+/**
+ * \brief Set the policy of the low-priority queues
+ *
+ * With \ref CS104_QUEUE_POLICY_LATEST_VALUE a measured value without time tag (M_ME_NA_1, M_ME_NB_1,
+ * M_ME_NC_1, M_ME_ND_1) replaces an ASDU of the same type, CA and IOAs that is still waiting for
+ * transmission. The replaced ASDU keeps its position in the queue. All other ASDUs (e.g. status changes
+ * and events with time tag) are always appended and stay strictly ordered. This way a slow or disconnected
+ * client does not fill the queue with outdated analog values and gets the current state after congestion.
+ *
+ * NOTE: Has to be called before the server is started!
+ *
+ * \param self the slave instance
+ * \param queuePolicy the queue policy (default is \ref CS104_QUEUE_POLICY_FIFO)
+ */
+void
+CS104_Slave_setQueuePolicy(CS104_Slave self, CS104_QueuePolicy queuePolicy);
+
+/**
+ * \brief Store the low-priority queue in a file so that queued ASDUs survive a restart
+ *
+ * The queue buffer is mapped from the file. The file size is fixed by the maximum low-priority queue size.
+ * ASDUs of the file that were not confirmed by a client (waiting or sent but not confirmed) are sent
+ * again after a restart. Changes are written to the storage device in batches - after
+ * CONFIG_CS104_PERSISTENT_QUEUE_SYNC_ENTRIES changes or CONFIG_CS104_PERSISTENT_QUEUE_SYNC_INTERVAL ms,
+ * whichever comes first. Entries that were not completely written before a crash are dropped when the
+ * queue is restored. The file format depends on the platform and the maximum queue size. A file that
+ * does not match is overwritten with an empty queue.
+ *
+ * NOTE: Only supported in server mode \ref CS104_MODE_SINGLE_REDUNDANCY_GROUP. Has to be called before the server is started!
+ * When the file cannot be opened the queue is kept in memory.
+ *
+ * \param self the slave instance
+ * \param filename name of the queue file or NULL to keep the queue in memory
+ */
+void
+CS104_Slave_setPersistentQueue(CS104_Slave self, const char* filename);
+
+/**
+ * \brief Write all changes of the persistent queue to the storage device
+ *
+ * The function blocks until the data is written.
+ *
+ * \param self the slave instance
+ */
+void
+CS104_Slave_syncPersistentQueue(CS104_Slave self);
+
 /**
  * \brief Set the connection request handler
  *
@@ -256,6 +308,49 @@ CS104_Slave_getAppLayerParameters(CS104_Slave self);
 void
 CS104_Slave_start(CS104_Slave self);
 
+/**
+ * \brief Start the CS 104 slave in event loop mode. The slave (server) will listen on the configured TCP/IP port
+ *
+ * In contrast to \ref CS104_Slave_start no thread is created for each client connection. A single thread
+ * waits for all client sockets and the server socket at once (epoll on Linux) and also handles the
+ * timeouts (t1, t2, t3) and the transmission of queued ASDUs of all connections. This saves the thread
+ * stacks and context switches when many clients are connected. All callbacks are called by this thread.
+ * The slave is stopped with \ref CS104_Slave_stop.
+ *
+ * NOTE: This function requires CONFIG_USE_THREADS = 1 and CONFIG_USE_SEMAPHORES == 1 in lib60870_config.h
+ *
+ * \param self CS104_Slave instance
+ */
+void
+CS104_Slave_startEventLoop(CS104_Slave self);
+
+/**
+ * \brief Set the number of event loop threads used by \ref CS104_Slave_startEventLoop
+ *
+ * Each thread has its own listening socket bound to the same address and port (SO_REUSEPORT) and handles
+ * the connections accepted by this socket. The operating system distributes new connections over the threads.
+ * Callbacks can then be called by different threads at the same time. When the platform does not support
+ * shared listening sockets a single event loop thread is used.
+ *
+ * NOTE: Has to be called before the server is started!
+ *
+ * \param self CS104_Slave instance
+ * \param numberOfThreads number of event loop threads (default is 1)
+ */
+void
+CS104_Slave_setEventLoopThreads(CS104_Slave self, int numberOfThreads);
+
+/**
+ * \brief Bind each event loop thread to one CPU (thread n to CPU n)
+ *
+ * NOTE: Has to be called before the server is started! Ignored when not supported by the platform.
+ *
+ * \param self CS104_Slave instance
+ * \param enable true to bind the event loop threads to CPUs (default is false)
+ */
+void
+CS104_Slave_setEventLoopCpuAffinity(CS104_Slave self, bool enable);
+
 /**
  * \brief Check if slave is running
  *
@@ -320,6 +415,10 @@ CS104_Slave_getNumberOfQueueEntries(CS104_Slave self, CS104_RedundancyGroup redG
 /**
  * \brief Add an ASDU to the low-priority queue of the slave (use for periodic and spontaneous messages)
  *
+ * Connections that wait for data are woken up, so the ASDU is sent immediately when the k-window
+ * allows it (not supported on all platforms). The raw message handler is called when the I message
+ * with the ASDU is sent and can be used to measure the enqueue-to-wire latency.
+ *
  * \param asdu the ASDU to add
  */
 void
@@ -279,6 +279,11 @@ struct sCS104_APCIParameters {
     int t3;
 };
 
+/**
+ * \brief QDS - Quality descriptor (declared here because it is also used by the CS101_ASDU functions)
+ */
+typedef uint8_t QualityDescriptor;
+
 #include "cs101_information_objects.h"
 
 typedef enum {
@@ -475,6 +480,36 @@ CS101_ASDU_getElement(CS101_ASDU self, int index);
 InformationObject
 CS101_ASDU_getElementEx(CS101_ASDU self, InformationObject io, int index);
 
+/**
+ * \brief Callback handler for \ref CS101_ASDU_forEachElement
+ *
+ * NOTE: The information object is only valid during the call. It must not be destroyed or stored by the handler.
+ *
+ * \param parameter user provided parameter
+ * \param asdu the ASDU the element belongs to
+ * \param index the index of the element (starting with 0)
+ * \param io the decoded information object
+ *
+ * \return true to continue with the next element, false to stop
+ */
+typedef bool (*CS101_ASDUElementHandler) (void* parameter, CS101_ASDU asdu, int index, InformationObject io);
+
+/**
+ * \brief Decode all information objects of the ASDU and pass them to a handler
+ *
+ * In contrast to \ref CS101_ASDU_getElement no memory is allocated. All elements are decoded
+ * into a single information object instance on the stack that is reused for each element.
+ * The values can be accessed with the functions of the information object type (e.g.
+ * \ref MeasuredValueScaled_getValue or \ref MeasuredValueScaled_getQuality).
+ *
+ * \param handler the handler that is called for each element
+ * \param parameter user provided parameter that is passed to the handler
+ *
+ * \return true when all elements were decoded and handled, false when the handler stopped or an element is invalid
+ */
+bool
+CS101_ASDU_forEachElement(CS101_ASDU self, CS101_ASDUElementHandler handler, void* parameter);
+
 /**
  * \brief Create a new ASDU. The type ID will be derived from the first InformationObject that will be added
  *
@@ -577,6 +612,43 @@ CS101_ASDU_destroy(CS101_ASDU self);
 bool
 CS101_ASDU_addInformationObject(CS101_ASDU self, InformationObject io);
 
+/**
+ * \brief add a sequence of single point information elements (M_SP_NA_1) with subsequent IOAs to the ASDU
+ *
+ * The elements are written directly into the ASDU payload. The IOA is only encoded once for the whole
+ * ASDU. As many elements as fit into the ASDU are added. The remaining elements can be added to the next
+ * ASDU after the current ASDU is sent and cleared with \ref CS101_ASDU_removeAllElements.
+ *
+ * NOTE: The ASDU has to be created as sequence (SQ = 1). When the ASDU already contains elements they have to be
+ * of the same type and startIoa has to be the IOA following the last element.
+ *
+ * \param self ASDU object instance
+ * \param startIoa IOA of the first element
+ * \param values array of the values
+ * \param qualities array of the quality descriptors or NULL for IEC60870_QUALITY_GOOD
+ * \param count number of elements in the arrays
+ *
+ * \return number of elements added (0 when the ASDU is full or the elements cannot be added)
+ */
+int
+CS101_ASDU_addSinglePointSequence(CS101_ASDU self, int startIoa, const bool* values, const QualityDescriptor* qualities, int count);
+
+/**
+ * \brief add a sequence of scaled measured values (M_ME_NB_1) with subsequent IOAs to the ASDU
+ *
+ * See \ref CS101_ASDU_addSinglePointSequence
+ *
+ * \param self ASDU object instance
+ * \param startIoa IOA of the first element
+ * \param values array of the values
+ * \param qualities array of the quality descriptors or NULL for IEC60870_QUALITY_GOOD
+ * \param count number of elements in the arrays
+ *
+ * \return number of elements added (0 when the ASDU is full or the elements cannot be added)
+ */
+int
+CS101_ASDU_addScaledValueSequence(CS101_ASDU self, int startIoa, const int16_t* values, const QualityDescriptor* qualities, int count);
+
 /**
  * \brief remove all information elements from the ASDU object
  *
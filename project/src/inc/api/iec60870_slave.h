@@ -152,6 +152,89 @@ IMasterConnection_close(IMasterConnection self);
 CS101_AppLayerParameters
 IMasterConnection_getApplicationLayerParameters(IMasterConnection self);
 
+/**
+ * @}
+ */
+
+/**
+ * @defgroup ASDU_BUILDER ASDU builder
+ *
+ * Helper to send a large number of information objects (e.g. an interrogation response) to a master.
+ * Information objects are added to an ASDU until it is full or the next object cannot be added
+ * (different type or, for sequence ASDUs, not the following IOA). Then the ASDU is sent and a new
+ * ASDU with the same header (COT, OA, CA, sequence flag) is started.
+ *
+ * An ASDU is only sent when \ref IMasterConnection_isReady returns true. Otherwise the add functions
+ * report that the object was not added and the application has to continue later (e.g. in the runTask
+ * function of a \ref CS101_SlavePlugin) with the same builder instance. This way a large response is
+ * sent as fast as the master confirms the ASDUs without overflowing the high priority queue.
+ *
+ * @{
+ */
+
+typedef struct {
+    IMasterConnection connection;
+    CS101_ASDU asdu;
+    sCS101_StaticASDU staticAsdu;
+} sCS101_ASDUBuilder;
+
+typedef sCS101_ASDUBuilder* CS101_ASDUBuilder;
+
+/**
+ * \brief Initialize an ASDU builder (e.g. allocated on the stack or as part of another structure)
+ *
+ * NOTE: The builder instance must not be copied or moved after initialization.
+ *
+ * \param self the builder instance
+ * \param connection the connection used to send the ASDUs
+ * \param isSequence if the information objects will be encoded as a compact sequence (SQ = 1)
+ * \param cot cause of transmission (COT) of the ASDUs
+ * \param oa originator address (OA) of the ASDUs
+ * \param ca the common address (CA) of the ASDUs
+ *
+ * \return the builder instance
+ */
+CS101_ASDUBuilder
+CS101_ASDUBuilder_initialize(CS101_ASDUBuilder self, IMasterConnection connection, bool isSequence, CS101_CauseOfTransmission cot, int oa, int ca);
+
+/**
+ * \brief Add an information object. A full ASDU is sent before.
+ *
+ * \return true when added, false when the connection is not ready (or closed) or the object cannot be encoded
+ */
+bool
+CS101_ASDUBuilder_addInformationObject(CS101_ASDUBuilder self, InformationObject io);
+
+/**
+ * \brief Add a sequence of single point information elements (see \ref CS101_ASDU_addSinglePointSequence)
+ *
+ * NOTE: The builder has to be initialized with isSequence = true.
+ *
+ * \return the number of elements added, less than count when the connection is not ready (or closed)
+ */
+int
+CS101_ASDUBuilder_addSinglePointSequence(CS101_ASDUBuilder self, int startIoa, const bool* values, const QualityDescriptor* qualities, int count);
+
+/**
+ * \brief Add a sequence of scaled measured values (see \ref CS101_ASDU_addScaledValueSequence)
+ *
+ * NOTE: The builder has to be initialized with isSequence = true.
+ *
+ * \return the number of elements added, less than count when the connection is not ready (or closed)
+ */
+int
+CS101_ASDUBuilder_addScaledValueSequence(CS101_ASDUBuilder self, int startIoa, const int16_t* values, const QualityDescriptor* qualities, int count);
+
+/**
+ * \brief Send the ASDU with the information objects added so far
+ *
+ * Has to be called after the last information object was added.
+ *
+ * \return true when there are no more information objects waiting, false when the connection is not ready (or closed)
+ */
+bool
+CS101_ASDUBuilder_flush(CS101_ASDUBuilder self);
+
 /**
  * @}
  */
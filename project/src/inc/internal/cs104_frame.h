@@ -25,9 +25,27 @@
 #include <stdint.h>
 
 #include "frame.h"
+#include "lib60870_config.h"
+
+#ifndef CONFIG_CS104_RECV_BUFFER_SIZE
+#define CONFIG_CS104_RECV_BUFFER_SIZE 1024
+#endif
 
 typedef struct sT104Frame* T104Frame;
 
+/**
+ * Receive buffer for APDUs. The socket is drained with large reads and all complete APDUs
+ * are taken from the buffer one after the other. A partial APDU stays in the buffer until
+ * the remaining bytes are received.
+ */
+typedef struct sT104RecvBuffer* T104RecvBuffer;
+
+struct sT104RecvBuffer {
+    uint8_t buffer[CONFIG_CS104_RECV_BUFFER_SIZE];
+    int startPos; /* start of the first unprocessed byte */
+    int endPos; /* end of the received data */
+};
+
 T104Frame
 T104Frame_create(void);
 
@@ -55,5 +73,37 @@ T104Frame_getBuffer(Frame self);
 int
 T104Frame_getSpaceLeft(Frame self);
 
+void
+T104RecvBuffer_reset(T104RecvBuffer self);
+
+/**
+ * \brief Get the free space at the end of the buffer. Data of a partial APDU is moved to the
+ * start of the buffer first.
+ *
+ * \param size returns the number of free bytes
+ *
+ * \return start of the free space
+ */
+uint8_t*
+T104RecvBuffer_getFreeSpace(T104RecvBuffer self, int* size);
+
+/**
+ * \brief Add bytes that were read into the free space to the buffered data
+ */
+void
+T104RecvBuffer_commit(T104RecvBuffer self, int size);
+
+/**
+ * \brief Take the next complete APDU from the buffer
+ *
+ * The returned APDU is valid until the next call of \ref T104RecvBuffer_getFreeSpace or \ref T104RecvBuffer_reset.
+ *
+ * \param msg returns the start of the APDU
+ *
+ * \return size of the APDU, 0 when no complete APDU is buffered, -1 when the data is not a valid APDU
+ */
+int
+T104RecvBuffer_nextMessage(T104RecvBuffer self, uint8_t** msg);
+
 
 #endif /* SRC_INC_T104_FRAME_H_ */